@@ -20,24 +20,17 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include(obdcore.pri)
+
 SOURCES += \
-    connectionmanager.cpp \
-    elm.cpp \
-    elmbluetoothmanager.cpp \
-    elmtcpsocket.cpp \
-    global.cpp \
+    logmodel.cpp \
     main.cpp \
-    mainwindow.cpp \
-    settingsmanager.cpp
+    mainwindow.cpp
 
 HEADERS += \
-    connectionmanager.h \
-    elm.h \
-    elmbluetoothmanager.h \
-    elmtcpsocket.h \
-    global.h \
-    mainwindow.h \
-    settingsmanager.h
+    logmodel.h \
+    logringbuffer.h \
+    mainwindow.h
 
 FORMS += \
     mainwindow.ui
@@ -127,6 +120,8 @@ CONFIG(release, debug|release) {
 }
 
 # Simulator notes (kept as comments for reference)
+# Built in: ObdReader --simulator [--simulator-fast] [--simulator-seed N] [--simulator-faults 0.05]
+# External, generic OBD only:
 # simulator https://github.com/Ircama/ELM327-emulator/releases
 # python -m pip install ELM327-emulator
 # elm -n 35000 -s car
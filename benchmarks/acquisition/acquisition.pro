@@ -0,0 +1,22 @@
+QT -= gui
+CONFIG += console c++17 release
+CONFIG -= app_bundle
+
+TARGET = acquisition_bench
+TEMPLATE = app
+
+# The whole core, exactly as the app and obdreaderd build it
+include(../../obdcore.pri)
+
+SOURCES += \
+    acquisitionbench.cpp \
+    loopbackadapter.cpp \
+    main.cpp
+
+HEADERS += \
+    acquisitionbench.h \
+    loopbackadapter.h
+
+linux:!android {
+    LIBS += -lpthread
+}
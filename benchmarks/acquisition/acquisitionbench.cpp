@@ -0,0 +1,410 @@
+#include "acquisitionbench.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <cmath>
+#include <ctime>
+#include <limits>
+#include "connectionmanager.h"
+#include "elm.h"
+#include "elminterface.h"
+#include "instrumentation.h"
+#include "livedataengine.h"
+#include "sensorrecorder.h"
+#include "settingsmanager.h"
+#include "vehicleprofile.h"
+#include "wjinitsession.h"
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+const int INIT_TIMEOUT_MS = 30000;
+// Longest a stopped engine may take to get its last requests back
+const int DRAIN_TIMEOUT_MS = 5000;
+
+// User + system time of the whole process
+qint64 processCpuUs()
+{
+#ifdef Q_OS_UNIX
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (qint64(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * 1000000
+           + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#else
+    // Process time on Windows is not in the standard library; clock() is the best portable stand-in
+    return qint64(std::clock()) * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
+
+// Requests that carry a sensor value: everything LiveDataEngine sends except the AT
+// commands ElmInterface puts in front of them (header, protocol switch)
+bool isSampleRequest(const QString &command)
+{
+    return !command.startsWith("AT") || command.startsWith("ATRV");
+}
+
+// Every sensor value WJSensorSignals can read set to NaN
+WJSensorData unfilledSensorData()
+{
+    const double none = std::numeric_limits<double>::quiet_NaN();
+    WJSensorData data;
+
+    data.engine.mafActual = none;
+    data.engine.mafSpecified = none;
+    data.engine.railPressureActual = none;
+    data.engine.railPressureSpecified = none;
+    data.engine.mapActual = none;
+    data.engine.mapSpecified = none;
+    data.engine.coolantTemp = none;
+    data.engine.intakeAirTemp = none;
+    data.engine.throttlePosition = none;
+    data.engine.engineRPM = none;
+    data.engine.injectionQuantity = none;
+    data.engine.injector1Correction = none;
+    data.engine.injector2Correction = none;
+    data.engine.injector3Correction = none;
+    data.engine.injector4Correction = none;
+    data.engine.injector5Correction = none;
+    data.engine.batteryVoltage = none;
+
+    data.transmission.oilTemp = none;
+    data.transmission.inputSpeed = none;
+    data.transmission.outputSpeed = none;
+    data.transmission.torqueConverter = none;
+    data.transmission.currentGear = none;
+    data.transmission.linePresssure = none;
+    data.transmission.shiftSolenoidA = none;
+    data.transmission.shiftSolenoidB = none;
+    data.transmission.tccSolenoid = none;
+
+    data.pcm.vehicleSpeed = none;
+    data.pcm.engineLoad = none;
+    data.pcm.fuelTrimST = none;
+    data.pcm.fuelTrimLT = none;
+    data.pcm.o2Sensor1 = none;
+    data.pcm.o2Sensor2 = none;
+    data.pcm.timingAdvance = none;
+    data.pcm.barometricPressure = none;
+
+    data.abs.wheelSpeedFL = none;
+    data.abs.wheelSpeedFR = none;
+    data.abs.wheelSpeedRL = none;
+    data.abs.wheelSpeedRR = none;
+    data.abs.yawRate = none;
+    data.abs.lateralAccel = none;
+    return data;
+}
+
+} // namespace
+
+QJsonObject BenchRun::toJson() const
+{
+    QJsonObject json;
+    json["intervalMs"] = intervalMs;
+    json["signals"] = signalCount;
+    json["seconds"] = seconds;
+    json["samples"] = qint64(samples);
+    json["samplesPerSecond"] = samplesPerSecond();
+    json["p50Us"] = qint64(p50Us);
+    json["p99Us"] = qint64(p99Us);
+    json["cpuUsPerSample"] = cpuUsPerSample;
+    json["timeouts"] = qint64(timeouts);
+    json["failed"] = qint64(failed);
+    return json;
+}
+
+AcquisitionBench::AcquisitionBench(const Options &options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+{
+    m_unfilled = unfilledSensorData();
+    m_sensorData = m_unfilled;
+
+    m_connectionManager = ConnectionManager::getInstance();
+    m_elmInterface = ElmInterface::getInstance();
+    m_liveDataEngine = new LiveDataEngine(m_elmInterface, this);
+    m_initSession = new WJInitSession(this);
+
+    connect(m_connectionManager, &ConnectionManager::connected, this, &AcquisitionBench::onConnected);
+    connect(m_connectionManager, &ConnectionManager::disconnected, this, &AcquisitionBench::onDisconnected);
+    connect(m_elmInterface, &ElmInterface::commandSent, this, &AcquisitionBench::onCommandSent);
+    connect(m_elmInterface, &ElmInterface::responseReceived, this, &AcquisitionBench::onResponseReceived);
+    connect(m_elmInterface, &ElmInterface::messageReceived, this, &AcquisitionBench::onMessageReceived);
+    connect(m_elmInterface, &ElmInterface::requestTimedOut, this, &AcquisitionBench::onRequestTimedOut);
+    connect(m_elmInterface, &ElmInterface::queueDrained, this, [this]() {
+        if (m_phase == PHASE_DRAIN && !m_elmInterface->isBusy()) {
+            m_drainTimer.stop();
+            startRun();
+        }
+    });
+    connect(m_liveDataEngine, &LiveDataEngine::pidMessageReceived, this, &AcquisitionBench::decodeMessage);
+    connect(m_initSession, &WJInitSession::completed, this, &AcquisitionBench::onInitCompleted);
+
+    m_initTimer.setSingleShot(true);
+    m_initTimer.setInterval(INIT_TIMEOUT_MS);
+    connect(&m_initTimer, &QTimer::timeout, this, [this]() {
+        log("Initialization timeout - measuring anyway");
+        startRun();
+    });
+
+    m_phaseTimer.setSingleShot(true);
+    m_phaseTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_phaseTimer, &QTimer::timeout, this, [this]() {
+        if (m_phase == PHASE_WARMUP) {
+            beginMeasuring();
+        } else if (m_phase == PHASE_MEASURE) {
+            endRun();
+        }
+    });
+
+    m_drainTimer.setSingleShot(true);
+    m_drainTimer.setInterval(DRAIN_TIMEOUT_MS);
+    connect(&m_drainTimer, &QTimer::timeout, this, [this]() {
+        m_elmInterface->clearQueue();
+        startRun();
+    });
+}
+
+void AcquisitionBench::start(const QString &host, quint16 port)
+{
+    // Only for this process: the shared settings.ini and vehicles.ini are left alone
+    if (m_profileDir.isValid()) {
+        VehicleProfileCache::getInstance()->setFile(m_profileDir.filePath("vehicles.ini"));
+    }
+    SettingsManager *settings = SettingsManager::getInstance();
+    settings->setWifiIp(host);
+    settings->setWifiPort(port);
+
+    m_results.clear();
+    m_nextRun = 0;
+    m_phase = PHASE_INIT;
+    m_connectionManager->setConnectionType(Wifi);
+    m_connectionManager->connectElm();
+}
+
+const QList<BenchRun> &AcquisitionBench::results() const
+{
+    return m_results;
+}
+
+void AcquisitionBench::onConnected()
+{
+    log("Connected to " + m_connectionManager->endpoint());
+    if (!m_initSession->start(m_connectionManager->endpoint())) {
+        log("Failed to start initialization");
+        emit finished(false);
+        return;
+    }
+    m_initTimer.start();
+}
+
+void AcquisitionBench::onDisconnected()
+{
+    if (m_phase == PHASE_IDLE) {
+        return;
+    }
+    m_phase = PHASE_IDLE;
+    m_initTimer.stop();
+    m_phaseTimer.stop();
+    m_drainTimer.stop();
+    m_liveDataEngine->stop();
+    log("Adapter went away");
+    emit finished(false);
+}
+
+void AcquisitionBench::onInitCompleted()
+{
+    m_initTimer.stop();
+    ELM *elm = ELM::getInstance();
+    m_liveDataEngine->setSupportedPids(elm->pidsChecked() ? elm->supportedPids() : std::bitset<256>());
+    startRun();
+}
+
+void AcquisitionBench::startRun()
+{
+    const int runCount = int(m_options.intervalsMs.size() * m_options.signalCounts.size());
+    if (m_nextRun >= runCount) {
+        m_phase = PHASE_IDLE;
+        m_connectionManager->disConnectElm();
+        emit finished(true);
+        return;
+    }
+
+    const QList<LiveSignal> all = LiveDataEngine::defaultSignals();
+    const int count = m_options.signalCounts[m_nextRun % m_options.signalCounts.size()];
+    m_run = BenchRun();
+    m_run.intervalMs = m_options.intervalsMs[m_nextRun / m_options.signalCounts.size()];
+    m_run.signalCount = (count <= 0 || count > all.size()) ? int(all.size()) : count;
+    ++m_nextRun;
+
+    m_liveDataEngine->setSignalSet(all.mid(0, m_run.signalCount));
+    m_liveDataEngine->setMinCycleInterval(m_run.intervalMs);
+    m_inFlight.clear();
+
+    m_phase = PHASE_WARMUP;
+    m_liveDataEngine->start();
+    m_phaseTimer.start(m_options.warmupMs);
+}
+
+void AcquisitionBench::beginMeasuring()
+{
+    m_latencyUs.reset();
+    m_run.samples = 0;
+    m_run.timeouts = 0;
+    m_run.failed = 0;
+    m_phase = PHASE_MEASURE;
+    m_startUs = Instrumentation::getInstance()->nowUs();
+    m_startCpuUs = processCpuUs();
+    m_phaseTimer.start(m_options.durationMs);
+}
+
+void AcquisitionBench::endRun()
+{
+    const qint64 cpuUs = processCpuUs() - m_startCpuUs;
+    m_run.seconds = (Instrumentation::getInstance()->nowUs() - m_startUs) / 1e6;
+    m_run.p50Us = m_latencyUs.percentile(0.50);
+    m_run.p99Us = m_latencyUs.percentile(0.99);
+    m_run.cpuUsPerSample = m_run.samples > 0 ? double(cpuUs) / m_run.samples : 0;
+    m_results.append(m_run);
+
+    log(QString("interval %1 ms, %2 signals: %3 samples/s, p50 %4 us, p99 %5 us, %6 us CPU/sample")
+            .arg(m_run.intervalMs).arg(m_run.signalCount)
+            .arg(m_run.samplesPerSecond(), 0, 'f', 1)
+            .arg(m_run.p50Us).arg(m_run.p99Us)
+            .arg(m_run.cpuUsPerSample, 0, 'f', 1));
+
+    // The next run starts on an empty adapter queue
+    m_phase = PHASE_DRAIN;
+    m_liveDataEngine->stop();
+    if (!m_elmInterface->isBusy() && m_elmInterface->pendingCount() == 0) {
+        QTimer::singleShot(0, this, &AcquisitionBench::startRun);
+    } else {
+        m_drainTimer.start();
+    }
+}
+
+void AcquisitionBench::onCommandSent(quint32 id, const QString &command)
+{
+    if ((m_phase == PHASE_WARMUP || m_phase == PHASE_MEASURE) && isSampleRequest(command)) {
+        InFlight &request = m_inFlight[id];
+        request.sentUs = Instrumentation::getInstance()->nowUs();
+        request.sampled = false;
+    }
+}
+
+void AcquisitionBench::onResponseReceived(quint32 id, const QString &command, WJModule module, const QStringList &lines)
+{
+    Q_UNUSED(module);
+
+    if (m_initSession->isRunning()) {
+        m_initSession->handleResponse(id, command, lines.join(' '));
+        return;
+    }
+
+    // Adapter readings (ATRV) have no ECU message; they decode from the text
+    if (command.startsWith("AT") && m_inFlight.contains(id)
+        && WJDataParser::decode(lines.join(' '), MODULE_ENGINE_EDC15, m_sensorData)) {
+        recordSample(id, decodedValues());
+    }
+
+    const auto request = m_inFlight.constFind(id);
+    if (request != m_inFlight.constEnd()) {
+        if (!request->sampled && m_phase == PHASE_MEASURE) {
+            m_run.failed++;
+        }
+        m_inFlight.erase(request);
+    }
+}
+
+void AcquisitionBench::onMessageReceived(quint32 id, WJModule module, QByteArrayView message)
+{
+    // Batched mode 01 replies come back one PID at a time through pidMessageReceived
+    if (!m_liveDataEngine->isBatched(id)) {
+        decodeMessage(id, module, message);
+    }
+}
+
+void AcquisitionBench::decodeMessage(quint32 id, WJModule module, QByteArrayView message)
+{
+    if (m_inFlight.contains(id)
+        && WJDataParser::decode(reinterpret_cast<const quint8*>(message.data()), int(message.size()), module, m_sensorData)) {
+        recordSample(id, decodedValues());
+    }
+}
+
+void AcquisitionBench::onRequestTimedOut(quint32 id, const QString &command)
+{
+    if (m_initSession->isRunning()) {
+        m_initSession->handleResponse(id, command, QString());
+        return;
+    }
+    if (m_inFlight.remove(id) && m_phase == PHASE_MEASURE) {
+        m_run.timeouts++;
+    }
+}
+
+// Counts the values the last decode wrote and sets them back to NaN for the next one
+int AcquisitionBench::decodedValues()
+{
+    int values = 0;
+    for (const WJSensorSignal &signal : WJSensorSignals::TABLE) {
+        if (!std::isnan(signal.read(m_sensorData))) {
+            values++;
+        }
+    }
+    m_sensorData.engine = m_unfilled.engine;
+    m_sensorData.transmission = m_unfilled.transmission;
+    m_sensorData.pcm = m_unfilled.pcm;
+    m_sensorData.abs = m_unfilled.abs;
+    return values;
+}
+
+void AcquisitionBench::recordSample(quint32 id, int values)
+{
+    if (values == 0) {
+        return;
+    }
+    InFlight &request = m_inFlight[id];
+    request.sampled = true;
+    if (m_phase != PHASE_MEASURE) {
+        return;
+    }
+    m_run.samples += values;
+    m_latencyUs.record(quint32(qBound<qint64>(0, Instrumentation::getInstance()->nowUs() - request.sentUs, 0xFFFFFFFF)));
+}
+
+QStringList AcquisitionBench::regressions(const QList<BenchRun> &runs, const QJsonObject &baseline, double tolerance)
+{
+    QStringList found;
+    const QJsonArray baseRuns = baseline["runs"].toArray();
+    for (const BenchRun &run : runs) {
+        for (const QJsonValue &value : baseRuns) {
+            const QJsonObject base = value.toObject();
+            if (base["intervalMs"].toInt() != run.intervalMs || base["signals"].toInt() != run.signalCount) {
+                continue;
+            }
+
+            const QString name = QString("interval %1 ms, %2 signals").arg(run.intervalMs).arg(run.signalCount);
+            const double rate = base["samplesPerSecond"].toDouble();
+            const double p99 = base["p99Us"].toDouble();
+            const double cpu = base["cpuUsPerSample"].toDouble();
+            if (run.samplesPerSecond() < rate * (1 - tolerance)) {
+                found << QString("%1: %2 samples/s, baseline %3").arg(name).arg(run.samplesPerSecond(), 0, 'f', 1).arg(rate, 0, 'f', 1);
+            }
+            if (p99 > 0 && run.p99Us > p99 * (1 + tolerance)) {
+                found << QString("%1: p99 %2 us, baseline %3").arg(name).arg(run.p99Us).arg(p99);
+            }
+            if (cpu > 0 && run.cpuUsPerSample > cpu * (1 + tolerance)) {
+                found << QString("%1: %2 us CPU/sample, baseline %3").arg(name).arg(run.cpuUsPerSample, 0, 'f', 1).arg(cpu, 0, 'f', 1);
+            }
+        }
+    }
+    return found;
+}
+
+void AcquisitionBench::log(const QString &message)
+{
+    // stdout carries the results; progress goes to stderr
+    qInfo().noquote() << QDateTime::currentDateTime().toString(Qt::ISODateWithMs) << message;
+}
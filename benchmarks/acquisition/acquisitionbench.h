@@ -0,0 +1,110 @@
+#ifndef ACQUISITIONBENCH_H
+#define ACQUISITIONBENCH_H
+
+#include <QObject>
+#include <QByteArrayView>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QTemporaryDir>
+#include <QTimer>
+#include "global.h"
+#include "latencyhistogram.h"
+
+class ConnectionManager;
+class ElmInterface;
+class LiveDataEngine;
+class WJInitSession;
+
+// One poll interval / signal count combination, measured after its warm-up
+struct BenchRun {
+    int intervalMs{0};
+    int signalCount{0};
+    double seconds{0};
+    quint64 samples{0};           // sensor values WJDataParser::decode filled in
+    quint32 p50Us{0};             // request written -> value decoded
+    quint32 p99Us{0};
+    double cpuUsPerSample{0};     // this process: UI thread, transport thread, everything
+    quint64 timeouts{0};
+    quint64 failed{0};            // replies that decoded to nothing (NO DATA, errors, short)
+
+    double samplesPerSecond() const { return seconds > 0 ? samples / seconds : 0; }
+    QJsonObject toJson() const;
+};
+
+// The acquisition path of the app end to end against an adapter on a TCP port:
+// ConnectionManager -> transport thread -> framing -> ElmInterface -> WJDataParser -> WJSensorData,
+// scheduled by LiveDataEngine. Connects, runs the WJ init once, then goes through every
+// interval x signal count pair, LiveDataEngine::defaultSignals() cut to that many signals.
+class AcquisitionBench : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options {
+        QList<int> intervalsMs{0, 100, 250};
+        QList<int> signalCounts{1, 5, 15};
+        int warmupMs{2000};
+        int durationMs{10000};
+    };
+
+    explicit AcquisitionBench(const Options &options, QObject *parent = nullptr);
+
+    void start(const QString &host, quint16 port);
+    const QList<BenchRun> &results() const;
+
+    // Runs of baseline (a results file) that this one is worse than by more than tolerance (0..1)
+    static QStringList regressions(const QList<BenchRun> &runs, const QJsonObject &baseline, double tolerance);
+
+signals:
+    void finished(bool ok);
+
+private slots:
+    void onConnected();
+    void onDisconnected();
+    void onInitCompleted();
+    void onCommandSent(quint32 id, const QString &command);
+    void onResponseReceived(quint32 id, const QString &command, WJModule module, const QStringList &lines);
+    void onMessageReceived(quint32 id, WJModule module, QByteArrayView message);
+    void decodeMessage(quint32 id, WJModule module, QByteArrayView message);
+    void onRequestTimedOut(quint32 id, const QString &command);
+    void startRun();
+    void beginMeasuring();
+    void endRun();
+
+private:
+    enum Phase { PHASE_IDLE, PHASE_INIT, PHASE_WARMUP, PHASE_MEASURE, PHASE_DRAIN };
+
+    int decodedValues();
+    void recordSample(quint32 id, int values);
+    void log(const QString &message);
+
+    Options m_options;
+    ConnectionManager *m_connectionManager{};
+    ElmInterface *m_elmInterface{};
+    LiveDataEngine *m_liveDataEngine{};
+    WJInitSession *m_initSession{};
+    QTimer m_initTimer;
+    QTimer m_phaseTimer;
+    QTimer m_drainTimer;
+    Phase m_phase{PHASE_IDLE};
+    int m_nextRun{0};
+
+    // Decoded into with every sensor value NaN, so the values a reply filled can be counted
+    WJSensorData m_sensorData;
+    WJSensorData m_unfilled;
+    // Holds the vehicles.ini the init session writes the 127.0.0.1 profile to
+    QTemporaryDir m_profileDir;
+    // Polled requests on the wire: write time, and whether a value came out of them yet
+    struct InFlight {
+        qint64 sentUs{0};
+        bool sampled{false};
+    };
+    QHash<quint32, InFlight> m_inFlight;
+    LatencyHistogram m_latencyUs;
+    BenchRun m_run;
+    qint64 m_startUs{0};
+    qint64 m_startCpuUs{0};
+    QList<BenchRun> m_results;
+};
+
+#endif // ACQUISITIONBENCH_H
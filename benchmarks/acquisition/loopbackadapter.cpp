@@ -0,0 +1,71 @@
+#include "loopbackadapter.h"
+#include <QHostAddress>
+
+LoopbackAdapter::LoopbackAdapter(const ElmSimulatorConfig &config, bool realTime, QObject *parent)
+    : QObject(parent)
+    , m_config(config)
+    , m_simulator(config)
+    , m_realTime(realTime)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &LoopbackAdapter::deliverPending);
+    connect(&m_server, &QTcpServer::newConnection, this, &LoopbackAdapter::onNewConnection);
+}
+
+bool LoopbackAdapter::listen(quint16 port)
+{
+    return m_server.listen(QHostAddress::LocalHost, port);
+}
+
+quint16 LoopbackAdapter::port() const
+{
+    return m_server.serverPort();
+}
+
+void LoopbackAdapter::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+        if (m_client) {
+            m_client->disconnect(this);
+            m_client->close();
+            m_client->deleteLater();
+        }
+        m_client = socket;
+        m_client->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(m_client, &QTcpSocket::readyRead, this, &LoopbackAdapter::onReadyRead);
+
+        m_simulator = ElmSimulator(m_config);
+        m_input.clear();
+        m_pending.clear();
+        m_timer.stop();
+    }
+}
+
+void LoopbackAdapter::onReadyRead()
+{
+    m_input.append(m_client->readAll());
+
+    qsizetype end;
+    while ((end = m_input.indexOf('\r')) >= 0) {
+        // A command written before the last answer went out finds that answer already sent
+        if (m_timer.isActive()) {
+            m_timer.stop();
+            deliverPending();
+        }
+
+        const ElmSimulatorReply reply = m_simulator.respond(QByteArrayView(m_input).first(end));
+        m_input.remove(0, end + 1);
+        m_pending.append(reply.bytes);
+        m_timer.start(m_realTime ? reply.latencyMs : 0);
+    }
+}
+
+void LoopbackAdapter::deliverPending()
+{
+    if (m_client && !m_pending.isEmpty()) {
+        m_client->write(m_pending);
+        m_client->flush();
+    }
+    m_pending.clear();
+}
@@ -0,0 +1,39 @@
+#ifndef LOOPBACKADAPTER_H
+#define LOOPBACKADAPTER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include "elmsimulator.h"
+
+// ElmSimulator behind a TCP port on 127.0.0.1, like a WiFi ELM327: the app connects with its
+// normal Wifi transport. One client at a time; each connection starts a fresh simulator.
+// In real-time mode answers are written after the simulator's latency, otherwise at once.
+class LoopbackAdapter : public QObject
+{
+    Q_OBJECT
+public:
+    LoopbackAdapter(const ElmSimulatorConfig &config, bool realTime, QObject *parent = nullptr);
+
+    // 0 picks a free port
+    bool listen(quint16 port = 0);
+    quint16 port() const;
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void deliverPending();
+
+private:
+    ElmSimulatorConfig m_config;
+    ElmSimulator m_simulator;
+    bool m_realTime{true};
+    QTcpServer m_server;
+    QTcpSocket *m_client{};
+    QByteArray m_input;
+    QByteArray m_pending;
+    QTimer m_timer;
+};
+
+#endif // LOOPBACKADAPTER_H
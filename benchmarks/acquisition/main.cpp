@@ -0,0 +1,157 @@
+// End-to-end acquisition benchmark: the app's whole polling path against a simulated ELM327
+// on a loopback TCP port, at several poll intervals and signal counts.
+// The adapter runs in a child process (this binary with --adapter) so its CPU isn't counted.
+// Regression gate for scheduler and transport changes:
+//   acquisition_bench --json=base.json                      (on the reference commit)
+//   acquisition_bench --baseline=base.json --tolerance=10   (exits 2 on a regression)
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QTextStream>
+#include "acquisitionbench.h"
+#include "loopbackadapter.h"
+
+namespace {
+
+QList<int> parseList(const QString &text)
+{
+    QList<int> values;
+    for (const QString &item : text.split(',', Qt::SkipEmptyParts)) {
+        values.append(item.trimmed().toInt());
+    }
+    return values;
+}
+
+void printResults(const QList<BenchRun> &runs)
+{
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+               .arg("interval ms", 11).arg("signals", 7).arg("samples/s", 10).arg("p50 us", 8)
+               .arg("p99 us", 8).arg("CPU us/sample", 13).arg("timeouts", 8).arg("failed", 6);
+    for (const BenchRun &run : runs) {
+        out << QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+                   .arg(run.intervalMs, 11).arg(run.signalCount, 7)
+                   .arg(run.samplesPerSecond(), 10, 'f', 1).arg(run.p50Us, 8).arg(run.p99Us, 8)
+                   .arg(run.cpuUsPerSample, 13, 'f', 1).arg(run.timeouts, 8).arg(run.failed, 6);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("acquisition_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Samples per second, latency and CPU per sample through the whole acquisition path.");
+    parser.addHelpOption();
+    QCommandLineOption intervalsOption("intervals", "Poll intervals (minimum cycle time) to run, in ms.", "list", "0,100,250");
+    QCommandLineOption signalsOption("signals", "Signal counts to run, 0 = all default signals.", "list", "1,5,0");
+    QCommandLineOption durationOption("duration", "Measured seconds per run.", "seconds", "10");
+    QCommandLineOption warmupOption("warmup", "Unmeasured seconds before each run.", "seconds", "2");
+    QCommandLineOption fastOption("fast", "Adapter answers without simulated latencies (host-bound).");
+    QCommandLineOption seedOption("seed", "Simulator seed.", "seed", "1");
+    QCommandLineOption jsonOption("json", "Write the results to <file>.", "file");
+    QCommandLineOption baselineOption("baseline", "Compare against the results in <file>.", "file");
+    QCommandLineOption toleranceOption("tolerance", "Allowed regression against the baseline, in percent.", "percent", "10");
+    QCommandLineOption adapterOption("adapter", "Only serve the simulated adapter on loopback and print its port.");
+    parser.addOptions({intervalsOption, signalsOption, durationOption, warmupOption, fastOption, seedOption,
+                       jsonOption, baselineOption, toleranceOption, adapterOption});
+    parser.process(app);
+
+    ElmSimulatorConfig simulatorConfig;
+    simulatorConfig.seed = parser.value(seedOption).toUInt();
+
+    if (parser.isSet(adapterOption)) {
+        LoopbackAdapter adapter(simulatorConfig, !parser.isSet(fastOption));
+        if (!adapter.listen()) {
+            qCritical() << "Cannot listen on loopback";
+            return 1;
+        }
+        QTextStream(stdout) << "port " << adapter.port() << Qt::endl;
+        return app.exec();
+    }
+
+    AcquisitionBench::Options options;
+    options.intervalsMs = parseList(parser.value(intervalsOption));
+    options.signalCounts = parseList(parser.value(signalsOption));
+    options.durationMs = qMax(1, int(parser.value(durationOption).toDouble() * 1000));
+    options.warmupMs = qMax(0, int(parser.value(warmupOption).toDouble() * 1000));
+    if (options.intervalsMs.isEmpty() || options.signalCounts.isEmpty()) {
+        qCritical() << "Nothing to run";
+        return 1;
+    }
+
+    QJsonObject baseline;
+    if (parser.isSet(baselineOption)) {
+        QFile file(parser.value(baselineOption));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCritical().noquote() << "Cannot read" << file.fileName();
+            return 1;
+        }
+        baseline = QJsonDocument::fromJson(file.readAll()).object();
+    }
+
+    QStringList adapterArguments{"--adapter", "--seed", parser.value(seedOption)};
+    if (parser.isSet(fastOption)) {
+        adapterArguments << "--fast";
+    }
+    QProcess adapter;
+    adapter.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    adapter.start(QCoreApplication::applicationFilePath(), adapterArguments);
+    while (adapter.waitForStarted() && !adapter.canReadLine()) {
+        if (!adapter.waitForReadyRead(5000)) {
+            break;
+        }
+    }
+    if (!adapter.canReadLine()) {
+        qCritical() << "Simulated adapter did not start";
+        return 1;
+    }
+    const quint16 port = quint16(QString::fromLatin1(adapter.readLine()).section(' ', 1).trimmed().toUInt());
+
+    AcquisitionBench bench(options);
+    QObject::connect(&bench, &AcquisitionBench::finished, &app, [&](bool ok) {
+        printResults(bench.results());
+
+        QJsonArray runs;
+        for (const BenchRun &run : bench.results()) {
+            runs.append(run.toJson());
+        }
+        QJsonObject results;
+        results["fast"] = parser.isSet(fastOption);
+        results["seed"] = qint64(simulatorConfig.seed);
+        results["runs"] = runs;
+        if (parser.isSet(jsonOption)) {
+            QFile file(parser.value(jsonOption));
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(QJsonDocument(results).toJson()) < 0) {
+                qCritical().noquote() << "Cannot write" << file.fileName();
+                ok = false;
+            }
+        }
+
+        int exitCode = ok ? 0 : 1;
+        if (ok && !baseline.isEmpty()) {
+            const QStringList regressions = AcquisitionBench::regressions(
+                bench.results(), baseline, parser.value(toleranceOption).toDouble() / 100);
+            for (const QString &regression : regressions) {
+                qCritical().noquote() << "Regression:" << regression;
+            }
+            if (!regressions.isEmpty()) {
+                exitCode = 2;
+            }
+        }
+
+        adapter.kill();
+        adapter.waitForFinished();
+        app.exit(exitCode);
+    });
+
+    bench.start("127.0.0.1", port);
+    return app.exec();
+}
@@ -0,0 +1,15 @@
+QT -= gui
+CONFIG += console c++17 release
+CONFIG -= app_bundle
+
+TARGET = hexdecode_bench
+TEMPLATE = app
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../hexdecode.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../hexdecode.h
@@ -0,0 +1,149 @@
+// Hex decoding microbenchmark: HexDecode against the token-at-a-time parsers it replaced.
+// Usage: hexdecode_bench [capture.txt]   (one ELM response line per row; built-in WJ capture otherwise)
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <string>
+#include "hexdecode.h"
+
+// Response lines: a 2.7 CRD WJ (EDC15 over KWP2000, TCM/PCM/ABS over J1850 VPW), then the
+// CAN forms the decoder also handles, from an ELM327 on a generic OBD-II simulator
+static const char *const RECORDED_TRAFFIC[] = {
+    "61 20 00 00 00 00 1C 1F 03 E8 02 7A",
+    "61 12 00 00 00 00 00 00 00 00 02 EE 02 F0",
+    "61 15 00 00 00 00 00 00 03 F2 03 E8",
+    "61 28 02 EE 00 A0 00 00 00 00 00 00 00 00 00 00 00 00 80 12 7F F0 80 05 7F FA 80 00",
+    "61 30 0B 90 0B 2C 00 00 00 00 00 00 00 00 00 64",
+    "C1 EF 8F",
+    "48 6B 18 41 00 BE 3F A8 13 7C",
+    "48 6B 18 41 0D 07 D0 07 A8 00 21",
+    "48 6B 10 41 06 82 7E 5A",
+    "48 6B 28 41 A0 02 58 02 5A 02 56 02 58 3F",
+    "410C1AF8",
+    "43 01 01 33 00 00",
+    "12.4V",
+    "NO DATA",
+    // Not from the WJ, which has no CAN module
+    "7E8 06 41 00 BE 3F A8 13",
+    "7E80441051F",
+};
+
+// Before: WJUtils::parseHexBytes (split + toInt per token)
+static QList<int> legacyParseHexBytes(const QString &data)
+{
+    QList<int> bytes;
+    const QStringList parts = data.split(" ", Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        if (part.length() == 2) {
+            bool ok;
+            int byte = part.toInt(&ok, 16);
+            if (ok) {
+                bytes.append(byte);
+            }
+        }
+    }
+    return bytes;
+}
+
+// Before: ELM::decodeNumberOfDtc (std::stoi on a std::string copy)
+static int legacyFirstByte(const QString &token)
+{
+    try {
+        return std::stoi(token.toStdString(), nullptr, 16);
+    } catch (...) {
+        return -1;
+    }
+}
+
+template<typename Fn>
+static double nsPerLine(const QStringList &lines, int rounds, Fn fn)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int r = 0; r < rounds; ++r) {
+        for (const QString &line : lines) {
+            fn(line);
+        }
+    }
+    return double(timer.nsecsElapsed()) / (double(rounds) * lines.size());
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QStringList lines;
+    if (argc > 1) {
+        QFile file(QString::fromLocal8Bit(argv[1]));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            out << "Cannot open " << argv[1] << Qt::endl;
+            return 1;
+        }
+        while (!file.atEnd()) {
+            const QString line = QString::fromLatin1(file.readLine()).trimmed();
+            if (!line.isEmpty()) {
+                lines.append(line);
+            }
+        }
+    } else {
+        for (const char *line : RECORDED_TRAFFIC) {
+            lines.append(QString::fromLatin1(line));
+        }
+    }
+    if (lines.isEmpty()) {
+        out << "No input lines" << Qt::endl;
+        return 1;
+    }
+
+    const int rounds = 20000;
+    volatile int sink = 0;
+
+    const double legacy = nsPerLine(lines, rounds, [&](const QString &line) {
+        sink = sink + legacyParseHexBytes(line).size();
+    });
+    const double simd = nsPerLine(lines, rounds, [&](const QString &line) {
+        quint8 bytes[256];
+        sink = sink + HexDecode::decode(QStringView(line), bytes, int(sizeof(bytes))).size;
+    });
+
+    QList<QByteArray> latin1Lines;
+    for (const QString &line : lines) {
+        latin1Lines.append(line.toLatin1());
+    }
+    QElapsedTimer timer;
+    timer.start();
+    for (int r = 0; r < rounds; ++r) {
+        for (const QByteArray &line : latin1Lines) {
+            quint8 bytes[256];
+            sink = sink + HexDecode::decode(QByteArrayView(line), bytes, int(sizeof(bytes))).size;
+        }
+    }
+    const double simdBytes = double(timer.nsecsElapsed()) / (double(rounds) * lines.size());
+
+    QStringList firstTokens;
+    for (const QString &line : lines) {
+        firstTokens.append(line.left(2));
+    }
+    const double legacyDtc = nsPerLine(firstTokens, rounds, [&](const QString &token) {
+        sink = sink + legacyFirstByte(token);
+    });
+    const double simdDtc = nsPerLine(firstTokens, rounds, [&](const QString &token) {
+        quint8 byte = 0;
+        HexDecode::decode(QStringView(token), &byte, 1);
+        sink = sink + byte;
+    });
+
+    out << "HexDecode implementation: " << HexDecode::implementation() << Qt::endl;
+    out << lines.size() << " lines x " << rounds << " rounds" << Qt::endl;
+    out << Qt::fixed << qSetRealNumberPrecision(1);
+    out << "parseHexBytes (split/toInt)      " << legacy << " ns/line" << Qt::endl;
+    out << "HexDecode (QString)              " << simd << " ns/line  x" << legacy / simd << Qt::endl;
+    out << "HexDecode (Latin-1 frame)        " << simdBytes << " ns/line  x" << legacy / simdBytes << Qt::endl;
+    out << "decodeNumberOfDtc (std::stoi)    " << legacyDtc << " ns/token" << Qt::endl;
+    out << "HexDecode single byte            " << simdDtc << " ns/token  x" << legacyDtc / simdDtc << Qt::endl;
+    return 0;
+}
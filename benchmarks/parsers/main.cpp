@@ -0,0 +1,434 @@
+// Parsing and decoding hot paths on a corpus of ELM responses, per response type.
+// Usage: parsers_bench [--capture=<file>] [Google Benchmark flags]
+//   --capture   a TrafficCapture file (obdreader --capture); its responses replace the
+//               built-in corpus, sorted into the same types
+// Compare runs across commits with --benchmark_format=json --benchmark_out=<file>
+// and Google Benchmark's tools/compare.py; the built-in corpus is fixed, so runs are comparable.
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+#include "elm.h"
+#include "elmadapterstate.h"
+#include "elmframer.h"
+#include "elmsimulator.h"
+#include "global.h"
+#include "hexdecode.h"
+#include "trafficcapture.h"
+#include "wjcommandtable.h"
+
+// Response types the corpus is split into
+static const char *const KIND_CAN = "can";
+static const char *const KIND_KWP = "kwp";
+static const char *const KIND_J1850 = "j1850";
+static const char *const KIND_MULTILINE = "multiline";
+
+// Responses recorded from a 2.7 CRD WJ (EDC15 over KWP2000, TCM/PCM/ABS over J1850 VPW),
+// and CAN replies of an ELM327 on an OBD-II simulator for the CAN paths
+static const struct { const char *kind; const char *response; } RECORDED_TRAFFIC[] = {
+    {KIND_KWP, "61 20 00 00 00 00 1C 1F 03 E8 02 7A"},
+    {KIND_KWP, "61 12 00 00 00 00 00 00 00 00 02 EE 02 F0"},
+    {KIND_KWP, "61 15 00 00 00 00 00 00 03 F2 03 E8"},
+    {KIND_KWP, "61 28 02 EE 00 A0 00 00 00 00 00 00 00 00 00 00 00 00 80 12 7F F0 80 05 7F FA 80 00"},
+    {KIND_KWP, "61 30 0B 90 0B 2C 00 00 00 00 00 00 00 00 00 64"},
+    {KIND_KWP, "C1 EF 8F"},
+    {KIND_KWP, "83 F1 15 C1 EF 8F C4"},
+    {KIND_KWP, "7F 21 11"},
+    {KIND_J1850, "48 6B 18 41 00 BE 3F A8 13 7C"},
+    {KIND_J1850, "48 6B 18 41 0D 07 D0 07 A8 00 21"},
+    {KIND_J1850, "48 6B 10 41 06 82 7E 5A"},
+    {KIND_J1850, "48 6B 28 41 A0 02 58 02 5A 02 56 02 58 3F"},
+    {KIND_J1850, "43 01 01 33 00 00"},
+    {KIND_J1850, "410C1AF8"},
+    {KIND_CAN, "7E8 06 41 00 BE 3F A8 13"},
+    {KIND_CAN, "7E80441051F"},
+    {KIND_CAN, "7E8 06 43 02 01 33 00 00"},
+    {KIND_MULTILINE, "7E8 10 14 49 02 01 31 44 34\r7E8 21 47 50 30 30 52 35 35\r7E8 22 42 31 32 33 34 35 36"},
+    {KIND_MULTILINE, "014\r0: 49 02 01 31 44 34\r1: 47 50 30 30 52 35 35\r2: 42 31 32 33 34 35 36"},
+    {KIND_MULTILINE, "43 01 01 33 00 00\r43 01 04 20 00 00"},
+    {KIND_MULTILINE, "48 6B 18 43 01 01 33 00 00 A2\r48 6B 10 43 04 20 00 00 00 5E"},
+};
+
+struct Corpus {
+    std::map<QString, QStringList> responses;          // kind -> responses
+    std::map<WJCommandId, QStringList> commandReplies;  // without headers, as the parsers get them
+    QStringList dtcResponses;                          // "43 ..." lines
+};
+
+static Corpus &corpus()
+{
+    static Corpus instance;
+    return instance;
+}
+
+static QString kindOf(const QString &response)
+{
+    if (response.contains('\r')) {
+        return KIND_MULTILINE;
+    }
+
+    // CAN ids are three hex digits (or eight for 29 bit), the J1850/KWP header is bytes
+    const qsizetype space = response.indexOf(' ');
+    if (space == 3 || space == 8 || (space < 0 && response.size() % 2 == 1)) {
+        return KIND_CAN;
+    }
+
+    quint8 bytes[256];
+    if (HexDecode::decode(QStringView(response), bytes, int(sizeof(bytes))).size < 1) {
+        return QString();
+    }
+    // Mode 01/03/09 replies and the 48 6B header are J1850 on a WJ; KWP is everything else
+    const quint8 first = bytes[0];
+    return (first == 0x48 || (first >= 0x41 && first <= 0x49)) ? KIND_J1850 : KIND_KWP;
+}
+
+static void addResponse(const QString &response)
+{
+    const QString kind = kindOf(response);
+    if (kind.isEmpty() || WJUtils::isError(response, PROTOCOL_UNKNOWN)) {
+        return;
+    }
+    corpus().responses[kind].append(response);
+    if (response.startsWith("43")) {
+        corpus().dtcResponses.append(response);
+    }
+}
+
+// Responses of one capture: lines up to each prompt make one response
+static bool loadCapture(const QString &path)
+{
+    QList<TrafficRecord> records;
+    if (!TrafficCapture::load(path, records)) {
+        return false;
+    }
+
+    QStringList lines;
+    ElmFramer framer;
+    framer.setLineHandler([&lines](QByteArrayView line) {
+        const QString text = QString::fromLatin1(line).trimmed();
+        if (!text.isEmpty() && !text.startsWith("BUS INIT") && !text.startsWith("SEARCHING")) {
+            lines.append(text);
+        }
+    });
+    framer.setPromptHandler([&lines]() {
+        if (!lines.isEmpty()) {
+            addResponse(lines.join('\r'));
+            lines.clear();
+        }
+    });
+
+    for (const TrafficRecord &record : records) {
+        if (record.kind == TrafficRecord::Rx) {
+            framer.append(record.bytes.constData(), record.bytes.size());
+        } else if (record.kind == TrafficRecord::Tx) {
+            lines.clear();   // the echo of the next command
+        }
+    }
+    return true;
+}
+
+// The replies every WJDataParser::parse* function expects come from the simulator, which
+// answers with the WJ layouts; a fixed seed keeps the values identical from run to run.
+// False if a command got no usable reply: its benchmarks would measure an empty loop.
+static bool loadCommandReplies()
+{
+    ElmSimulatorConfig config;
+    config.seed = 1;
+    ElmSimulator simulator(config);
+
+    auto send = [&simulator](const QString &command) {
+        QStringList lines;
+        const QByteArray reply = simulator.respond(command.toLatin1()).bytes;
+        for (const QByteArray &line : reply.split('\r')) {
+            const QString text = QString::fromLatin1(line).remove('>').trimmed();
+            if (!text.isEmpty() && !text.startsWith("BUS INIT") && !text.startsWith("SEARCHING")) {
+                lines.append(text);
+            }
+        }
+        return lines;
+    };
+
+    for (const char *setup : {"ATZ", "ATE0", "ATL0", "ATS1", "ATH0"}) {
+        send(setup);
+    }
+
+    WJModule module = MODULE_UNKNOWN;
+    for (const WJCommandDescriptor &d : WJCommandTable::TABLE) {
+        if (d.parser == PARSER_NONE || d.adapterCommand) {
+            continue;
+        }
+        if (d.module != module) {
+            module = d.module;
+            send(d.protocol == PROTOCOL_J1850_VPW ? "ATSP2" : "ATSP5");
+            send("ATSH" + ElmAdapterState::forModule(d.module).header);
+        }
+        // A few samples per command, the simulated drive moves on between them
+        for (int i = 0; i < 4; ++i) {
+            const QStringList lines = send(QString::fromLatin1(d.text));
+            if (lines.isEmpty() || WJUtils::isError(lines.first(), d.protocol)) {
+                continue;
+            }
+            corpus().commandReplies[d.id].append(lines.join(' '));
+            if (d.parser == PARSER_DTC) {
+                corpus().dtcResponses.append(lines.join(' '));
+            }
+        }
+    }
+
+    bool complete = true;
+    for (const WJCommandDescriptor &d : WJCommandTable::TABLE) {
+        if (d.parser != PARSER_NONE && !d.adapterCommand && corpus().commandReplies[d.id].isEmpty()) {
+            fprintf(stderr, "No simulator reply for %s\n", d.text);
+            complete = false;
+        }
+    }
+    return complete;
+}
+
+// A benchmark over nothing reports a meaningless rate; stop instead
+static void requireInputs(const char *name, qsizetype count)
+{
+    if (count == 0) {
+        fprintf(stderr, "Empty corpus for %s\n", name);
+        std::exit(1);
+    }
+}
+
+// Benchmarks go through the list once per iteration; items/s is per response
+template<typename Fn>
+static void runOver(benchmark::State &state, const QStringList &inputs, Fn fn)
+{
+    for (auto _ : state) {
+        for (const QString &input : inputs) {
+            fn(input);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+
+static WJProtocol protocolOf(const QString &kind)
+{
+    if (kind == KIND_KWP) {
+        return PROTOCOL_ISO_14230_4_KWP_FAST;
+    }
+    if (kind == KIND_J1850) {
+        return PROTOCOL_J1850_VPW;
+    }
+    return PROTOCOL_UNKNOWN;
+}
+
+static void registerResponseBenchmarks(const QString &kind, const QStringList &inputs)
+{
+    const std::string suffix = "/" + kind.toStdString();
+    requireInputs(("responses" + suffix).c_str(), inputs.size());
+    const WJProtocol protocol = protocolOf(kind);
+
+    benchmark::RegisterBenchmark(("ELM::prepareResponseToDecode" + suffix).c_str(), [inputs](benchmark::State &state) {
+        ELM elm;
+        runOver(state, inputs, [&elm](const QString &input) {
+            benchmark::DoNotOptimize(elm.prepareResponseToDecode(input));
+        });
+    });
+    benchmark::RegisterBenchmark(("WJUtils::parseHexBytes" + suffix).c_str(), [inputs](benchmark::State &state) {
+        runOver(state, inputs, [](const QString &input) {
+            benchmark::DoNotOptimize(WJUtils::parseHexBytes(input));
+        });
+    });
+    benchmark::RegisterBenchmark(("WJUtils::cleanData" + suffix).c_str(), [inputs, protocol](benchmark::State &state) {
+        runOver(state, inputs, [protocol](const QString &input) {
+            benchmark::DoNotOptimize(WJUtils::cleanData(input, protocol));
+        });
+    });
+    benchmark::RegisterBenchmark(("WJUtils::isError" + suffix).c_str(), [inputs, protocol](benchmark::State &state) {
+        runOver(state, inputs, [protocol](const QString &input) {
+            benchmark::DoNotOptimize(WJUtils::isError(input, protocol));
+        });
+    });
+}
+
+static void registerDtcBenchmarks()
+{
+    // decodeDTC gets the bytes after the mode byte, as prepared by prepareResponseToDecode
+    ELM elm;
+    std::vector<std::vector<QString>> tokens;
+    for (const QString &response : corpus().dtcResponses) {
+        std::vector<QString> values = elm.prepareResponseToDecode(response);
+        if (!values.empty()) {
+            values.erase(values.begin());
+            tokens.push_back(values);
+        }
+    }
+    benchmark::RegisterBenchmark("ELM::decodeDTC", [tokens](benchmark::State &state) {
+        ELM elm;
+        for (auto _ : state) {
+            for (const std::vector<QString> &values : tokens) {
+                benchmark::DoNotOptimize(elm.decodeDTC(values));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * qint64(tokens.size()));
+    });
+
+    requireInputs("ELM::decodeDTC", qsizetype(tokens.size()));
+
+    const QStringList &dtcs = corpus().dtcResponses;
+    benchmark::RegisterBenchmark("WJDataParser::parseEngineFaultCodes", [dtcs](benchmark::State &state) {
+        runOver(state, dtcs, [](const QString &input) { benchmark::DoNotOptimize(WJDataParser::parseEngineFaultCodes(input)); });
+    });
+    benchmark::RegisterBenchmark("WJDataParser::parseTransmissionFaultCodes", [dtcs](benchmark::State &state) {
+        runOver(state, dtcs, [](const QString &input) { benchmark::DoNotOptimize(WJDataParser::parseTransmissionFaultCodes(input)); });
+    });
+    benchmark::RegisterBenchmark("WJDataParser::parsePCMFaultCodes", [dtcs](benchmark::State &state) {
+        runOver(state, dtcs, [](const QString &input) { benchmark::DoNotOptimize(WJDataParser::parsePCMFaultCodes(input)); });
+    });
+    benchmark::RegisterBenchmark("WJDataParser::parseABSFaultCodes", [dtcs](benchmark::State &state) {
+        runOver(state, dtcs, [](const QString &input) { benchmark::DoNotOptimize(WJDataParser::parseABSFaultCodes(input)); });
+    });
+
+    // The path the module-specific parsers share: EDC15 lists over KWP2000, the others over J1850
+    const QStringList engineDtcs = corpus().commandReplies[CMD_ENGINE_READ_DTC];
+    requireInputs("WJDataParser::parseGenericFaultCodes/kwp", engineDtcs.size());
+    benchmark::RegisterBenchmark("WJDataParser::parseGenericFaultCodes/kwp", [engineDtcs](benchmark::State &state) {
+        runOver(state, engineDtcs, [](const QString &input) {
+            benchmark::DoNotOptimize(WJDataParser::parseGenericFaultCodes(input, MODULE_ENGINE_EDC15, PROTOCOL_ISO_14230_4_KWP_FAST));
+        });
+    });
+    benchmark::RegisterBenchmark("WJDataParser::parseGenericFaultCodes/j1850", [dtcs](benchmark::State &state) {
+        runOver(state, dtcs, [](const QString &input) {
+            benchmark::DoNotOptimize(WJDataParser::parseGenericFaultCodes(input, MODULE_TRANSMISSION, PROTOCOL_J1850_VPW));
+        });
+    });
+}
+
+// WJDataParser::decode, the dispatch the app uses: from text (adapter lines) and from the
+// bytes ElmInterface::messageReceived hands over, over every table command's replies
+static void registerDecodeBenchmarks()
+{
+    struct Reply {
+        WJModule module;
+        QString text;
+        QByteArray bytes;
+    };
+    QList<Reply> replies;
+    for (const WJCommandDescriptor &d : WJCommandTable::TABLE) {
+        if (d.parser == PARSER_NONE || d.parser == PARSER_DTC || d.adapterCommand) {
+            continue;
+        }
+        for (const QString &text : corpus().commandReplies[d.id]) {
+            quint8 bytes[256];
+            const HexDecode::Result decoded = HexDecode::decode(QStringView(text), bytes, int(sizeof(bytes)));
+            if (decoded.isValid() && decoded.size > 0) {
+                replies.append({d.module, text, QByteArray(reinterpret_cast<const char *>(bytes), decoded.size)});
+            }
+        }
+    }
+    requireInputs("WJDataParser::decode", replies.size());
+
+    benchmark::RegisterBenchmark("WJDataParser::decode/text", [replies](benchmark::State &state) {
+        WJSensorData data;
+        data.reset();
+        for (auto _ : state) {
+            for (const Reply &reply : replies) {
+                benchmark::DoNotOptimize(WJDataParser::decode(reply.text, reply.module, data));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * replies.size());
+    });
+    benchmark::RegisterBenchmark("WJDataParser::decode/bytes", [replies](benchmark::State &state) {
+        WJSensorData data;
+        data.reset();
+        for (auto _ : state) {
+            for (const Reply &reply : replies) {
+                benchmark::DoNotOptimize(WJDataParser::decode(reinterpret_cast<const quint8 *>(reply.bytes.constData()),
+                                                              int(reply.bytes.size()), reply.module, data));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * replies.size());
+    });
+}
+
+typedef bool (*SensorParser)(const QString &data, WJSensorData &sensorData);
+
+static void registerSensorParser(const char *name, SensorParser parser, const QStringList &inputs)
+{
+    requireInputs(name, inputs.size());
+    benchmark::RegisterBenchmark(name, [parser, inputs](benchmark::State &state) {
+        WJSensorData data;
+        data.reset();
+        runOver(state, inputs, [parser, &data](const QString &input) {
+            benchmark::DoNotOptimize(parser(input, data));
+        });
+    });
+}
+
+static void registerParserBenchmarks()
+{
+    const auto replies = [](WJCommandId command) { return corpus().commandReplies[command]; };
+
+    registerSensorParser("WJDataParser::parseEngineMAFData", &WJDataParser::parseEngineMAFData, replies(CMD_ENGINE_READ_MAF_DATA));
+    registerSensorParser("WJDataParser::parseEngineRailPressureData", &WJDataParser::parseEngineRailPressureData, replies(CMD_ENGINE_READ_RAIL_PRESSURE_ACTUAL));
+    registerSensorParser("WJDataParser::parseEngineMAPData", &WJDataParser::parseEngineMAPData, replies(CMD_ENGINE_READ_MAP_DATA));
+    registerSensorParser("WJDataParser::parseEngineInjectorData", &WJDataParser::parseEngineInjectorData, replies(CMD_ENGINE_READ_INJECTOR_DATA));
+    registerSensorParser("WJDataParser::parseEngineMiscData", &WJDataParser::parseEngineMiscData, replies(CMD_ENGINE_READ_MISC_DATA));
+    registerSensorParser("WJDataParser::parseEngineBatteryVoltage", &WJDataParser::parseEngineBatteryVoltage, {"12.4V", "14.1V", "11.9V"});
+    registerSensorParser("WJDataParser::parseTransmissionData", &WJDataParser::parseTransmissionData, replies(CMD_TRANS_READ_TRANS_DATA));
+    registerSensorParser("WJDataParser::parseTransmissionSpeeds", &WJDataParser::parseTransmissionSpeeds, replies(CMD_TRANS_READ_SPEED_DATA));
+    registerSensorParser("WJDataParser::parseTransmissionSolenoids", &WJDataParser::parseTransmissionSolenoids, replies(CMD_TRANS_READ_SOLENOID_STATUS));
+    registerSensorParser("WJDataParser::parsePCMData", &WJDataParser::parsePCMData, replies(CMD_PCM_READ_LIVE_DATA));
+    registerSensorParser("WJDataParser::parsePCMFuelTrim", &WJDataParser::parsePCMFuelTrim, replies(CMD_PCM_READ_FUEL_TRIM));
+    registerSensorParser("WJDataParser::parsePCMO2Sensors", &WJDataParser::parsePCMO2Sensors, replies(CMD_PCM_READ_O2_SENSORS));
+    registerSensorParser("WJDataParser::parseABSWheelSpeeds", &WJDataParser::parseABSWheelSpeeds, replies(CMD_ABS_READ_WHEEL_SPEEDS));
+    registerSensorParser("WJDataParser::parseABSStabilityData", &WJDataParser::parseABSStabilityData, replies(CMD_ABS_READ_STABILITY_DATA));
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // Our own flag first, Google Benchmark rejects what it doesn't know
+    QString capturePath;
+    std::vector<char *> args;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--capture=", 10) == 0) {
+            capturePath = QString::fromLocal8Bit(argv[i] + 10);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+
+    if (!capturePath.isEmpty()) {
+        if (!loadCapture(capturePath)) {
+            fprintf(stderr, "Cannot read capture %s\n", qPrintable(capturePath));
+            return 1;
+        }
+    } else {
+        for (const auto &recorded : RECORDED_TRAFFIC) {
+            corpus().responses[recorded.kind].append(QString::fromLatin1(recorded.response));
+            if (std::strncmp(recorded.response, "43", 2) == 0) {
+                corpus().dtcResponses.append(QString::fromLatin1(recorded.response));
+            }
+        }
+    }
+    if (!loadCommandReplies()) {
+        return 1;
+    }
+
+    for (const auto &entry : corpus().responses) {
+        registerResponseBenchmarks(entry.first, entry.second);
+    }
+    registerDtcBenchmarks();
+    registerParserBenchmarks();
+    registerDecodeBenchmarks();
+
+    int benchmarkArgc = int(args.size());
+    benchmark::Initialize(&benchmarkArgc, args.data());
+    if (benchmark::ReportUnrecognizedArguments(benchmarkArgc, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,21 @@
+QT -= gui
+CONFIG += console c++17 release
+CONFIG -= app_bundle
+
+TARGET = parsers_bench
+TEMPLATE = app
+
+# The parsers are measured as built for the app, with the core they live in
+include(../../obdcore.pri)
+
+# Google Benchmark (libbenchmark-dev, brew install google-benchmark); another prefix with
+# qmake BENCHMARK_PREFIX=/path
+!isEmpty(BENCHMARK_PREFIX) {
+    INCLUDEPATH += $$BENCHMARK_PREFIX/include
+    LIBS += -L$$BENCHMARK_PREFIX/lib
+}
+LIBS += -lbenchmark
+unix: LIBS += -lpthread
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,278 @@
+// Equivalence fuzzer for ELM::prepareResponseToDecode: the classifier against the regex
+// cascade it replaced, ported below unchanged. Exits non-zero on the first different token list.
+// Usage: responsefuzz [iterations] [seed]   (default 1000000 inputs, random seed)
+
+#include <QCoreApplication>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QStringList>
+#include <cstdio>
+#include <vector>
+#include "elm.h"
+
+// Real responses the mutations start from: KWP2000, J1850, CAN, multi-line and adapter text
+static const char *const SEEDS[] = {
+    "61 20 00 00 00 00 1C 1F 03 E8 02 7A",
+    "83 F1 15 C1 EF 8F C4",
+    "7F 21 11",
+    "48 6B 18 41 00 BE 3F A8 13 7C",
+    "48 6B 10 41 06 82 7E 5A",
+    "43 01 01 33 00 00",
+    "410C1AF8",
+    "7E8 06 41 00 BE 3F A8 13",
+    "7E80441051F",
+    "7E8 10 14 49 02 01 31 44 34\r7E8 21 47 50 30 30 52 35 35",
+    "014\r0: 49 02 01 31 44 34\r1: 47 50 30 30 52 35 35",
+    "48 6B 18 43 01 01 33 00 00 A2\r48 6B 10 43 04 20 00 00 00 5E>",
+    "SEARCHING...\r41 0C 1A F8",
+    "NO DATA",
+    "12.4V",
+};
+
+// Characters the fuzzer draws from, weighted towards what an adapter sends
+static const char ALPHABET[] = "0123456789ABCDEF0123456789ABCDEFabcdef4444    \r\n>:.?XYZ7E";
+
+// The previous ELM::prepareResponseToDecode, kept as the reference
+static std::vector<QString> referencePrepare(const QString &response_str)
+{
+    std::vector<QString> result;
+    result.reserve(16); // Reserve space for typical response size
+
+    // Clean the input string
+    QString cleanedResponse = response_str.trimmed();
+
+    // Special case for raw CAN responses like "7E8034105F"
+    if (cleanedResponse.startsWith("7E", Qt::CaseInsensitive) && !cleanedResponse.contains(" ")) {
+        // Insert spaces for better processing (7E8034105F -> 7E8 03 41 05 5F)
+        QString spacedResponse;
+
+        // First 3 characters are usually the ECU ID
+        if (cleanedResponse.length() >= 3) {
+            spacedResponse = cleanedResponse.left(3) + " ";
+        }
+
+        // Insert spaces every 2 characters after the ECU ID
+        for (int i = 3; i < cleanedResponse.length(); i += 2) {
+            if (i + 1 < cleanedResponse.length()) {
+                spacedResponse += cleanedResponse.mid(i, 2) + " ";
+            } else {
+                spacedResponse += cleanedResponse.mid(i, 1);
+            }
+        }
+
+        cleanedResponse = spacedResponse.trimmed();
+    }
+
+    // Handle CAN format responses (e.g., "7E8 03 41 0C 20 00")
+    if (cleanedResponse.startsWith("7E", Qt::CaseInsensitive) && cleanedResponse.contains(" ")) {
+        QStringList parts = cleanedResponse.split(" ", Qt::SkipEmptyParts);
+
+        // Check if it's a valid CAN response with enough parts
+        if (parts.size() >= 3) {
+            // Find index of mode response (41, 42, etc.)
+            int modeIndex = -1;
+            for (int i = 0; i < parts.size(); i++) {
+                if (parts[i].startsWith("4", Qt::CaseInsensitive) && parts[i].length() == 2) {
+                    // Mode responses are 41 (mode 1), 42 (mode 2), etc.
+                    char secondChar = parts[i].at(1).toLatin1();
+                    if ((secondChar >= '0' && secondChar <= '9') ||
+                        (secondChar >= 'A' && secondChar <= 'F')) {
+                        modeIndex = i;
+                        break;
+                    }
+                }
+            }
+
+            // If we found a mode response, extract it and following data
+            if (modeIndex >= 0) {
+                // Extract mode, PID, and data bytes
+                for (int i = modeIndex; i < parts.size(); i++) {
+                    if (!parts[i].isEmpty()) {
+                        result.push_back(parts[i]);
+                    }
+                }
+                return result;
+            }
+        }
+    }
+
+    // Handle ISO_14230_4_KWP_FAST, ISO 14230-4 (KWP2000), and generic responses
+    // These typically come in formats like "41 0C 20 00" without header bytes
+    if (cleanedResponse.contains(QRegularExpression("^[0-9A-F]{2} [0-9A-F]{2}",
+                                                    QRegularExpression::CaseInsensitiveOption))) {
+        QStringList parts = cleanedResponse.split(" ", Qt::SkipEmptyParts);
+
+        // Check if it's a valid OBD response
+        if (parts.size() >= 2) {
+            // Handle standard responses
+            if (parts[0].startsWith("4", Qt::CaseInsensitive) && parts[0].length() == 2) {
+                // Add all parts to result
+                for (const auto& part : parts) {
+                    if (!part.isEmpty()) {
+                        result.push_back(part);
+                    }
+                }
+
+                return result;
+            }
+        }
+    }
+
+    // Handle SAE J1850 PWM, SAE J1850 VPW, and raw unspaced responses
+    // These might come as continuous hex strings like "410C2000"
+    if (cleanedResponse.contains(QRegularExpression("^[0-9A-F]{4,}",
+                                                    QRegularExpression::CaseInsensitiveOption))) {
+        // Check if it starts with a valid mode response
+        if (cleanedResponse.startsWith("41", Qt::CaseInsensitive) ||
+            cleanedResponse.startsWith("42", Qt::CaseInsensitive) ||
+            cleanedResponse.startsWith("43", Qt::CaseInsensitive) ||
+            cleanedResponse.startsWith("44", Qt::CaseInsensitive) ||
+            cleanedResponse.startsWith("45", Qt::CaseInsensitive) ||
+            cleanedResponse.startsWith("46", Qt::CaseInsensitive)) {
+
+            // Split into 2-character chunks
+            for (int i = 0; i < cleanedResponse.length(); i += 2) {
+                if (i + 1 < cleanedResponse.length()) {
+                    result.push_back(cleanedResponse.mid(i, 2));
+                }
+            }
+            return result;
+        }
+    }
+
+    // Handle multiline responses and merge them if needed
+    if (cleanedResponse.contains(">") || cleanedResponse.contains("\r")) {
+        QStringList lines = cleanedResponse.split(QRegularExpression("[>\r\n]"), Qt::SkipEmptyParts);
+        QString mergedResponse;
+
+        for (const auto& line : lines) {
+            mergedResponse += line.trimmed() + " ";
+        }
+
+        // Recursively process the merged response
+        return referencePrepare(mergedResponse.trimmed());
+    }
+
+    // Final fallback - if we can't identify the format but the string is longer than 4 chars
+    // Try to extract a mode response (41, 42, etc.) from anywhere in the string
+    if (cleanedResponse.length() > 4) {
+        for (int i = 0; i < cleanedResponse.length() - 1; i++) {
+            QString potential = cleanedResponse.mid(i, 2);
+            if (potential.startsWith("4", Qt::CaseInsensitive)) {
+                char secondChar = potential.at(1).toLatin1();
+                if ((secondChar >= '0' && secondChar <= '9') ||
+                    (secondChar >= 'A' && secondChar <= 'F')) {
+
+                    // Found a potential mode response - extract from here to the end
+                    QString subResponse = cleanedResponse.mid(i);
+
+                    // Split into 2-character chunks
+                    for (int j = 0; j < subResponse.length(); j += 2) {
+                        if (j + 1 < subResponse.length()) {
+                            result.push_back(subResponse.mid(j, 2));
+                        }
+                    }
+
+                    if (!result.empty()) {
+                        return result;
+                    }
+                }
+            }
+        }
+    }
+
+    // Absolute last resort - just split the entire string into 2-char chunks
+    if (result.empty()) {
+        for (int i = 0; i < cleanedResponse.length(); i += 2) {
+            if (i + 1 < cleanedResponse.length()) {
+                result.push_back(cleanedResponse.mid(i, 2));
+            } else if (i < cleanedResponse.length()) {
+                result.push_back(cleanedResponse.mid(i, 1));
+            }
+        }
+    }  
+
+    return result;
+}
+
+static QString randomInput(QRandomGenerator &rng)
+{
+    const int length = rng.bounded(0, 40);
+    QString text;
+    for (int i = 0; i < length; ++i) {
+        text += QLatin1Char(ALPHABET[rng.bounded(int(sizeof(ALPHABET) - 1))]);
+    }
+    return text;
+}
+
+static QString mutatedInput(QRandomGenerator &rng)
+{
+    QString text = QString::fromLatin1(SEEDS[rng.bounded(int(sizeof(SEEDS) / sizeof(SEEDS[0])))]);
+    const int edits = rng.bounded(1, 5);
+    for (int i = 0; i < edits; ++i) {
+        const QChar c = QLatin1Char(ALPHABET[rng.bounded(int(sizeof(ALPHABET) - 1))]);
+        const int at = text.isEmpty() ? 0 : rng.bounded(int(text.size()));
+        switch (rng.bounded(5)) {
+        case 0:
+            text.insert(at, c);
+            break;
+        case 1:
+            text.remove(at, 1);
+            break;
+        case 2:
+            if (!text.isEmpty()) {
+                text[at] = c;
+            }
+            break;
+        case 3:
+            text = text.toLower();
+            break;
+        default:
+            text.remove(QLatin1Char(' '));
+            break;
+        }
+    }
+    return text;
+}
+
+static QString escaped(const QString &text)
+{
+    QString result = text;
+    return result.replace("\r", "\\r").replace("\n", "\\n");
+}
+
+static void printTokens(const char *label, const std::vector<QString> &tokens)
+{
+    QStringList list;
+    for (const QString &token : tokens) {
+        list << token;
+    }
+    std::printf("  %s: [%s]\n", label, qPrintable(list.join(", ")));
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const qint64 iterations = args.size() > 1 ? args.at(1).toLongLong() : 1000000;
+    const quint32 seed = args.size() > 2 ? args.at(2).toUInt() : QRandomGenerator::global()->generate();
+    QRandomGenerator rng(seed);
+
+    ELM *elm = ELM::getInstance();
+    std::printf("seed %u, %lld inputs\n", seed, iterations);
+
+    for (qint64 i = 0; i < iterations; ++i) {
+        const QString input = (i & 1) ? mutatedInput(rng) : randomInput(rng);
+        const std::vector<QString> expected = referencePrepare(input);
+        const std::vector<QString> actual = elm->prepareResponseToDecode(input);
+        if (actual != expected) {
+            std::printf("mismatch after %lld inputs on \"%s\"\n", i, qPrintable(escaped(input)));
+            printTokens("reference ", expected);
+            printTokens("classifier", actual);
+            return 1;
+        }
+    }
+
+    std::printf("no differences\n");
+    return 0;
+}
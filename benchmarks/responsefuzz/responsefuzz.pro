@@ -0,0 +1,12 @@
+QT -= gui
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+TARGET = responsefuzz
+TEMPLATE = app
+
+# The classifier is checked as built for the app, with the core it lives in
+include(../../obdcore.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,172 @@
+// Load driver for ElmSimulator: whole sessions (the app's cold init, every table command of
+// every module, the protocol switches in between) back to back on one or more threads.
+// Each session gets its own seed, so a run covers many different drives.
+// Usage: simulatorload [--sessions=N] [--threads=N] [--rounds=N] [--no-data=rate] [--bus-errors=rate]
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "elmadapterstate.h"
+#include "elmsimulator.h"
+#include "global.h"
+#include "wjcommandtable.h"
+
+namespace {
+
+struct Script {
+    QList<QByteArray> init;      // once per session
+    QList<QByteArray> polling;   // once per round
+};
+
+struct Totals {
+    quint64 sessions{0};
+    quint64 commands{0};
+    quint64 bytes{0};
+    quint64 simulatedMs{0};
+    quint64 unknown{0};   // "?": the simulator doesn't understand a command the app sends
+    quint64 noData{0};
+    quint64 errors{0};
+};
+
+QByteArray line(const QString &command)
+{
+    return command.toLatin1() + '\r';
+}
+
+void appendCommands(QList<QByteArray> &out, const QList<WJCommand> &commands)
+{
+    for (const WJCommand &command : commands) {
+        out.append(line(command.command));
+    }
+}
+
+// What the app sends in a session, in its order: engine first, then the J1850 modules
+Script buildScript()
+{
+    Script script;
+    appendCommands(script.init, WJCommands::getInitSequence(PROTOCOL_ISO_14230_4_KWP_FAST));
+
+    for (WJProtocol protocol : {PROTOCOL_ISO_14230_4_KWP_FAST, PROTOCOL_J1850_VPW}) {
+        if (protocol == PROTOCOL_J1850_VPW) {
+            appendCommands(script.polling, WJCommands::getProtocolSwitchCommands(PROTOCOL_ISO_14230_4_KWP_FAST, protocol));
+        }
+        WJModule module = MODULE_UNKNOWN;
+        for (const WJCommandDescriptor &d : WJCommandTable::TABLE) {
+            if (d.protocol != protocol || d.parser == PARSER_NONE || d.adapterCommand) {
+                continue;
+            }
+            if (d.module != module) {
+                module = d.module;
+                script.polling.append(line("ATSH" + ElmAdapterState::forModule(module).header));
+            }
+            script.polling.append(d.wireBytes().toByteArray());
+        }
+    }
+    appendCommands(script.polling, WJCommands::getProtocolSwitchCommands(PROTOCOL_J1850_VPW, PROTOCOL_ISO_14230_4_KWP_FAST));
+    return script;
+}
+
+void send(ElmSimulator &simulator, const QByteArray &command, Totals &totals)
+{
+    const ElmSimulatorReply reply = simulator.respond(command);
+    totals.commands++;
+    totals.bytes += quint64(reply.bytes.size());
+    totals.simulatedMs += quint64(reply.latencyMs);
+
+    const QByteArray &body = reply.bytes;
+    if (body.contains("?")) {
+        totals.unknown++;
+    } else if (body.contains("NO DATA")) {
+        totals.noData++;
+    } else if (body.contains("ERROR") || body.contains("BUSY")) {
+        totals.errors++;
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("simulatorload");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulated WJ sessions per second through ElmSimulator.");
+    parser.addHelpOption();
+    QCommandLineOption sessionsOption("sessions", "Sessions to run.", "count", "20000");
+    QCommandLineOption threadsOption("threads", "Threads, each with its own simulators.", "count", "1");
+    QCommandLineOption roundsOption("rounds", "Polling rounds over all table commands per session.", "count", "3");
+    QCommandLineOption noDataOption("no-data", "Share of ECU requests answered with NO DATA.", "rate", "0");
+    QCommandLineOption busErrorOption("bus-errors", "Share of ECU requests answered with a bus error.", "rate", "0");
+    parser.addOptions({sessionsOption, threadsOption, roundsOption, noDataOption, busErrorOption});
+    parser.process(app);
+
+    const quint64 sessions = parser.value(sessionsOption).toULongLong();
+    const int threads = qMax(1, parser.value(threadsOption).toInt());
+    const int rounds = qMax(0, parser.value(roundsOption).toInt());
+    ElmSimulatorConfig config;
+    config.noDataRate = parser.value(noDataOption).toDouble();
+    config.busErrorRate = parser.value(busErrorOption).toDouble();
+
+    const Script script = buildScript();
+    std::atomic<quint64> nextSession{0};
+    std::vector<Totals> totals(size_t(threads));
+
+    auto worker = [&](Totals &out) {
+        for (quint64 session = nextSession++; session < sessions; session = nextSession++) {
+            ElmSimulatorConfig sessionConfig = config;
+            sessionConfig.seed = quint32(session + 1);
+            ElmSimulator simulator(sessionConfig);
+
+            for (const QByteArray &command : script.init) {
+                send(simulator, command, out);
+            }
+            for (int round = 0; round < rounds; ++round) {
+                for (const QByteArray &command : script.polling) {
+                    send(simulator, command, out);
+                }
+            }
+            out.sessions++;
+        }
+    };
+
+    QElapsedTimer clock;
+    clock.start();
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) {
+        pool.emplace_back(worker, std::ref(totals[size_t(i)]));
+    }
+    worker(totals[0]);
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+    const double seconds = qMax<qint64>(1, clock.nsecsElapsed()) / 1e9;
+
+    Totals sum;
+    for (const Totals &t : totals) {
+        sum.sessions += t.sessions;
+        sum.commands += t.commands;
+        sum.bytes += t.bytes;
+        sum.simulatedMs += t.simulatedMs;
+        sum.unknown += t.unknown;
+        sum.noData += t.noData;
+        sum.errors += t.errors;
+    }
+
+    QTextStream out(stdout);
+    out << QString("%1 sessions, %2 commands each, %3 thread(s) in %4 s\n")
+               .arg(sum.sessions).arg(sum.sessions ? sum.commands / sum.sessions : 0).arg(threads).arg(seconds, 0, 'f', 3);
+    out << QString("%1 sessions/s, %2 commands/s, %3 MB/s of replies\n")
+               .arg(sum.sessions / seconds, 0, 'f', 0).arg(sum.commands / seconds, 0, 'f', 0)
+               .arg(sum.bytes / seconds / 1e6, 0, 'f', 1);
+    out << QString("%1 h of simulated adapter time per wall second\n").arg(sum.simulatedMs / 3.6e6 / seconds, 0, 'f', 1);
+    out << QString("replies: %1 NO DATA, %2 bus errors, %3 unknown commands\n")
+               .arg(sum.noData).arg(sum.errors).arg(sum.unknown);
+
+    // Every command the app sends must be understood, or the sessions aren't the app's
+    return sum.unknown == 0 ? 0 : 1;
+}
@@ -0,0 +1,16 @@
+QT -= gui
+CONFIG += console c++17 release
+CONFIG -= app_bundle
+
+TARGET = simulatorload
+TEMPLATE = app
+
+# The simulator and the command sequences as the app builds them
+include(../../obdcore.pri)
+
+SOURCES += \
+    main.cpp
+
+linux:!android {
+    LIBS += -lpthread
+}
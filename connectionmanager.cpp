@@ -1,4 +1,6 @@
 #include "connectionmanager.h"
+#include <QEventLoop>
+#include <QTimer>
 
 ConnectionManager* ConnectionManager::theInstance_ = nullptr;
 
@@ -13,95 +15,142 @@ ConnectionManager *ConnectionManager::getInstance()
 
 ConnectionManager::ConnectionManager(QObject *parent) : QObject(parent)
 {
+    // All socket I/O happens on the transport thread
+    m_transportWorker = new TransportWorker();
+    m_transportWorker->moveToThread(&m_transportThread);
+    connect(&m_transportThread, &QThread::finished, m_transportWorker, &QObject::deleteLater);
+    connect(m_transportWorker, &TransportWorker::framesAvailable, this, &ConnectionManager::onFramesAvailable, Qt::QueuedConnection);
+
     // Initialize WiFi connection
-    mElmTcpSocket = new ElmTcpSocket(this);
+    mElmTcpSocket = m_transportWorker->tcpSocket();
     if(mElmTcpSocket)
     {
         connect(mElmTcpSocket, &ElmTcpSocket::tcpConnected, this, &ConnectionManager::conConnected);
         connect(mElmTcpSocket, &ElmTcpSocket::tcpDisconnected, this, &ConnectionManager::conDisconnected);
-        connect(mElmTcpSocket, &ElmTcpSocket::dataReceived, this, &ConnectionManager::conDataReceived);
         connect(mElmTcpSocket, &ElmTcpSocket::stateChanged, this, &ConnectionManager::conStateChanged);
     }
 
     // Initialize Bluetooth connection
-    mElmBluetoothManager = new ElmBluetoothManager(this);
+    mElmBluetoothManager = m_transportWorker->bluetoothManager();
     if(mElmBluetoothManager)
     {
         connect(mElmBluetoothManager, &ElmBluetoothManager::btConnected, this, &ConnectionManager::btConnected);
         connect(mElmBluetoothManager, &ElmBluetoothManager::btDisconnected, this, &ConnectionManager::btDisconnected);
-        connect(mElmBluetoothManager, &ElmBluetoothManager::dataReceived, this, &ConnectionManager::btDataReceived);
         connect(mElmBluetoothManager, &ElmBluetoothManager::stateChanged, this, &ConnectionManager::btStateChanged);
         connect(mElmBluetoothManager, &ElmBluetoothManager::deviceFound, this, &ConnectionManager::onBluetoothDeviceFound);
+        connect(mElmBluetoothManager, &ElmBluetoothManager::deviceInfoFound, this,
+                [this](const QBluetoothDeviceInfo &device) { m_bluetoothDevices.append(device); });
         connect(mElmBluetoothManager, &ElmBluetoothManager::deviceDiscoveryCompleted, this, &ConnectionManager::onBluetoothDiscoveryCompleted);
     }
+
+    // Replay: a capture stands in for the adapter
+    m_replayTransport = m_transportWorker->replayTransport();
+    if(m_replayTransport)
+    {
+        connect(m_replayTransport, &ReplayTransport::replayConnected, this, &ConnectionManager::conConnected);
+        connect(m_replayTransport, &ReplayTransport::replayDisconnected, this, &ConnectionManager::conDisconnected);
+        connect(m_replayTransport, &ReplayTransport::stateChanged, this, &ConnectionManager::conStateChanged);
+    }
+
+    // Simulator: an ELM327 and the WJ modules in process
+    m_simulatorTransport = m_transportWorker->simulatorTransport();
+    if(m_simulatorTransport)
+    {
+        connect(m_simulatorTransport, &SimulatorTransport::simulatorConnected, this, &ConnectionManager::conConnected);
+        connect(m_simulatorTransport, &SimulatorTransport::simulatorDisconnected, this, &ConnectionManager::conDisconnected);
+        connect(m_simulatorTransport, &SimulatorTransport::stateChanged, this, &ConnectionManager::conStateChanged);
+    }
+
+    m_transportThread.setObjectName("ElmTransport");
+    m_transportThread.start();
+}
+
+ConnectionManager::~ConnectionManager()
+{
+    // Closes the capture file on the transport thread before it stops
+    stopCapture();
+    m_transportThread.quit();
+    m_transportThread.wait();
 }
 
 bool ConnectionManager::send(const QString &command)
 {
-    switch(m_connectionType)
+    if(!m_connected)
     {
-    case Wifi:
-        if(mElmTcpSocket)
-        {
-            return mElmTcpSocket->send(command);
-        }
-        break;
+        return false;
+    }
 
-    case BlueTooth:
-        if(mElmBluetoothManager)
-        {
-            return mElmBluetoothManager->send(command);
-        }
-        break;
+    const QByteArray bytes = command.toLatin1();
+    return m_transportWorker->post(bytes);
+}
 
-    default:
-        break;
+// Pre-encoded command (see WJCommandTable): copied into the TX queue as is
+bool ConnectionManager::sendRaw(QByteArrayView bytes)
+{
+    if(!m_connected)
+    {
+        return false;
     }
 
-    return false;
+    return m_transportWorker->post(bytes);
 }
 
 QString ConnectionManager::readData(const QString &command)
 {
-    switch(m_connectionType)
+    // Blocking helper for legacy callers; waits in a local event loop, not on the socket
+    QStringList lines;
+    if(!send(command))
     {
-    case Wifi:
-        if(mElmTcpSocket)
-        {
-            return mElmTcpSocket->readData(command);
-        }
-        break;
+        return QString();
+    }
 
-    case BlueTooth:
-        if(mElmBluetoothManager)
-        {
-            return mElmBluetoothManager->readData(command);
-        }
-        break;
+    QEventLoop loop;
+    QTimer guard;
+    guard.setSingleShot(true);
+    connect(&guard, &QTimer::timeout, &loop, &QEventLoop::quit);
+    auto lineConnection = connect(this, &ConnectionManager::lineReceived, &loop,
+                                  [&lines](QByteArrayView line) { lines.append(QString::fromLatin1(line)); });
+    auto promptConnection = connect(this, &ConnectionManager::promptReceived, &loop, &QEventLoop::quit);
 
-    default:
-        break;
-    }
+    guard.start(3000);
+    loop.exec();
 
-    return QString();
+    disconnect(lineConnection);
+    disconnect(promptConnection);
+    return lines.join('\r');
 }
 
 void ConnectionManager::disConnectElm()
 {
+    ElmTcpSocket *tcpSocket = mElmTcpSocket;
+    ElmBluetoothManager *bluetoothManager = mElmBluetoothManager;
+
     switch(m_connectionType)
     {
     case Wifi:
-        if(mElmTcpSocket && mElmTcpSocket->isConnected())
-        {
-            mElmTcpSocket->disconnectTcp();
-        }
+        QMetaObject::invokeMethod(m_transportWorker, [tcpSocket]() {
+            if(tcpSocket->isConnected())
+            {
+                tcpSocket->disconnectTcp();
+            }
+        }, Qt::QueuedConnection);
         break;
 
     case BlueTooth:
-        if(mElmBluetoothManager && mElmBluetoothManager->isConnected())
-        {
-            mElmBluetoothManager->disconnectBluetooth();
-        }
+        QMetaObject::invokeMethod(m_transportWorker, [bluetoothManager]() {
+            if(bluetoothManager->isConnected())
+            {
+                bluetoothManager->disconnectBluetooth();
+            }
+        }, Qt::QueuedConnection);
+        break;
+
+    case Replay:
+        QMetaObject::invokeMethod(m_replayTransport, &ReplayTransport::close, Qt::QueuedConnection);
+        break;
+
+    case Simulator:
+        QMetaObject::invokeMethod(m_simulatorTransport, &SimulatorTransport::close, Qt::QueuedConnection);
         break;
 
     default:
@@ -120,7 +169,11 @@ void ConnectionManager::connectElm(const QString &bluetoothAddress)
         {
             QString ip = m_settingsManager->getWifiIp();
             quint16 port = m_settingsManager->getWifiPort();
-            mElmTcpSocket->connectTcp(ip, port);
+            m_endpoint = QString("wifi:%1:%2").arg(ip).arg(port);
+            ElmTcpSocket *tcpSocket = mElmTcpSocket;
+            QMetaObject::invokeMethod(m_transportWorker, [tcpSocket, ip, port]() {
+                tcpSocket->connectTcp(ip, port);
+            }, Qt::QueuedConnection);
         }
         break;
 
@@ -136,6 +189,32 @@ void ConnectionManager::connectElm(const QString &bluetoothAddress)
         }
         break;
 
+    case Replay:
+        if(m_replayTransport && !m_replayTrace.isEmpty())
+        {
+            m_endpoint = "replay:" + m_replayTrace;
+            ReplayTransport *replayTransport = m_replayTransport;
+            const QString path = m_replayTrace;
+            const bool realTime = m_replayRealTime;
+            QMetaObject::invokeMethod(m_transportWorker, [replayTransport, path, realTime]() {
+                replayTransport->open(path, realTime);
+            }, Qt::QueuedConnection);
+        }
+        break;
+
+    case Simulator:
+        if(m_simulatorTransport && m_simulatorEnabled)
+        {
+            m_endpoint = QString("sim:%1").arg(m_simulatorConfig.seed);
+            SimulatorTransport *simulatorTransport = m_simulatorTransport;
+            const ElmSimulatorConfig config = m_simulatorConfig;
+            const bool realTime = m_simulatorRealTime;
+            QMetaObject::invokeMethod(m_transportWorker, [simulatorTransport, config, realTime]() {
+                simulatorTransport->open(config, realTime);
+            }, Qt::QueuedConnection);
+        }
+        break;
+
     default:
         break;
     }
@@ -145,7 +224,11 @@ void ConnectionManager::connectBluetooth(const QString &deviceAddress)
 {
     if(mElmBluetoothManager)
     {
-        mElmBluetoothManager->connectBluetooth(deviceAddress);
+        m_endpoint = "bt:" + deviceAddress;
+        ElmBluetoothManager *bluetoothManager = mElmBluetoothManager;
+        QMetaObject::invokeMethod(m_transportWorker, [bluetoothManager, deviceAddress]() {
+            bluetoothManager->connectBluetooth(deviceAddress);
+        }, Qt::QueuedConnection);
     }
 }
 
@@ -153,7 +236,8 @@ void ConnectionManager::startBluetoothDiscovery()
 {
     if(mElmBluetoothManager)
     {
-        mElmBluetoothManager->startDeviceDiscovery();
+        m_bluetoothDevices.clear();
+        QMetaObject::invokeMethod(mElmBluetoothManager, &ElmBluetoothManager::startDeviceDiscovery, Qt::QueuedConnection);
     }
 }
 
@@ -161,52 +245,93 @@ void ConnectionManager::stopBluetoothDiscovery()
 {
     if(mElmBluetoothManager)
     {
-        mElmBluetoothManager->stopDeviceDiscovery();
+        QMetaObject::invokeMethod(mElmBluetoothManager, &ElmBluetoothManager::stopDeviceDiscovery, Qt::QueuedConnection);
     }
 }
 
 QList<QBluetoothDeviceInfo> ConnectionManager::getBluetoothDevices() const
 {
-    if(mElmBluetoothManager)
-    {
-        return mElmBluetoothManager->getDiscoveredDevices();
-    }
-    return QList<QBluetoothDeviceInfo>();
+    // Mirrored from the transport thread as devices are found
+    return m_bluetoothDevices;
 }
 
 void ConnectionManager::setConnectionType(ConnectionType type)
 {
     m_connectionType = type;
+
+    TransportWorker *worker = m_transportWorker;
+    QMetaObject::invokeMethod(m_transportWorker, [worker, type]() {
+        worker->setConnectionType(type);
+    }, Qt::QueuedConnection);
 }
 
 bool ConnectionManager::isConnected() const
 {
-    switch(m_connectionType)
-    {
-    case Wifi:
-        if(mElmTcpSocket)
-        {
-            return mElmTcpSocket->isConnected();
-        }
-        break;
+    // Tracked from the transport signals, the sockets belong to another thread
+    return m_connected;
+}
 
-    case BlueTooth:
-        if(mElmBluetoothManager)
+ConnectionType ConnectionManager::getCType() const
+{
+    return m_connectionType;
+}
+
+QString ConnectionManager::endpoint() const
+{
+    return m_endpoint;
+}
+
+void ConnectionManager::startCapture(const QString &path)
+{
+    TransportWorker *worker = m_transportWorker;
+    QMetaObject::invokeMethod(m_transportWorker, [this, worker, path]() {
+        if(!worker->startCapture(path))
         {
-            return mElmBluetoothManager->isConnected();
+            emit stateChanged("Cannot create capture " + path);
         }
-        break;
+    }, Qt::QueuedConnection);
+    m_capturing = true;
+}
 
-    default:
-        break;
+void ConnectionManager::stopCapture()
+{
+    if(!m_capturing)
+    {
+        return;
     }
 
-    return false;
+    TransportWorker *worker = m_transportWorker;
+    QMetaObject::invokeMethod(m_transportWorker, [worker]() { worker->stopCapture(); },
+                              m_transportThread.isRunning() ? Qt::BlockingQueuedConnection : Qt::DirectConnection);
+    m_capturing = false;
 }
 
-ConnectionType ConnectionManager::getCType() const
+bool ConnectionManager::isCapturing() const
 {
-    return m_connectionType;
+    return m_capturing;
+}
+
+void ConnectionManager::setReplayTrace(const QString &path, bool realTime)
+{
+    m_replayTrace = path;
+    m_replayRealTime = realTime;
+}
+
+QString ConnectionManager::replayTrace() const
+{
+    return m_replayTrace;
+}
+
+void ConnectionManager::setSimulator(const ElmSimulatorConfig &config, bool realTime)
+{
+    m_simulatorConfig = config;
+    m_simulatorEnabled = true;
+    m_simulatorRealTime = realTime;
+}
+
+bool ConnectionManager::hasSimulator() const
+{
+    return m_simulatorEnabled;
 }
 
 void ConnectionManager::conConnected()
@@ -221,11 +346,6 @@ void ConnectionManager::conDisconnected()
     emit disconnected();
 }
 
-void ConnectionManager::conDataReceived(QString data)
-{
-    emit dataReceived(data);
-}
-
 void ConnectionManager::conStateChanged(QString state)
 {
     emit stateChanged(state);
@@ -243,11 +363,6 @@ void ConnectionManager::btDisconnected()
     emit disconnected();
 }
 
-void ConnectionManager::btDataReceived(QString data)
-{
-    emit dataReceived(data);
-}
-
 void ConnectionManager::btStateChanged(QString state)
 {
     emit stateChanged(state);
@@ -262,3 +377,18 @@ void ConnectionManager::onBluetoothDiscoveryCompleted()
 {
     emit bluetoothDiscoveryCompleted();
 }
+
+void ConnectionManager::onFramesAvailable()
+{
+    m_transportWorker->consumeFrames([this](const ElmFrame &frame) {
+        // A cut line is as incomplete as a dropped one
+        if (frame.afterLoss || frame.truncated) {
+            emit framesLost();
+        }
+        if (frame.kind == ElmFrame::Prompt) {
+            emit promptReceived();
+        } else {
+            emit lineReceived(frame.view());
+        }
+    });
+}
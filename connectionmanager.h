@@ -2,25 +2,41 @@
 #define CONNECTIONMANAGER_H
 
 #include <QObject>
-#include "elmtcpsocket.h"
-#include "elmbluetoothmanager.h"
+#include <QByteArrayView>
+#include <QThread>
+#include "transportworker.h"
 #include "settingsmanager.h"
 
-enum ConnectionType {BlueTooth, Wifi, Serial, None};
-
 class ConnectionManager : public QObject
 {
     Q_OBJECT
 public:
     explicit ConnectionManager(QObject *parent = nullptr);
+    ~ConnectionManager();
     static ConnectionManager* getInstance();
     void connectElm(const QString &bluetoothAddress = QString());
     void disConnectElm();
     bool send(const QString &);
+    bool sendRaw(QByteArrayView bytes);
     QString readData(const QString &command);
     ConnectionType getCType() const;
+    // Adapter the last connect went to ("wifi:192.168.0.10:35000", "bt:00:1D:A5:68:98:8B")
+    QString endpoint() const;
     bool isConnected() const;
 
+    // Raw adapter traffic to a TrafficCapture file, until stopCapture()
+    void startCapture(const QString &path);
+    void stopCapture();
+    bool isCapturing() const;
+
+    // Capture that connectElm() plays back when the connection type is Replay
+    void setReplayTrace(const QString &path, bool realTime);
+    QString replayTrace() const;
+
+    // Built-in adapter simulator that connectElm() uses when the connection type is Simulator
+    void setSimulator(const ElmSimulatorConfig &config, bool realTime);
+    bool hasSimulator() const;
+
     // Bluetooth specific methods
     void startBluetoothDiscovery();
     void stopBluetoothDiscovery();
@@ -30,13 +46,29 @@ public:
 
 private:
     SettingsManager *m_settingsManager{};
+    QThread m_transportThread;
+    TransportWorker *m_transportWorker{};
     ElmTcpSocket *mElmTcpSocket{};
     ElmBluetoothManager *mElmBluetoothManager{};
+    ReplayTransport *m_replayTransport{};
+    SimulatorTransport *m_simulatorTransport{};
+    QList<QBluetoothDeviceInfo> m_bluetoothDevices;
     ConnectionType m_connectionType{Wifi}; // Default to WiFi
+    QString m_endpoint;
     bool m_connected{false};
+    bool m_capturing{false};
+    QString m_replayTrace;
+    bool m_replayRealTime{true};
+    ElmSimulatorConfig m_simulatorConfig;
+    bool m_simulatorEnabled{false};
+    bool m_simulatorRealTime{true};
 
 signals:
-    void dataReceived(QString);
+    void lineReceived(QByteArrayView line);
+    void promptReceived();
+    // Received lines were dropped (receive queue full) just before the next line or prompt,
+    // or the next line is cut short
+    void framesLost();
     void stateChanged(QString);
     void connected();
     void disconnected();
@@ -47,17 +79,18 @@ public slots:
     // WiFi connection slots
     void conConnected();
     void conDisconnected();
-    void conDataReceived(QString);
     void conStateChanged(QString);
 
     // Bluetooth connection slots
     void btConnected();
     void btDisconnected();
-    void btDataReceived(QString);
     void btStateChanged(QString);
     void onBluetoothDeviceFound(const QString &name, const QString &address);
     void onBluetoothDiscoveryCompleted();
 
+private slots:
+    void onFramesAvailable();
+
 private:
     static ConnectionManager* theInstance_;
 };
@@ -1,14 +1,27 @@
 #ifndef ELM_H
 #define ELM_H
 #include <QtCore>
+#include <bitset>
+#include "elmresponse.h"
 
 class ELM
 {
 public:
     ELM();
     static ELM* getInstance();
-    QString get_available_pids();
+    // Data PIDs (mode 01) the ECU reports as supported, once pidsChecked()
+    std::bitset<256> supportedPids();
+    // Raw support bitmaps, for the capability cache; restorePids() stands in for a discovery
+    bool pidsChecked() const;
+    std::bitset<256> availablePids() const;
+    void restorePids(const std::bitset<256> &pids);
     void resetPids();
+    // Discovery runs on ElmInterface (WJInitSession): each "41 00/20/40 ..." message is loaded
+    // here as it arrives; returns a bit per bitmap loaded (bit n = PID n * 0x20)
+    quint8 loadSupportBitmaps(const quint8 *bytes, int size);
+    // The last bitmap is in (or no more came); with none at all the common PIDs are assumed
+    void finishPidDiscovery(bool anyLoaded);
+    static const int PID_QUERY_ATTEMPTS = 3;
     std::vector<QString> decodeDTC(const std::vector<QString> &hex_vals);
     std::pair<int,bool> decodeNumberOfDtc(const std::vector<QString> &hex_vals);
     std::vector<QString> prepareResponseToDecode(const QString &response_str);
@@ -18,16 +31,14 @@ public:
 
 private:
     QString m_lastHeader;
-    bool available_pids[256];
+    ElmResponseParser m_responseParser;
+    std::bitset<256> available_pids;
     bool available_pids_checked = false;
-    void update_available_pids();
-    void update_available_pidset(quint8 set);
     std::map<char,QString> dtcPrefix={{'0',QString("P0")},{'1',QString("P1")},{'2',QString("P2")},{'3',QString("P3")},
                                       {'4',QString("C0")},{'5',QString("C1")},{'6',QString("C2")},{'7',QString("C3")},
                                       {'8',QString("B0")},{'9',QString("B1")},{'A',QString("B2")},{'B',QString("B3")},
                                       {'C',QString("U0")},{'D',QString("U1")},{'E',QString("U2")},{'F',QString("U3")}
                                      };
-    QString cleanData(const QString& input);
     static ELM* theInstance_;
 
 };
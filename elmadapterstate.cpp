@@ -0,0 +1,216 @@
+#include "elmadapterstate.h"
+
+static bool sameState(const ElmAdapterState &a, const ElmAdapterState &b)
+{
+    return a.protocol == b.protocol && a.header == b.header && a.wakeupMessage == b.wakeupMessage &&
+           a.timeout == b.timeout && a.echo == b.echo && a.linefeeds == b.linefeeds &&
+           a.spaces == b.spaces && a.headers == b.headers;
+}
+
+static bool isResetCommand(const QString &compact)
+{
+    return compact == "ATZ" || compact == "ATWS" || compact == "ATD";
+}
+
+// ATE0 / ATL1 / ... -> the field it controls, or nullptr
+static ElmSwitch *switchField(ElmAdapterState &state, const QString &compact)
+{
+    if (compact.size() != 4 || (compact[3] != '0' && compact[3] != '1')) {
+        return nullptr;
+    }
+
+    switch (compact[2].toLatin1()) {
+    case 'E': return &state.echo;
+    case 'L': return &state.linefeeds;
+    case 'S': return &state.spaces;
+    case 'H': return &state.headers;
+    default: return nullptr;
+    }
+}
+
+ElmAdapterState ElmAdapterState::forModule(WJModule module)
+{
+    ElmAdapterState target;
+    WJModuleConfig config = WJCommands::getModuleConfig(module);
+    if (config.protocol == PROTOCOL_UNKNOWN) {
+        return target;
+    }
+
+    target.protocol = config.protocol;
+    target.header = normalize(config.ecuHeader);
+    target.wakeupMessage = normalize(config.wakeupMessage);
+    target.echo = SWITCH_OFF;
+
+    // Same header setting the protocol switch sequences use
+    target.headers = (config.protocol == PROTOCOL_J1850_VPW) ? SWITCH_ON : SWITCH_OFF;
+    return target;
+}
+
+QString ElmAdapterState::normalize(const QString &command)
+{
+    QString compact = command.trimmed().toUpper();
+    compact.remove(' ');
+    return compact;
+}
+
+bool ElmAdapterState::isAtCommand(const QString &command)
+{
+    return normalize(command).startsWith("AT");
+}
+
+bool ElmAdapterState::apply(const QString &command)
+{
+    const QString compact = normalize(command);
+    if (!compact.startsWith("AT")) {
+        return false;
+    }
+
+    if (isResetCommand(compact)) {
+        resetToDefaults();
+        return true;
+    }
+
+    if (ElmSwitch *field = switchField(*this, compact)) {
+        *field = (compact[3] == '1') ? SWITCH_ON : SWITCH_OFF;
+        return true;
+    }
+
+    if (compact.startsWith("ATSP") || compact.startsWith("ATTP")) {
+        const QString argument = compact.mid(4);
+        if (argument.isEmpty()) {
+            return false;
+        }
+        // "A5" means try 5, then search: we cannot tell where it ends up
+        protocol = argument.startsWith('A') ? PROTOCOL_AUTO_DETECT : protocolFromNumber(argument.back());
+        return true;
+    }
+
+    if (compact.startsWith("ATSH")) {
+        header = compact.mid(4);
+        return true;
+    }
+    if (compact.startsWith("ATWM")) {
+        wakeupMessage = compact.mid(4);
+        return true;
+    }
+    if (compact.startsWith("ATST")) {
+        timeout = compact.mid(4);
+        return true;
+    }
+
+    return false;
+}
+
+void ElmAdapterState::forget(const QString &command)
+{
+    const QString compact = normalize(command);
+    if (!compact.startsWith("AT")) {
+        return;
+    }
+
+    if (isResetCommand(compact)) {
+        invalidate();
+    } else if (ElmSwitch *field = switchField(*this, compact)) {
+        *field = SWITCH_UNKNOWN;
+    } else if (compact.startsWith("ATSP") || compact.startsWith("ATTP")) {
+        protocol = PROTOCOL_UNKNOWN;
+    } else if (compact.startsWith("ATSH")) {
+        header.clear();
+    } else if (compact.startsWith("ATWM")) {
+        wakeupMessage.clear();
+    } else if (compact.startsWith("ATST")) {
+        timeout.clear();
+    }
+}
+
+bool ElmAdapterState::isRedundant(const QString &command) const
+{
+    if (isResetCommand(normalize(command))) {
+        return false;
+    }
+
+    ElmAdapterState next = *this;
+    if (!next.apply(command)) {
+        return false;
+    }
+
+    // Applying a known value again leaves everything as it was
+    return sameState(next, *this);
+}
+
+QStringList ElmAdapterState::commandsToReach(const ElmAdapterState &target) const
+{
+    QStringList commands;
+
+    // Protocol first: the other settings survive ATTP, but a header is protocol specific.
+    // ATTP rather than ATSP, so the protocol stored in the adapter is never rewritten.
+    if (target.protocol != PROTOCOL_UNKNOWN && target.protocol != protocol) {
+        commands.append("ATTP" + protocolNumber(target.protocol));
+    }
+
+    auto appendSwitch = [&commands](const char *prefix, ElmSwitch current, ElmSwitch wanted) {
+        if (wanted != SWITCH_UNKNOWN && wanted != current) {
+            commands.append(QString(prefix) + (wanted == SWITCH_ON ? "1" : "0"));
+        }
+    };
+    appendSwitch("ATE", echo, target.echo);
+    appendSwitch("ATL", linefeeds, target.linefeeds);
+    appendSwitch("ATS", spaces, target.spaces);
+    appendSwitch("ATH", headers, target.headers);
+
+    if (!target.timeout.isEmpty() && target.timeout != timeout) {
+        commands.append("ATST" + target.timeout);
+    }
+    if (!target.wakeupMessage.isEmpty() && target.wakeupMessage != wakeupMessage) {
+        commands.append("ATWM" + target.wakeupMessage);
+    }
+    if (!target.header.isEmpty() && target.header != header) {
+        commands.append("ATSH" + target.header);
+    }
+
+    return commands;
+}
+
+void ElmAdapterState::resetToDefaults()
+{
+    // ELM327 power-up defaults; protocol, header and wakeup depend on stored settings
+    protocol = PROTOCOL_UNKNOWN;
+    header.clear();
+    wakeupMessage.clear();
+    timeout = "32";
+    echo = SWITCH_ON;
+    linefeeds = SWITCH_ON;
+    spaces = SWITCH_ON;
+    headers = SWITCH_OFF;
+}
+
+void ElmAdapterState::invalidate()
+{
+    *this = ElmAdapterState();
+}
+
+QString ElmAdapterState::protocolNumber(WJProtocol protocol)
+{
+    switch (protocol) {
+    case PROTOCOL_ISO_14230_4_KWP_FAST:
+        return WJ::Protocols::ISO_14230_4_KWP_FAST;
+    case PROTOCOL_J1850_VPW:
+        return WJ::Protocols::J1850_VPW;
+    default:
+        return "0";
+    }
+}
+
+WJProtocol ElmAdapterState::protocolFromNumber(QChar number)
+{
+    if (number == WJ::Protocols::ISO_14230_4_KWP_FAST.at(0)) {
+        return PROTOCOL_ISO_14230_4_KWP_FAST;
+    }
+    if (number == WJ::Protocols::J1850_VPW.at(0)) {
+        return PROTOCOL_J1850_VPW;
+    }
+    if (number == '0') {
+        return PROTOCOL_AUTO_DETECT;
+    }
+    return PROTOCOL_UNKNOWN;
+}
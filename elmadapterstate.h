@@ -0,0 +1,50 @@
+#ifndef ELMADAPTERSTATE_H
+#define ELMADAPTERSTATE_H
+
+#include <QString>
+#include <QStringList>
+#include "global.h"
+
+enum ElmSwitch : qint8 {
+    SWITCH_UNKNOWN = -1,
+    SWITCH_OFF = 0,
+    SWITCH_ON = 1
+};
+
+// Live ELM327 settings as far as we know them from the AT commands we sent.
+// Unknown fields are empty / SWITCH_UNKNOWN; in a target state they mean "don't care".
+class ElmAdapterState
+{
+public:
+    WJProtocol protocol{PROTOCOL_UNKNOWN};
+    QString header;         // ATSH, compact upper-case hex
+    QString wakeupMessage;  // ATWM
+    QString timeout;        // ATST, hex in 4 ms units
+    ElmSwitch echo{SWITCH_UNKNOWN};
+    ElmSwitch linefeeds{SWITCH_UNKNOWN};
+    ElmSwitch spaces{SWITCH_UNKNOWN};
+    ElmSwitch headers{SWITCH_UNKNOWN};
+
+    // State each module needs before its requests can go out
+    static ElmAdapterState forModule(WJModule module);
+    static QString normalize(const QString &command);
+    static bool isAtCommand(const QString &command);
+
+    // Fold a command that is being sent into the state; returns false for non-setting commands
+    bool apply(const QString &command);
+    // The command was rejected or never answered: whatever it set is unknown now
+    void forget(const QString &command);
+    // True when sending the command would not change anything
+    bool isRedundant(const QString &command) const;
+
+    // Minimal AT commands that turn this state into target
+    QStringList commandsToReach(const ElmAdapterState &target) const;
+
+    void resetToDefaults();
+    void invalidate();
+
+    static QString protocolNumber(WJProtocol protocol);
+    static WJProtocol protocolFromNumber(QChar number);
+};
+
+#endif // ELMADAPTERSTATE_H
@@ -1,5 +1,4 @@
 #include "elmbluetoothmanager.h"
-#include <QCoreApplication>
 #include <QDebug>
 
 ElmBluetoothManager::ElmBluetoothManager(QObject *parent) : QObject(parent)
@@ -17,9 +16,10 @@ ElmBluetoothManager::ElmBluetoothManager(QObject *parent) : QObject(parent)
             this, &ElmBluetoothManager::deviceDiscoveryFinished);
     connect(m_discoveryAgent, &QBluetoothDeviceDiscoveryAgent::errorOccurred,
             this, &ElmBluetoothManager::deviceDiscoveryError);
-    // Setup read timer
-    m_readTimer.setSingleShot(true);
-    connect(&m_readTimer, &QTimer::timeout, this, &ElmBluetoothManager::readTimerTimeout);
+
+    // Shared byte-level framer, same as the TCP transport
+    m_framer.setLineHandler([this](QByteArrayView line) { emit lineReceived(line); });
+    m_framer.setPromptHandler([this]() { emit promptReceived(); });
 }
 
 ElmBluetoothManager::~ElmBluetoothManager()
@@ -98,6 +98,7 @@ void ElmBluetoothManager::deviceDiscovered(const QBluetoothDeviceInfo &device)
 
             // Emit signal with device information
             emit deviceFound(deviceName, device.address().toString());
+            emit deviceInfoFound(device);
 
             // Log device discovery
             if (isObdDevice) {
@@ -172,6 +173,7 @@ bool ElmBluetoothManager::connectBluetooth(const QString &deviceAddress)
     // Convert string address to QBluetoothAddress
     QBluetoothAddress address(deviceAddress);
 
+    m_framer.reset();
     m_socket->connectToService(address, uuid);
 
     return true;
@@ -192,57 +194,18 @@ void ElmBluetoothManager::disconnectBluetooth()
     m_connected = false;
 }
 
-bool ElmBluetoothManager::send(const QString &command)
+bool ElmBluetoothManager::write(QByteArrayView data)
 {
     if (!m_socket || !m_socket->isOpen()) {
         return false;
     }
 
-    // Add carriage return to the command
-    QString cmdWithCR = command + "\r";
-    QByteArray data = cmdWithCR.toUtf8();
-
-    qint64 bytesWritten = m_socket->write(data);
+    // Commands arrive CR-terminated from the transport worker
+    qint64 bytesWritten = m_socket->write(data.data(), data.size());
 
     return (bytesWritten == data.size());
 }
 
-QString ElmBluetoothManager::readData(const QString &command)
-{
-    if (!m_socket || !m_socket->isOpen()) {
-        return QString();
-    }
-
-    // Clear any existing data
-    m_socket->readAll();
-
-    // Send the command
-    if (!send(command)) {
-        return QString();
-    }
-
-    // Wait for response with timeout
-    QByteArray response;
-    m_readTimer.start(m_readTimeout);
-
-    // Read loop
-    while (m_readTimer.isActive()) {
-        if (m_socket->waitForReadyRead(100)) {
-            response += m_socket->readAll();
-
-            // Check if response is complete (ends with prompt character '>')
-            if (response.contains('>')) {
-                m_readTimer.stop();
-                break;
-            }
-        }
-
-        QCoreApplication::processEvents();
-    }
-
-    return QString::fromUtf8(response);
-}
-
 bool ElmBluetoothManager::isConnected() const
 {
     return m_connected;
@@ -285,15 +248,12 @@ void ElmBluetoothManager::readyRead()
         return;
     }
 
-    QByteArray data = m_socket->readAll();
-    QString strData = QString::fromUtf8(data);
-
-    if (!strData.isEmpty()) {
-        emit dataReceived(strData);
-    }
-}
-
-void ElmBluetoothManager::readTimerTimeout()
-{
-    emit stateChanged("Read operation timed out");
+    qint64 bytesRead = 0;
+    do {
+        bytesRead = m_socket->read(m_framer.writePointer(), m_framer.writableSize());
+        if (bytesRead > 0) {
+            emit bytesReceived(QByteArrayView(m_framer.writePointer(), bytesRead));
+            m_framer.commit(bytesRead);
+        }
+    } while (bytesRead > 0);
 }
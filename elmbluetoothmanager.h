@@ -7,7 +7,7 @@
 #include <QBluetoothSocket>
 #include <QBluetoothDeviceInfo>
 #include <QList>
-#include <QTimer>
+#include "elmframer.h"
 
 class ElmBluetoothManager : public QObject
 {
@@ -18,8 +18,7 @@ public:
 
     bool connectBluetooth(const QString &deviceAddress);
     void disconnectBluetooth();
-    bool send(const QString &command);
-    QString readData(const QString &command);
+    bool write(QByteArrayView data);
     bool isConnected() const;
 
     void startDeviceDiscovery();
@@ -32,8 +31,7 @@ private:
     QBluetoothSocket *m_socket{nullptr};
     QList<QBluetoothDeviceInfo> m_discoveredDevices;
     bool m_connected{false};
-    QTimer m_readTimer;
-    int m_readTimeout{3000}; // 3 seconds timeout
+    ElmFramer m_framer;
 
 private slots:
     void deviceDiscovered(const QBluetoothDeviceInfo &device);
@@ -44,14 +42,17 @@ private slots:
     void socketError(QBluetoothSocket::SocketError error);
     void socketStateChanged(QBluetoothSocket::SocketState state);
     void readyRead();
-    void readTimerTimeout();
 
 signals:
     void deviceDiscoveryCompleted();
     void deviceFound(const QString &name, const QString &address);
+    void deviceInfoFound(const QBluetoothDeviceInfo &device);
     void btConnected();
     void btDisconnected();
-    void dataReceived(QString data);
+    void lineReceived(QByteArrayView line);
+    void promptReceived();
+    // Raw chunk as read, before framing (traffic capture)
+    void bytesReceived(QByteArrayView chunk);
     void stateChanged(QString state);
 };
 
@@ -0,0 +1,300 @@
+#include "elmerror.h"
+#include <QQueue>
+
+namespace {
+
+struct Signature {
+    const char *text;
+    ElmErrorKind kind;
+};
+
+// The texts WJ::ALL_ERROR_CODES, KWP2000_ERROR_CODES and J1850_ERROR_CODES list; keep them in step.
+// Their "7F xx" entries are covered by negativeResponse(), which reads the bytes instead.
+const Signature SIGNATURES[] = {
+    {"SEARCH", ELM_ERROR_SEARCHING},
+    {"SEARCHING", ELM_ERROR_SEARCHING},
+    {"ERROR", ELM_ERROR_GENERIC},
+    {"STOPPED", ELM_ERROR_STOPPED},
+    {"BUFFER FULL", ELM_ERROR_BUFFER_FULL},
+    {"OVERFLOW", ELM_ERROR_BUFFER_FULL},
+    {"DATA ERROR", ELM_ERROR_DATA},
+    {"CHECKSUM ERROR", ELM_ERROR_DATA},
+    {"FRAMING ERROR", ELM_ERROR_DATA},
+    {"PARITY ERROR", ELM_ERROR_DATA},
+    {"BUS ERROR", ELM_ERROR_BUS},
+    {"CAN ERROR", ELM_ERROR_BUS},
+    {"PROTOCOL ERROR", ELM_ERROR_BUS},
+    {"BUS BUSY", ELM_ERROR_BUS_BUSY},
+    {"TIMEOUT", ELM_ERROR_TIMEOUT},
+    {"NO RESPONSE", ELM_ERROR_TIMEOUT},
+    {"NO DATA", ELM_ERROR_NO_DATA},
+    {"NODATA", ELM_ERROR_NO_DATA},
+    {"UNABLE TO CONNECT", ELM_ERROR_UNABLE_TO_CONNECT},
+    {"UNABLETOCONNECT", ELM_ERROR_UNABLE_TO_CONNECT},
+    {"BUS INIT: ERROR", ELM_ERROR_BUS_INIT},
+    {"BUS INIT: ...ERROR", ELM_ERROR_BUS_INIT},   // as the ELM327 prints it; "ERROR" alone already flags it
+    {"NEGATIVE RESPONSE", ELM_ERROR_NEGATIVE_RESPONSE},
+};
+const int SIGNATURE_COUNT = int(sizeof(SIGNATURES) / sizeof(SIGNATURES[0]));
+
+// Signature index that wins when both match; -1 means none
+int better(int candidate, int current)
+{
+    if (current < 0) {
+        return candidate;
+    }
+    if (candidate < 0) {
+        return current;
+    }
+    return SIGNATURES[candidate].kind > SIGNATURES[current].kind ? candidate : current;
+}
+
+int hexValue(QChar c)
+{
+    const char16_t u = c.unicode();
+    if (u >= '0' && u <= '9') {
+        return u - '0';
+    }
+    if (u >= 'A' && u <= 'F') {
+        return u - 'A' + 10;
+    }
+    if (u >= 'a' && u <= 'f') {
+        return u - 'a' + 10;
+    }
+    return -1;
+}
+
+// Two hex digits at pos, -1 if there are none
+int hexByteAt(QStringView text, qsizetype pos)
+{
+    if (pos < 0 || pos + 1 >= text.size()) {
+        return -1;
+    }
+    const int high = hexValue(text[pos]);
+    const int low = hexValue(text[pos + 1]);
+    return (high >= 0 && low >= 0) ? (high << 4 | low) : -1;
+}
+
+// Up to capacity leading bytes of one line, spaced or not. Words that aren't hex before the
+// first byte ("SEARCHING...") are skipped, a 3-digit CAN id is left out and flagged.
+int leadingBytes(QStringView line, int *bytes, int capacity, bool &canId)
+{
+    canId = false;
+    int count = 0;
+    qsizetype pos = 0;
+    while (pos < line.size() && count < capacity) {
+        while (pos < line.size() && line[pos].isSpace()) {
+            ++pos;
+        }
+        qsizetype end = pos;
+        while (end < line.size() && !line[end].isSpace()) {
+            ++end;
+        }
+        const QStringView word = line.sliced(pos, end - pos);
+        pos = end;
+        if (word.isEmpty()) {
+            break;
+        }
+
+        bool isHex = true;
+        for (QChar c : word) {
+            isHex = isHex && hexValue(c) >= 0;
+        }
+        if (!isHex) {
+            if (count > 0 || canId) {
+                break;
+            }
+            continue;
+        }
+
+        qsizetype digit = 0;
+        if (count == 0 && !canId && (word.size() & 1) && word.size() >= 3) {
+            canId = true;
+            digit = 3;
+        } else if (word.size() & 1) {
+            break;
+        }
+        for (; digit + 1 < word.size() && count < capacity; digit += 2) {
+            bytes[count++] = hexByteAt(word, digit);
+        }
+    }
+    return count;
+}
+
+// Where 7F <service> <NRC> starts in a line's bytes, -1 if it isn't a negative response.
+// Headers: CAN id and PCI byte, a KWP2000 format byte with addresses, or a J1850 header to the tester.
+int negativeResponseIndex(const int *bytes, int count, bool canId)
+{
+    int index = 0;
+    if (canId) {
+        index = 1;
+    } else if (count >= 4 && bytes[0] != 0x7F && ((bytes[0] & 0xC0) == 0x80 || bytes[1] == 0x6B)) {
+        index = 3;
+    }
+    return (index < count && bytes[index] == 0x7F) ? index : -1;
+}
+
+} // namespace
+
+bool ElmError::isRetryable() const
+{
+    switch (kind) {
+    case ELM_ERROR_STOPPED:
+    case ELM_ERROR_BUFFER_FULL:
+    case ELM_ERROR_DATA:
+    case ELM_ERROR_BUS_BUSY:
+        return true;
+    case ELM_ERROR_NEGATIVE_RESPONSE:
+        return nrc == NRC_BUSY_REPEAT_REQUEST;
+    default:
+        return false;
+    }
+}
+
+const char *ElmError::name() const
+{
+    switch (kind) {
+    case ELM_ERROR_NONE: return "OK";
+    case ELM_ERROR_SEARCHING: return "SEARCHING";
+    case ELM_ERROR_GENERIC: return "ERROR";
+    case ELM_ERROR_STOPPED: return "STOPPED";
+    case ELM_ERROR_BUFFER_FULL: return "BUFFER FULL";
+    case ELM_ERROR_DATA: return "DATA ERROR";
+    case ELM_ERROR_BUS: return "BUS ERROR";
+    case ELM_ERROR_BUS_BUSY: return "BUS BUSY";
+    case ELM_ERROR_TIMEOUT: return "TIMEOUT";
+    case ELM_ERROR_NO_DATA: return "NO DATA";
+    case ELM_ERROR_UNABLE_TO_CONNECT: return "UNABLE TO CONNECT";
+    case ELM_ERROR_BUS_INIT: return "BUS INIT ERROR";
+    case ELM_ERROR_NEGATIVE_RESPONSE: return "NEGATIVE RESPONSE";
+    }
+    return "UNKNOWN";
+}
+
+const ElmErrorMatcher &ElmErrorMatcher::getInstance()
+{
+    static const ElmErrorMatcher theInstance;
+    return theInstance;
+}
+
+int ElmErrorMatcher::classOf(char16_t c)
+{
+    if (c >= 'a' && c <= 'z') {
+        return 1 + (c - 'a');
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return 1 + (c - 'A');
+    }
+    if (c >= '0' && c <= '9') {
+        return 27 + (c - '0');
+    }
+    if (c == ' ') {
+        return 37;
+    }
+    if (c == ':') {
+        return 38;
+    }
+    if (c == '.') {
+        return 39;
+    }
+    return 0;
+}
+
+int ElmErrorMatcher::addState()
+{
+    const int state = m_signature.size();
+    m_next.resize(m_next.size() + CLASSES, -1);
+    m_signature.append(-1);
+    return state;
+}
+
+ElmErrorMatcher::ElmErrorMatcher()
+{
+    // Trie of all signatures, state 0 is the root
+    addState();
+    for (int i = 0; i < SIGNATURE_COUNT; ++i) {
+        int state = 0;
+        for (const char *p = SIGNATURES[i].text; *p; ++p) {
+            const int index = state * CLASSES + classOf(char16_t(*p));
+            if (m_next[index] < 0) {
+                const int added = addState();
+                m_next[index] = added;
+            }
+            state = m_next[index];
+        }
+        m_signature[state] = better(i, m_signature[state]);
+    }
+
+    // Breadth-first: fail links, inherited matches, and missing edges filled in so match() never backtracks
+    QVector<int> fail(m_signature.size(), 0);
+    QQueue<int> pending;
+    for (int c = 0; c < CLASSES; ++c) {
+        int &target = m_next[c];
+        if (target < 0) {
+            target = 0;
+        } else {
+            pending.enqueue(target);
+        }
+    }
+    while (!pending.isEmpty()) {
+        const int state = pending.dequeue();
+        m_signature[state] = better(m_signature[state], m_signature[fail[state]]);
+        for (int c = 0; c < CLASSES; ++c) {
+            const int fallback = m_next[fail[state] * CLASSES + c];
+            int &target = m_next[state * CLASSES + c];
+            if (target < 0) {
+                target = fallback;
+            } else {
+                fail[target] = fallback;
+                pending.enqueue(target);
+            }
+        }
+    }
+}
+
+ElmError ElmErrorMatcher::negativeResponse(QStringView response)
+{
+    ElmError error;
+    qsizetype start = 0;
+    while (start < response.size()) {
+        qsizetype end = start;
+        while (end < response.size() && response[end] != QLatin1Char('\r') && response[end] != QLatin1Char('\n')) {
+            ++end;
+        }
+
+        int bytes[8];
+        bool canId = false;
+        const int count = leadingBytes(response.sliced(start, end - start), bytes, 8, canId);
+        const int index = negativeResponseIndex(bytes, count, canId);
+        if (index >= 0) {
+            error.kind = ELM_ERROR_NEGATIVE_RESPONSE;
+            error.service = index + 1 < count ? bytes[index + 1] : -1;
+            error.nrc = index + 2 < count ? bytes[index + 2] : -1;
+            return error;
+        }
+        start = end + 1;
+    }
+    return error;
+}
+
+ElmError ElmErrorMatcher::match(QStringView response) const
+{
+    // A negative response is told by its bytes, not by text, and wins over everything else
+    const ElmError negative = negativeResponse(response);
+    if (negative.isError()) {
+        return negative;
+    }
+
+    int state = 0;
+    int best = -1;
+    for (qsizetype i = 0; i < response.size(); ++i) {
+        state = m_next[state * CLASSES + classOf(response[i].unicode())];
+        best = better(m_signature[state], best);
+    }
+
+    ElmError error;
+    if (best >= 0) {
+        error.kind = SIGNATURES[best].kind;
+    }
+    return error;
+}
@@ -0,0 +1,67 @@
+#ifndef ELMERROR_H
+#define ELMERROR_H
+
+#include <QStringView>
+#include <QVector>
+
+// What went wrong with an ELM exchange. When a response matches several signatures
+// the later kind wins, so "BUS INIT: ERROR" is ELM_ERROR_BUS_INIT and not ELM_ERROR_GENERIC.
+enum ElmErrorKind {
+    ELM_ERROR_NONE,
+    ELM_ERROR_SEARCHING,          // SEARCH / SEARCHING: the adapter is still looking for a protocol
+    ELM_ERROR_GENERIC,            // a bare "ERROR"
+    ELM_ERROR_STOPPED,            // a byte from the host interrupted the command
+    ELM_ERROR_BUFFER_FULL,        // BUFFER FULL / OVERFLOW
+    ELM_ERROR_DATA,               // DATA, CHECKSUM, FRAMING, PARITY ERROR
+    ELM_ERROR_BUS,                // BUS ERROR, CAN ERROR, PROTOCOL ERROR
+    ELM_ERROR_BUS_BUSY,
+    ELM_ERROR_TIMEOUT,            // TIMEOUT / NO RESPONSE
+    ELM_ERROR_NO_DATA,            // the ECU did not answer this request
+    ELM_ERROR_UNABLE_TO_CONNECT,
+    ELM_ERROR_BUS_INIT,           // BUS INIT: ERROR (KWP2000 fast init failed)
+    ELM_ERROR_NEGATIVE_RESPONSE   // 7F <service> <NRC>, after the header if headers are on
+};
+
+struct ElmError {
+    // Negative response codes (ISO 14230-3): busy asks for a resend, pending for more patience
+    static const int NRC_BUSY_REPEAT_REQUEST = 0x21;
+    static const int NRC_RESPONSE_PENDING = 0x78;
+
+    ElmErrorKind kind{ELM_ERROR_NONE};
+    int service{-1};   // rejected service for negative responses, -1 if unknown
+    int nrc{-1};       // negative response code, -1 if unknown
+
+    bool isError() const { return kind != ELM_ERROR_NONE; }
+    // Resending the same request unchanged may succeed
+    bool isRetryable() const;
+    // The ECU accepted the request and will answer later (7F xx 78)
+    bool isResponsePending() const { return kind == ELM_ERROR_NEGATIVE_RESPONSE && nrc == NRC_RESPONSE_PENDING; }
+    const char *name() const;
+};
+
+// Aho-Corasick automaton over the ELM adapter error texts, built once; negative responses are
+// recognised from their bytes.
+// match() is one case-insensitive pass over the response, no upper-casing copy or per-signature scans.
+class ElmErrorMatcher
+{
+public:
+    static const ElmErrorMatcher &getInstance();
+
+    ElmError match(QStringView response) const;
+    // Only the 7F check: any line whose first byte after the optional header is 0x7F
+    static ElmError negativeResponse(QStringView response);
+
+private:
+    ElmErrorMatcher();
+
+    static int classOf(char16_t c);
+    int addState();
+
+    // Signature characters fold to classes 1-39: A-Z (either case), 0-9, space, ':' and '.'; anything else is 0
+    static const int CLASSES = 40;
+
+    QVector<int> m_next;        // dense DFA: m_next[state * CLASSES + class]
+    QVector<int> m_signature;   // best signature ending in each state (own or via fail links), -1 if none
+};
+
+#endif // ELMERROR_H
@@ -0,0 +1,111 @@
+#include "elmframer.h"
+
+static inline bool isPadding(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\0';
+}
+
+ElmFramer::ElmFramer()
+{
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "ElmFramer capacity must be a power of two");
+}
+
+void ElmFramer::setLineHandler(LineHandler handler)
+{
+    m_lineHandler = std::move(handler);
+}
+
+void ElmFramer::setPromptHandler(PromptHandler handler)
+{
+    m_promptHandler = std::move(handler);
+}
+
+char *ElmFramer::writePointer()
+{
+    return m_ring + (m_head & MASK);
+}
+
+qsizetype ElmFramer::writableSize()
+{
+    // A single line filled the whole ring: hand it out truncated rather than stall
+    if (m_head - m_lineStart >= quint64(CAPACITY)) {
+        emitLine(m_lineStart, m_head);
+        m_lineStart = m_head;
+    }
+
+    const quint64 free = quint64(CAPACITY) - (m_head - m_lineStart);
+    const quint64 untilWrap = quint64(CAPACITY) - (m_head & MASK);
+    return qsizetype(free < untilWrap ? free : untilWrap);
+}
+
+void ElmFramer::commit(qsizetype size)
+{
+    const quint64 end = m_head + quint64(size);
+
+    for (quint64 pos = m_head; pos < end; ++pos) {
+        const char c = m_ring[pos & MASK];
+
+        if (c == '\r' || c == '\n') {
+            emitLine(m_lineStart, pos);
+            m_lineStart = pos + 1;
+        }
+        else if (c == '>') {
+            emitLine(m_lineStart, pos);
+            m_lineStart = pos + 1;
+            if (m_promptHandler) {
+                m_promptHandler();
+            }
+        }
+    }
+
+    m_head = end;
+}
+
+void ElmFramer::append(const char *data, qsizetype size)
+{
+    while (size > 0) {
+        qsizetype chunk = writableSize();
+        if (chunk > size) {
+            chunk = size;
+        }
+        std::memcpy(writePointer(), data, size_t(chunk));
+        commit(chunk);
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+void ElmFramer::reset()
+{
+    m_head = 0;
+    m_lineStart = 0;
+}
+
+void ElmFramer::emitLine(quint64 start, quint64 end)
+{
+    // Trim padding in place, on ring positions
+    while (start < end && isPadding(m_ring[start & MASK])) {
+        ++start;
+    }
+    while (end > start && isPadding(m_ring[(end - 1) & MASK])) {
+        --end;
+    }
+
+    if (start == end || !m_lineHandler) {
+        return;
+    }
+
+    const qsizetype length = qsizetype(end - start);
+    const qsizetype offset = qsizetype(start & MASK);
+
+    if (offset + length <= CAPACITY) {
+        m_lineHandler(QByteArrayView(m_ring + offset, length));
+        return;
+    }
+
+    // The line wraps around the end of the ring
+    const qsizetype firstPart = CAPACITY - offset;
+    std::memcpy(m_scratch, m_ring + offset, size_t(firstPart));
+    std::memcpy(m_scratch + firstPart, m_ring, size_t(length - firstPart));
+    m_lineHandler(QByteArrayView(m_scratch, length));
+}
@@ -0,0 +1,77 @@
+#ifndef ELMFRAMER_H
+#define ELMFRAMER_H
+
+#include <QByteArrayView>
+#include <functional>
+#include <cstring>
+
+// Fixed-size frame passed between threads (one line, a prompt, or an outgoing command)
+struct ElmFrame {
+    enum Kind : quint8 { Line, Prompt };
+
+    static const qsizetype MAX_SIZE = 255;
+
+    Kind kind{Line};
+    bool afterLoss{false};   // lines were dropped right before this frame
+    bool truncated{false};   // the line was longer than MAX_SIZE; the rest is gone
+    quint8 size{0};
+    char data[MAX_SIZE];
+
+    static ElmFrame line(QByteArrayView bytes)
+    {
+        ElmFrame frame;
+        frame.truncated = bytes.size() > MAX_SIZE;
+        frame.size = quint8(frame.truncated ? MAX_SIZE : bytes.size());
+        std::memcpy(frame.data, bytes.data(), size_t(frame.size));
+        return frame;
+    }
+
+    static ElmFrame prompt()
+    {
+        ElmFrame frame;
+        frame.kind = Prompt;
+        return frame;
+    }
+
+    QByteArrayView view() const { return QByteArrayView(data, size); }
+};
+
+// Byte-level framer for the ELM327 output stream.
+// Transports read straight into the ring; complete lines are handed out as views into it
+// (or into a fixed scratch area when a line wraps), so nothing is allocated per chunk.
+class ElmFramer
+{
+public:
+    static const qsizetype CAPACITY = 4096; // must be a power of two
+
+    using LineHandler = std::function<void(QByteArrayView)>;
+    using PromptHandler = std::function<void()>;
+
+    ElmFramer();
+
+    void setLineHandler(LineHandler handler);
+    void setPromptHandler(PromptHandler handler);
+
+    // Zero-copy feed: read into writePointer(), then commit() the byte count
+    char *writePointer();
+    qsizetype writableSize();
+    void commit(qsizetype size);
+
+    // Copying feed for sources that already own their bytes
+    void append(const char *data, qsizetype size);
+    void reset();
+
+private:
+    void emitLine(quint64 start, quint64 end);
+
+    static const quint64 MASK = CAPACITY - 1;
+
+    char m_ring[CAPACITY];
+    char m_scratch[CAPACITY];
+    quint64 m_head{0};       // next byte to be written
+    quint64 m_lineStart{0};  // first byte of the unfinished line
+    LineHandler m_lineHandler;
+    PromptHandler m_promptHandler;
+};
+
+#endif // ELMFRAMER_H
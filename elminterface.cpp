@@ -0,0 +1,801 @@
+#include "elminterface.h"
+#include "connectionmanager.h"
+#include "instrumentation.h"
+#include <QEventLoop>
+
+ElmInterface* ElmInterface::theInstance_ = nullptr;
+
+namespace {
+
+// Request that proves a protocol switch: the bus has to carry it to the module and back
+WJCommandId probeCommand(WJModule module)
+{
+    switch (module) {
+    case MODULE_ENGINE_EDC15: return CMD_ENGINE_START_COMMUNICATION;
+    case MODULE_PCM: return CMD_PCM_READ_LIVE_DATA;
+    case MODULE_ABS: return CMD_ABS_READ_WHEEL_SPEEDS;
+    default: return CMD_TRANS_READ_TRANS_DATA;
+    }
+}
+
+} // namespace
+
+ElmInterface *ElmInterface::getInstance()
+{
+    if (theInstance_ == nullptr)
+    {
+        theInstance_ = new ElmInterface(ConnectionManager::getInstance());
+    }
+    return theInstance_;
+}
+
+ElmInterface::ElmInterface(ConnectionManager *connection, QObject *parent)
+    : QObject(parent)
+    , m_connection(connection)
+{
+    m_timeoutTimer.setSingleShot(true);
+    connect(&m_timeoutTimer, &QTimer::timeout, this, &ElmInterface::onRequestTimeout);
+
+    if (m_connection) {
+        connect(m_connection, &ConnectionManager::lineReceived, this, &ElmInterface::onLineReceived);
+        connect(m_connection, &ConnectionManager::promptReceived, this, &ElmInterface::onPromptReceived);
+        connect(m_connection, &ConnectionManager::framesLost, this, &ElmInterface::onFramesLost);
+        connect(m_connection, &ConnectionManager::disconnected, this, &ElmInterface::onDisconnected);
+    }
+}
+
+ElmRequest ElmInterface::makeRequest(const QString &command, WJModule targetModule, int timeoutMs)
+{
+    ElmRequest request;
+    request.id = m_nextId++;
+    request.command = command.trimmed();
+    request.targetModule = targetModule;
+    request.timeoutMs = timeoutMs;
+    request.enqueuedUs = Instrumentation::getInstance()->nowUs();
+    return request;
+}
+
+quint32 ElmInterface::enqueue(const QString &command, WJModule targetModule, int timeoutMs)
+{
+    ElmRequest request = makeRequest(command, targetModule, timeoutMs);
+    queueRequest(request);
+    return request.id;
+}
+
+quint32 ElmInterface::enqueue(WJCommandId command, int timeoutMs)
+{
+    const WJCommandDescriptor &descriptor = WJCommandTable::descriptor(command);
+
+    ElmRequest request = makeRequest(QString(), descriptor.module, timeoutMs > 0 ? timeoutMs : descriptor.timeoutMs);
+    request.command = WJCommandTable::text(command);
+    request.descriptor = &descriptor;
+    queueRequest(request);
+    return request.id;
+}
+
+void ElmInterface::queueRequest(const ElmRequest &request)
+{
+    m_queue.enqueue(request);
+
+    if (!m_busy) {
+        dispatchNext();
+    }
+}
+
+void ElmInterface::failPending()
+{
+    QList<ElmRequest> dropped;
+    if (m_busy && !m_resyncing) {
+        dropped.append(m_active);
+    }
+    dropped.append(m_queue);
+    m_queue.clear();
+    if (dropped.isEmpty()) {
+        return;
+    }
+
+    // Reported from the event loop: whoever called enqueue() has the id by then
+    QMetaObject::invokeMethod(this, [this, dropped]() {
+        for (const ElmRequest &request : dropped) {
+            emit requestTimedOut(request.id, request.command);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void ElmInterface::clearQueue()
+{
+    m_queue.clear();
+}
+
+int ElmInterface::pendingCount() const
+{
+    return m_queue.size() + (m_busy ? 1 : 0);
+}
+
+bool ElmInterface::isBusy() const
+{
+    return m_busy;
+}
+
+const ElmAdapterState &ElmInterface::adapterState() const
+{
+    return m_adapterState;
+}
+
+const LatencyModel &ElmInterface::latencyModel() const
+{
+    return m_latency;
+}
+
+void ElmInterface::seedLatency(WJModule module, const LatencyModel::Stats &stats)
+{
+    m_latency.seed(module, stats);
+}
+
+void ElmInterface::switchProtocol(WJProtocol protocol)
+{
+    if (m_switch.active && m_switch.target == protocol) {
+        return;
+    }
+    if (protocol == m_adapterState.protocol) {
+        m_protocol = protocol;
+        emit protocolSwitched(protocol, true, false, 0);
+        return;
+    }
+
+    for (const ElmRequest &request : beginProtocolSwitch(protocol)) {
+        m_queue.enqueue(request);
+    }
+    if (!m_busy) {
+        dispatchNext();
+    }
+}
+
+QList<ElmRequest> ElmInterface::beginProtocolSwitch(WJProtocol protocol, WJModule module)
+{
+    // Remember how the protocol we leave was set up, for switching back
+    if (m_adapterState.protocol != PROTOCOL_UNKNOWN && m_adapterState.protocol != PROTOCOL_AUTO_DETECT) {
+        m_protocolStates.insert(m_adapterState.protocol, m_adapterState);
+    }
+
+    m_switch.active = true;
+    m_switch.usingReset = false;
+    m_switch.from = m_adapterState.protocol;
+    m_switch.target = protocol;
+    m_switch.timer.start();
+
+    // ATTP does not store the protocol, so switching back and forth doesn't rewrite the adapter's memory
+    QStringList commands;
+    commands.append("ATTP" + ElmAdapterState::protocolNumber(protocol));
+
+    ElmAdapterState afterSwitch = m_adapterState;
+    afterSwitch.protocol = protocol;
+    commands += afterSwitch.commandsToReach(cachedStateFor(protocol));
+
+    QList<ElmRequest> requests;
+    for (const QString &command : commands) {
+        requests.append(makeRequest(command, MODULE_UNKNOWN, WJ::Protocols::PROTOCOL_SWITCH_TIMEOUT));
+    }
+    // ATDPN would only echo what ATTP set; a module has to answer over the new bus.
+    // The engine is the KWP module, the transmission is on J1850 in every WJ.
+    if (module == MODULE_UNKNOWN || WJCommands::getModuleConfig(module).protocol != protocol) {
+        module = (protocol == PROTOCOL_ISO_14230_4_KWP_FAST) ? MODULE_ENGINE_EDC15 : MODULE_TRANSMISSION;
+    }
+    const WJCommandDescriptor &probe = WJCommandTable::descriptor(probeCommand(module));
+    ElmRequest check = makeRequest(WJCommandTable::text(probe.id), probe.module, probe.timeoutMs);
+    check.descriptor = &probe;
+    m_switch.checkId = check.id;
+    requests.append(check);
+    return requests;
+}
+
+ElmAdapterState ElmInterface::cachedStateFor(WJProtocol protocol) const
+{
+    ElmAdapterState target;
+    if (m_protocolStates.contains(protocol)) {
+        target = m_protocolStates.value(protocol);
+    } else {
+        // Same settings the full switch sequence would leave behind
+        target.headers = (protocol == PROTOCOL_J1850_VPW) ? SWITCH_ON : SWITCH_OFF;
+        if (protocol == PROTOCOL_J1850_VPW) {
+            target.timeout = "32";
+        }
+    }
+
+    // Echo, linefeeds and spaces are adapter-wide and survive ATTP
+    target.protocol = protocol;
+    target.echo = SWITCH_UNKNOWN;
+    target.linefeeds = SWITCH_UNKNOWN;
+    target.spaces = SWITCH_UNKNOWN;
+    return target;
+}
+
+void ElmInterface::advanceProtocolSwitch(quint32 id, const QStringList &lines)
+{
+    if (!m_switch.active || id != m_switch.checkId) {
+        return;
+    }
+
+    if (m_switch.usingReset) {
+        finishProtocolSwitch(!lines.isEmpty() && !WJUtils::isError(lines.join(' '), m_switch.target));
+        return;
+    }
+
+    // Any answer from the module proves the bus, a negative response included;
+    // BUS INIT: ...ERROR, UNABLE TO CONNECT, NO DATA, bus errors and silence don't
+    const ElmError error = lines.isEmpty() ? ElmError() : WJUtils::classifyError(lines.join('\r'));
+    if (!lines.isEmpty() && (!error.isError() || error.kind == ELM_ERROR_NEGATIVE_RESPONSE)) {
+        finishProtocolSwitch(true);
+        return;
+    }
+
+    // Fast path failed: run the full reset sequence ahead of everything else
+    m_switch.usingReset = true;
+    QList<WJCommand> commands = WJCommands::getProtocolSwitchCommands(PROTOCOL_UNKNOWN, m_switch.target);
+    if (commands.isEmpty()) {
+        finishProtocolSwitch(false);
+        return;
+    }
+
+    for (int i = commands.size() - 1; i >= 0; --i) {
+        const WJCommand &cmd = commands.at(i);
+        ElmRequest request = makeRequest(cmd.command, MODULE_UNKNOWN, cmd.timeoutMs);
+        if (i == commands.size() - 1) {
+            m_switch.checkId = request.id;
+        }
+        m_queue.prepend(request);
+    }
+}
+
+void ElmInterface::finishProtocolSwitch(bool ok)
+{
+    m_switch.active = false;
+    if (ok) {
+        m_protocol = m_switch.target;
+    } else {
+        m_lastError = "Protocol switch failed: " + WJUtils::getProtocolName(m_switch.target);
+    }
+    emit protocolSwitched(m_switch.target, ok, m_switch.usingReset, m_switch.timer.elapsed());
+}
+
+void ElmInterface::dispatchNext()
+{
+    while (!m_queue.isEmpty()) {
+        if (!isConnected()) {
+            m_lastError = "Not connected";
+            failPending();
+            break;
+        }
+
+        // Put the adapter into the state the module needs, only where it differs
+        const WJModule module = m_queue.head().targetModule;
+        if (isEcuRequest(m_queue.head())) {
+            ElmAdapterState target = ElmAdapterState::forModule(module);
+            target.timeout = m_latency.elmTimeout(module);
+
+            // A protocol change goes through the timed switch, with its check and reset fallback
+            if (target.protocol != PROTOCOL_UNKNOWN && target.protocol != m_adapterState.protocol
+                && !(m_switch.active && m_switch.target == target.protocol)) {
+                const QList<ElmRequest> sequence = beginProtocolSwitch(target.protocol, module);
+                for (int i = sequence.size() - 1; i >= 0; --i) {
+                    m_queue.prepend(sequence.at(i));
+                }
+                continue;
+            }
+
+            const QStringList setup = m_adapterState.commandsToReach(target);
+            for (int i = setup.size() - 1; i >= 0; --i) {
+                m_queue.prepend(makeRequest(setup.at(i), module, WJ::Protocols::DEFAULT_TIMEOUT));
+            }
+        }
+
+        m_active = m_queue.dequeue();
+        m_busy = true;
+
+        if (isAdapterRequest(m_active) && m_adapterState.isRedundant(m_active.command)) {
+            // Adapter already has this setting: answer locally, no round-trip
+            ElmRequest skipped = m_active;
+            m_active = ElmRequest();
+            m_busy = false;
+            m_lastResponse = "OK";
+            advanceProtocolSwitch(skipped.id, QStringList() << "OK");
+            emit responseReceived(skipped.id, skipped.command, skipped.targetModule, QStringList() << "OK");
+
+            // A slot may have started the next request already
+            if (m_busy) {
+                return;
+            }
+            continue;
+        }
+
+        // Anything still buffered belongs to a request we already gave up on
+        m_rxLines.clear();
+        m_rxLost = false;
+        m_assembler.reset();
+        if (m_active.descriptor) {
+            m_assembler.expectRecord(m_active.descriptor->protocol == PROTOCOL_ISO_14230_4_KWP_FAST,
+                                     m_active.descriptor->responseSid, m_active.descriptor->minResponseLength);
+        } else {
+            m_assembler.expectRecord(ElmAdapterState::forModule(m_active.targetModule).protocol == PROTOCOL_ISO_14230_4_KWP_FAST);
+        }
+
+        if (isEcuRequest(m_active)) {
+            m_active.timeoutMs = m_latency.hostTimeoutMs(m_active.targetModule, serviceOf(m_active), m_active.timeoutMs);
+        }
+
+        m_active.sentUs = Instrumentation::getInstance()->nowUs();
+        if (!sendActive()) {
+            m_lastError = "Failed to send: " + m_active.command;
+            completeActive(QStringList());
+            return;
+        }
+
+        if (isAdapterRequest(m_active)) {
+            m_adapterState.apply(m_active.command);
+        }
+        m_requestClock.start();
+        m_replyMs = -1;
+        m_timeoutTimer.start(m_active.timeoutMs + HOST_TIMEOUT_MARGIN_MS);
+        emit commandSent(m_active.id, m_active.command);
+        return;
+    }
+
+    m_busy = false;
+    if (m_queue.isEmpty()) {
+        emit queueDrained();
+    }
+}
+
+void ElmInterface::onLineReceived(QByteArrayView line)
+{
+    // The view is only valid during this call; keep a copy only of what we return
+    if (m_busy && !m_resyncing && !isEcho(line)) {
+        if (m_replyMs < 0) {
+            m_replyMs = m_requestClock.elapsed();
+        }
+        m_rxLines.append(QString::fromLatin1(line));
+
+        // The ECU asked for more time (7F xx 78): wait for the real reply instead of resending
+        if (isEcuRequest(m_active) && ElmErrorMatcher::negativeResponse(m_rxLines.last()).isResponsePending()) {
+            m_timeoutTimer.start(m_active.timeoutMs + HOST_TIMEOUT_MARGIN_MS);
+        }
+
+        // Decode while the rest of the response is still on the wire
+        if (isEcuRequest(m_active) && !m_rxLost && m_assembler.feed(line) == ElmMessageAssembler::STATUS_COMPLETE) {
+            // Receivers decode synchronously, so the emission is the parse time
+            Instrumentation *instrumentation = Instrumentation::getInstance();
+            const QString command = m_active.command;
+            const WJModule module = m_active.targetModule;
+            const qint64 startUs = instrumentation->nowUs();
+            emit messageReceived(m_active.id, module, QByteArrayView(m_assembler.data(), m_assembler.size()));
+            instrumentation->recordParse(command, module, instrumentation->nowUs() - startUs);
+        }
+    }
+}
+
+void ElmInterface::onPromptReceived()
+{
+    if (!m_busy) {
+        m_rxLines.clear();
+        return;
+    }
+    if (m_resyncing) {
+        finishResync();
+        return;
+    }
+    if (m_rxLost) {
+        // Part of the response never arrived: fail the request rather than decode the rest
+        m_rxLost = false;
+        m_rxLines.clear();
+        m_lastError = "Response lost (receive queue full or line too long): " + m_active.command;
+        completeActive(QStringList());
+        return;
+    }
+
+    // STOPPED (a byte arrived while the ELM was busy), BUS BUSY, or an ECU asking to repeat (7F xx 21): resend once
+    if (m_rxLines.size() == 1 && m_active.retries < MAX_TRANSIENT_RETRIES
+        && WJUtils::classifyError(m_rxLines.first()).isRetryable()) {
+        m_rxLines.clear();
+        m_assembler.reset();
+        m_active.retries++;
+        sendActive();
+        m_requestClock.start();
+        m_replyMs = -1;
+        m_timeoutTimer.start(m_active.timeoutMs + HOST_TIMEOUT_MARGIN_MS);
+        return;
+    }
+
+    // Response-pending lines only announced the reply that followed them
+    QStringList replies = m_rxLines;
+    replies.removeIf([](const QString &line) {
+        return ElmErrorMatcher::negativeResponse(line).isResponsePending();
+    });
+    if (!replies.isEmpty()) {
+        m_rxLines.swap(replies);
+    }
+
+    QStringList lines;
+    lines.swap(m_rxLines);
+    completeActive(lines);
+}
+
+void ElmInterface::onFramesLost()
+{
+    if (m_busy && !m_resyncing) {
+        m_rxLost = true;
+        m_assembler.reset();
+    }
+}
+
+void ElmInterface::completeActive(const QStringList &lines)
+{
+    m_timeoutTimer.stop();
+
+    ElmRequest finished = m_active;
+    m_active = ElmRequest();
+    m_busy = false;
+
+    if (lines.isEmpty() || lines.contains("?")) {
+        m_adapterState.forget(finished.command);
+    }
+
+    const ElmError error = lines.isEmpty() ? ElmError() : WJUtils::classifyError(lines.join('\r'));
+    Instrumentation::Outcome outcome = Instrumentation::OUTCOME_REPLY;
+    if (error.kind == ELM_ERROR_NO_DATA) {
+        outcome = Instrumentation::OUTCOME_NO_DATA;
+    } else if (lines.isEmpty() || error.isError() || lines.contains("?")) {
+        outcome = Instrumentation::OUTCOME_ERROR;
+    }
+    Instrumentation *instrumentation = Instrumentation::getInstance();
+    instrumentation->recordRequest(finished.command, finished.targetModule, finished.sentUs - finished.enqueuedUs,
+                                   instrumentation->nowUs() - finished.sentUs, finished.retries, outcome);
+    if (!lines.isEmpty()) {
+        recordLatency(finished, error);
+    }
+
+    advanceProtocolSwitch(finished.id, lines);
+
+    m_lastResponse = lines.join(' ');
+    emit responseReceived(finished.id, finished.command, finished.targetModule, lines);
+
+    // Emitting may have queued more work or started a nested request already
+    if (!m_busy) {
+        dispatchNext();
+    }
+}
+
+void ElmInterface::recordLatency(const ElmRequest &request, const ElmError &error)
+{
+    if (!isEcuRequest(request)) {
+        return;
+    }
+
+    const quint8 service = serviceOf(request);
+    if (error.kind == ELM_ERROR_NO_DATA) {
+        m_latency.recordMiss(request.targetModule, service, 0);
+        return;
+    }
+    if (error.isError()) {
+        return;
+    }
+
+    const qint64 totalMs = m_requestClock.elapsed();
+    m_latency.recordReply(request.targetModule, service, m_replyMs >= 0 ? m_replyMs : totalMs, totalMs);
+}
+
+void ElmInterface::onRequestTimeout()
+{
+    if (!m_busy) {
+        return;
+    }
+    if (m_resyncing) {
+        // No prompt at all: the adapter is gone or wedged, carry on and let the next request tell
+        finishResync();
+        return;
+    }
+
+    ElmRequest expired = m_active;
+    m_active = ElmRequest();
+    m_busy = false;
+
+    m_adapterState.forget(expired.command);
+    Instrumentation *instrumentation = Instrumentation::getInstance();
+    instrumentation->recordRequest(expired.command, expired.targetModule, expired.sentUs - expired.enqueuedUs,
+                                   instrumentation->nowUs() - expired.sentUs, expired.retries,
+                                   Instrumentation::OUTCOME_TIMEOUT);
+    if (isEcuRequest(expired)) {
+        m_latency.recordMiss(expired.targetModule, serviceOf(expired), m_requestClock.elapsed());
+    }
+    m_lastError = "Timeout waiting for response to " + expired.command;
+
+    // The ELM may still be answering: its late prompt must not complete the next request
+    resync();
+
+    advanceProtocolSwitch(expired.id, QStringList());
+    emit requestTimedOut(expired.id, expired.command);
+}
+
+void ElmInterface::resync()
+{
+    // A CR stops an ELM that is still working on the expired request (an idle one repeats
+    // the last command); either way the next prompt closes the old exchange
+    m_resyncing = true;
+    m_busy = true;
+    m_rxLines.clear();
+    m_assembler.reset();
+
+    if (!m_connection->sendRaw(QByteArrayView("\r"))) {
+        finishResync();
+        return;
+    }
+    m_timeoutTimer.start(RESYNC_TIMEOUT_MS);
+}
+
+void ElmInterface::finishResync()
+{
+    m_timeoutTimer.stop();
+    m_resyncing = false;
+    m_busy = false;
+    m_rxLines.clear();
+    m_assembler.reset();
+    dispatchNext();
+}
+
+void ElmInterface::onDisconnected()
+{
+    m_timeoutTimer.stop();
+    failPending();
+    m_active = ElmRequest();
+    m_busy = false;
+    m_resyncing = false;
+    m_rxLost = false;
+    m_rxLines.clear();
+    m_adapterState.invalidate();
+    m_protocolStates.clear();
+    m_switch.active = false;
+    m_protocol = PROTOCOL_UNKNOWN;
+    m_module = MODULE_UNKNOWN;
+}
+
+bool ElmInterface::sendActive()
+{
+    // Table commands are already encoded; only free-form text needs converting
+    if (m_active.descriptor) {
+        return m_connection->sendRaw(m_active.descriptor->wireBytes());
+    }
+    return m_connection->send(m_active.command);
+}
+
+bool ElmInterface::isAdapterRequest(const ElmRequest &request)
+{
+    return request.descriptor ? request.descriptor->adapterCommand : ElmAdapterState::isAtCommand(request.command);
+}
+
+bool ElmInterface::isEcuRequest(const ElmRequest &request)
+{
+    return request.targetModule != MODULE_UNKNOWN && !isAdapterRequest(request);
+}
+
+quint8 ElmInterface::serviceOf(const ElmRequest &request)
+{
+    return request.descriptor ? request.descriptor->request[0] : LatencyModel::serviceOf(request.command);
+}
+
+bool ElmInterface::isEcho(QByteArrayView line) const
+{
+    const QString &command = m_active.command;
+    if (command.isEmpty()) {
+        return false;
+    }
+
+    // Compare ignoring spaces and case, without building temporary strings
+    qsizetype i = 0;
+    qsizetype j = 0;
+    while (true) {
+        while (i < line.size() && line[i] == ' ') {
+            ++i;
+        }
+        while (j < command.size() && command[j] == QLatin1Char(' ')) {
+            ++j;
+        }
+        if (i == line.size() || j == command.size()) {
+            return i == line.size() && j == command.size();
+        }
+        if (QChar::toUpper(uchar(line[i])) != command[j].toUpper().unicode()) {
+            return false;
+        }
+        ++i;
+        ++j;
+    }
+}
+
+bool ElmInterface::waitForRequest(const ElmRequest &request, QStringList &lines, int timeoutMs)
+{
+    const quint32 id = request.id;
+    bool done = false;
+    bool answered = false;
+
+    QEventLoop loop;
+    QTimer guard;
+    guard.setSingleShot(true);
+    QObject::connect(&guard, &QTimer::timeout, &loop, &QEventLoop::quit);
+
+    auto responseConnection = QObject::connect(this, &ElmInterface::responseReceived, &loop,
+                                               [&](quint32 finishedId, const QString &, WJModule, const QStringList &response) {
+                                                   if (finishedId == id) {
+                                                       lines = response;
+                                                       answered = true;
+                                                       done = true;
+                                                       loop.quit();
+                                                   }
+                                               });
+    auto timeoutConnection = QObject::connect(this, &ElmInterface::requestTimedOut, &loop,
+                                              [&](quint32 expiredId, const QString &) {
+                                                  if (expiredId == id) {
+                                                      done = true;
+                                                      loop.quit();
+                                                  }
+                                              });
+
+    // Requests ahead of ours have to finish first, so only guard against a dead link
+    guard.start(timeoutMs + HOST_TIMEOUT_MARGIN_MS + pendingCount() * (WJ::Protocols::DEFAULT_TIMEOUT + HOST_TIMEOUT_MARGIN_MS));
+
+    // Queued only now: a redundant AT command is answered inside dispatchNext()
+    queueRequest(request);
+    if (!done) {
+        loop.exec();
+    }
+
+    QObject::disconnect(responseConnection);
+    QObject::disconnect(timeoutConnection);
+    return answered;
+}
+
+// Protocol management
+bool ElmInterface::setProtocol(WJProtocol protocol)
+{
+    switch (protocol) {
+    case PROTOCOL_ISO_14230_4_KWP_FAST:
+    case PROTOCOL_J1850_VPW:
+        switchProtocol(protocol);
+        break;
+    case PROTOCOL_AUTO_DETECT:
+        enqueue("ATSP0", MODULE_UNKNOWN, WJ::Protocols::PROTOCOL_SWITCH_TIMEOUT);
+        m_protocol = protocol;
+        break;
+    default:
+        m_lastError = "Unsupported protocol";
+        return false;
+    }
+
+    return isConnected();
+}
+
+WJProtocol ElmInterface::getCurrentProtocol() const
+{
+    return m_protocol;
+}
+
+bool ElmInterface::switchToModule(WJModule module)
+{
+    WJModuleConfig config = WJCommands::getModuleConfig(module);
+    if (config.protocol == PROTOCOL_UNKNOWN) {
+        m_lastError = "Unknown module";
+        return false;
+    }
+
+    // Header, wakeup and protocol are brought in lazily before the module's next request
+    m_module = module;
+    return isConnected();
+}
+
+// Connection management
+bool ElmInterface::initializeConnection(WJProtocol protocol)
+{
+    if (!isConnected()) {
+        m_lastError = "Adapter not connected";
+        return false;
+    }
+
+    if (protocol == PROTOCOL_AUTO_DETECT || protocol == PROTOCOL_UNKNOWN) {
+        protocol = PROTOCOL_ISO_14230_4_KWP_FAST;
+    }
+
+    QList<WJCommand> commands = WJCommands::getInitSequence(protocol);
+    QString response;
+    for (const WJCommand &cmd : commands) {
+        if (!sendCommandAndWaitResponse(cmd.command, response, cmd.targetModule, cmd.timeoutMs) && cmd.isCritical) {
+            m_lastError = "Critical init command failed: " + cmd.command;
+            return false;
+        }
+    }
+
+    m_protocol = protocol;
+    m_module = commands.isEmpty() ? MODULE_UNKNOWN : commands.first().targetModule;
+    return true;
+}
+
+bool ElmInterface::isConnected() const
+{
+    return m_connection && m_connection->isConnected();
+}
+
+void ElmInterface::disconnect()
+{
+    onDisconnected();
+    if (m_connection) {
+        m_connection->disConnectElm();
+    }
+}
+
+// Communication
+bool ElmInterface::sendCommand(const QString &command, WJModule targetModule)
+{
+    if (!isConnected()) {
+        m_lastError = "Not connected";
+        return false;
+    }
+
+    enqueue(command, targetModule == MODULE_UNKNOWN ? m_module : targetModule, WJ::Protocols::DEFAULT_TIMEOUT);
+    return true;
+}
+
+QString ElmInterface::readResponse(int timeoutMs)
+{
+    if (pendingCount() == 0) {
+        return m_lastResponse;
+    }
+
+    QEventLoop loop;
+    QTimer guard;
+    guard.setSingleShot(true);
+    QObject::connect(&guard, &QTimer::timeout, &loop, &QEventLoop::quit);
+    auto responseConnection = QObject::connect(this, &ElmInterface::responseReceived, &loop, &QEventLoop::quit);
+    auto timeoutConnection = QObject::connect(this, &ElmInterface::requestTimedOut, &loop, &QEventLoop::quit);
+
+    guard.start(timeoutMs);
+    loop.exec();
+
+    QObject::disconnect(responseConnection);
+    QObject::disconnect(timeoutConnection);
+    return m_lastResponse;
+}
+
+bool ElmInterface::sendCommandAndWaitResponse(const QString &command, QString &response,
+                                              WJModule targetModule, int timeoutMs)
+{
+    response.clear();
+
+    if (!isConnected()) {
+        m_lastError = "Not connected";
+        return false;
+    }
+
+    QStringList lines;
+    if (!waitForRequest(makeRequest(command, targetModule, timeoutMs), lines, timeoutMs)) {
+        return false;
+    }
+
+    response = lines.join(' ');
+    if (response.isEmpty() || WJUtils::isError(response, m_protocol)) {
+        m_lastError = response.isEmpty() ? "Empty response to " + command : response;
+        return false;
+    }
+    return true;
+}
+
+// Error handling
+QString ElmInterface::getLastError() const
+{
+    return m_lastError;
+}
+
+bool ElmInterface::hasError() const
+{
+    return !m_lastError.isEmpty();
+}
+
+void ElmInterface::clearError()
+{
+    m_lastError.clear();
+}
@@ -0,0 +1,156 @@
+#ifndef ELMINTERFACE_H
+#define ELMINTERFACE_H
+
+#include <QObject>
+#include <QByteArrayView>
+#include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include "global.h"
+#include "elmadapterstate.h"
+#include "elmmessageassembler.h"
+#include "latencymodel.h"
+#include "wjcommandtable.h"
+
+class ConnectionManager;
+
+// Command waiting in (or currently served from) the adapter queue
+struct ElmRequest {
+    quint32 id{0};
+    QString command;
+    WJModule targetModule{MODULE_UNKNOWN};
+    int timeoutMs{1000};
+    int retries{0};
+    const WJCommandDescriptor *descriptor{nullptr};  // table commands go out pre-encoded
+    qint64 enqueuedUs{0};   // Instrumentation clock
+    qint64 sentUs{0};
+};
+
+// Asynchronous WJInterface over ConnectionManager.
+// Requests are queued and written back-to-back: the next command goes out as soon
+// as the ELM '>' prompt closes the previous response, so there are no fixed gaps.
+// Requests for a module get only the AT commands the adapter state is missing
+// (header, protocol, ...); AT commands that would change nothing are answered locally.
+// ECU requests use learned timeouts (host side and ATST) once enough replies were timed.
+class ElmInterface : public QObject, public WJInterface
+{
+    Q_OBJECT
+public:
+    explicit ElmInterface(ConnectionManager *connection, QObject *parent = nullptr);
+    static ElmInterface* getInstance();
+
+    // Non-blocking API
+    quint32 enqueue(const QString &command, WJModule targetModule = MODULE_UNKNOWN, int timeoutMs = 1000);
+    // Table command: module, timeout and wire bytes come from WJCommandTable (timeoutMs 0 = table default)
+    quint32 enqueue(WJCommandId command, int timeoutMs = 0);
+    void clearQueue();
+    int pendingCount() const;
+    bool isBusy() const;
+    const ElmAdapterState &adapterState() const;
+    const LatencyModel &latencyModel() const;
+    void seedLatency(WJModule module, const LatencyModel::Stats &stats);
+
+    // Fast protocol switch: ATTP plus the settings cached for that protocol, ATZ sequence only on failure
+    void switchProtocol(WJProtocol protocol);
+
+    // Protocol management
+    bool setProtocol(WJProtocol protocol) override;
+    WJProtocol getCurrentProtocol() const override;
+    bool switchToModule(WJModule module) override;
+
+    // Connection management
+    bool initializeConnection(WJProtocol protocol = PROTOCOL_AUTO_DETECT) override;
+    bool isConnected() const override;
+    void disconnect() override;
+
+    // Communication
+    bool sendCommand(const QString &command, WJModule targetModule = MODULE_UNKNOWN) override;
+    QString readResponse(int timeoutMs = 1000) override;
+    bool sendCommandAndWaitResponse(const QString &command, QString &response,
+                                    WJModule targetModule = MODULE_UNKNOWN, int timeoutMs = 1000) override;
+
+    // Error handling
+    QString getLastError() const override;
+    bool hasError() const override;
+    void clearError() override;
+
+signals:
+    void commandSent(quint32 id, const QString &command);
+    void responseReceived(quint32 id, const QString &command, WJModule module, const QStringList &lines);
+    // A whole ECU message (multi-frame blocks reassembled), emitted as soon as its last line is in,
+    // ahead of responseReceived. The view is only valid during the emission.
+    void messageReceived(quint32 id, WJModule module, QByteArrayView message);
+    void requestTimedOut(quint32 id, const QString &command);
+    void queueDrained();
+    void protocolSwitched(WJProtocol protocol, bool ok, bool usedReset, qint64 elapsedMs);
+
+private slots:
+    void onLineReceived(QByteArrayView line);
+    void onPromptReceived();
+    void onFramesLost();
+    void onRequestTimeout();
+    void onDisconnected();
+
+private:
+    void dispatchNext();
+    bool sendActive();
+    ElmRequest makeRequest(const QString &command, WJModule targetModule, int timeoutMs);
+    void queueRequest(const ElmRequest &request);
+    // Active and queued requests that can't go out any more end in requestTimedOut
+    void failPending();
+    void completeActive(const QStringList &lines);
+    // Queues request itself, so an answer given while queueing isn't missed
+    bool waitForRequest(const ElmRequest &request, QStringList &lines, int timeoutMs);
+    bool isEcho(QByteArrayView line) const;
+    static bool isAdapterRequest(const ElmRequest &request);
+    static bool isEcuRequest(const ElmRequest &request);
+    static quint8 serviceOf(const ElmRequest &request);
+    // Arms the switch and returns its requests (ATTP, settings, a probe of module) for the caller to queue
+    QList<ElmRequest> beginProtocolSwitch(WJProtocol protocol, WJModule module = MODULE_UNKNOWN);
+    ElmAdapterState cachedStateFor(WJProtocol protocol) const;
+    void advanceProtocolSwitch(quint32 id, const QStringList &lines);
+    void finishProtocolSwitch(bool ok);
+    void recordLatency(const ElmRequest &request, const ElmError &error);
+    void resync();
+    void finishResync();
+
+    ConnectionManager *m_connection{};
+    QQueue<ElmRequest> m_queue;
+    ElmRequest m_active;
+    bool m_busy{false};
+    bool m_resyncing{false};    // after a timeout: waiting for the prompt of the expired request
+    bool m_rxLost{false};       // lines of the active response were dropped by the transport
+    quint32 m_nextId{1};
+    QStringList m_rxLines;
+    ElmMessageAssembler m_assembler;
+    QTimer m_timeoutTimer;
+    ElmAdapterState m_adapterState;
+    QHash<int, ElmAdapterState> m_protocolStates;
+    LatencyModel m_latency;
+    QElapsedTimer m_requestClock;
+    qint64 m_replyMs{-1};
+
+    // Protocol switch in flight
+    struct ProtocolSwitch {
+        bool active{false};
+        bool usingReset{false};
+        WJProtocol from{PROTOCOL_UNKNOWN};
+        WJProtocol target{PROTOCOL_UNKNOWN};
+        quint32 checkId{0};    // module probe on the fast path, last reset command on the fallback
+        QElapsedTimer timer;
+    };
+    ProtocolSwitch m_switch;
+
+    WJProtocol m_protocol{PROTOCOL_UNKNOWN};
+    WJModule m_module{MODULE_UNKNOWN};
+    QString m_lastResponse;
+    QString m_lastError;
+
+    static const int MAX_TRANSIENT_RETRIES = 1;
+    static const int HOST_TIMEOUT_MARGIN_MS = 250;
+    static const int RESYNC_TIMEOUT_MS = 1000;
+    static ElmInterface* theInstance_;
+};
+
+#endif // ELMINTERFACE_H
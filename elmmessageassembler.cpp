@@ -0,0 +1,198 @@
+#include "elmmessageassembler.h"
+#include "elmerror.h"
+#include "hexdecode.h"
+#include <cstring>
+
+namespace {
+
+int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    const char lower = char(c | 0x20);
+    if (lower >= 'a' && lower <= 'f') {
+        return lower - 'a' + 10;
+    }
+    return -1;
+}
+
+// One ELM line is at most ElmFrame::MAX_SIZE characters, so at most 127 bytes
+const int LINE_BYTES = 128;
+
+} // namespace
+
+void ElmMessageAssembler::reset()
+{
+    m_size = 0;
+    m_expected = -1;
+    m_nextIndex = 0;
+    m_canId = -1;
+    m_lineBlock = false;
+    m_complete = false;
+}
+
+void ElmMessageAssembler::expectRecord(bool kwp, quint8 sid, int length)
+{
+    m_kwp = kwp;
+    m_recordSid = sid;
+    m_recordLength = length;
+}
+
+ElmMessageAssembler::Status ElmMessageAssembler::feed(QByteArrayView line)
+{
+    line = line.trimmed();
+    if (line.isEmpty()) {
+        return STATUS_IGNORED;
+    }
+    if (m_complete) {
+        // Next message of the same response (another ECU, or the block after a pending reply)
+        reset();
+    }
+
+    // "014": length of the ISO-TP message that follows as indexed lines (CAN, headers off)
+    if (line.size() == 3 && hexDigit(line[0]) >= 0 && hexDigit(line[1]) >= 0 && hexDigit(line[2]) >= 0) {
+        m_canId = -1;
+        return startMessage(hexDigit(line[0]) << 8 | hexDigit(line[1]) << 4 | hexDigit(line[2]));
+    }
+
+    quint8 bytes[LINE_BYTES];
+
+    // "1: 47 50 30 ...": indexed line of that message, the index wraps after F
+    if (line.size() >= 2 && hexDigit(line[0]) >= 0 && line[1] == ':') {
+        if (m_expected < 0 || hexDigit(line[0]) != (m_nextIndex & 0xF)) {
+            reset();
+            return STATUS_ERROR;
+        }
+        const HexDecode::Result decoded = HexDecode::decode(line.sliced(2), bytes, LINE_BYTES);
+        if (!decoded.isValid() || decoded.canId >= 0) {
+            reset();
+            return STATUS_ERROR;
+        }
+        ++m_nextIndex;
+        return append(bytes, decoded.size);
+    }
+
+    const HexDecode::Result decoded = HexDecode::decode(line, bytes, LINE_BYTES);
+    if (!decoded.isValid() || decoded.size == 0) {
+        // NO DATA, SEARCHING..., ATRV voltage and other adapter text
+        return STATUS_IGNORED;
+    }
+
+    // CAN with headers on: the PCI byte after the id says which ISO-TP frame this is
+    if (decoded.canId >= 0) {
+        const int length = bytes[0] & 0x0F;
+        switch (bytes[0] >> 4) {
+        case 0x0:   // single frame, the rest is padding
+            if (length == 0 || length > decoded.size - 1) {
+                return STATUS_ERROR;
+            }
+            m_canId = decoded.canId;
+            startMessage(length);
+            return append(bytes + 1, length);
+        case 0x1:   // first frame: 12-bit length, then the first data bytes
+            if (decoded.size < 2) {
+                return STATUS_ERROR;
+            }
+            m_canId = decoded.canId;
+            if (startMessage(length << 8 | bytes[1]) != STATUS_PENDING) {
+                return STATUS_ERROR;
+            }
+            m_nextIndex = 1;
+            return append(bytes + 2, decoded.size - 2);
+        case 0x2:   // consecutive frame, sequence number in the low nibble
+            if (m_expected < 0 || decoded.canId != m_canId || length != (m_nextIndex & 0xF)) {
+                reset();
+                return STATUS_ERROR;
+            }
+            ++m_nextIndex;
+            return append(bytes + 1, decoded.size - 1);
+        default:    // flow control from another node
+            return STATUS_IGNORED;
+        }
+    }
+
+    // The next line of a KWP2000 block
+    if (m_lineBlock) {
+        return append(bytes, decoded.size);
+    }
+
+    // A plain line inside an indexed block means the block was cut short
+    if (m_expected >= 0) {
+        reset();
+        return STATUS_ERROR;
+    }
+
+    // The ECU will answer later; the real reply follows on its own line
+    if (decoded.size >= 3 && bytes[0] == 0x7F && bytes[2] == ElmError::NRC_RESPONSE_PENDING) {
+        return STATUS_IGNORED;
+    }
+
+    // A block that goes on past this line
+    const int length = blockLength(bytes, decoded.size);
+    if (length > decoded.size) {
+        if (startMessage(length) != STATUS_PENDING) {
+            return STATUS_ERROR;
+        }
+        m_lineBlock = true;
+        return append(bytes, decoded.size);
+    }
+
+    std::memcpy(m_buffer, bytes, size_t(decoded.size));
+    m_size = decoded.size;
+    m_complete = true;
+    return STATUS_COMPLETE;
+}
+
+// Whole length of the KWP2000 message that starts with these bytes, 0 if not known.
+// With headers on: format byte 0x80 | length (or 0x80 and a length byte after the addresses),
+// target, source, data, checksum.
+int ElmMessageAssembler::blockLength(const quint8 *bytes, int size) const
+{
+    if (!m_kwp) {
+        return 0;
+    }
+    if ((bytes[0] & 0xC0) == 0x80 && size >= 3) {
+        const int length = bytes[0] & 0x3F;
+        if (length > 0) {
+            return 3 + length + 1;
+        }
+        return size >= 4 ? 4 + bytes[3] + 1 : 0;
+    }
+    // readDiagnosticTroubleCodesByStatus: count, then two DTC bytes and a status byte each
+    if (bytes[0] == 0x58 && size >= 2) {
+        return 2 + 3 * bytes[1];
+    }
+    if (m_recordSid != 0 && bytes[0] == m_recordSid) {
+        return m_recordLength;
+    }
+    return 0;
+}
+
+ElmMessageAssembler::Status ElmMessageAssembler::startMessage(int expected)
+{
+    m_size = 0;
+    m_nextIndex = 0;
+    m_complete = false;
+    if (expected <= 0 || expected > MAX_MESSAGE) {
+        m_expected = -1;
+        return STATUS_ERROR;
+    }
+    m_expected = expected;
+    return STATUS_PENDING;
+}
+
+ElmMessageAssembler::Status ElmMessageAssembler::append(const quint8 *bytes, int count)
+{
+    // Padding after the last frame's data is dropped
+    const int used = qMin(count, m_expected - m_size);
+    std::memcpy(m_buffer + m_size, bytes, size_t(used));
+    m_size += used;
+    if (m_size < m_expected) {
+        return STATUS_PENDING;
+    }
+    m_expected = -1;
+    m_lineBlock = false;
+    m_complete = true;
+    return STATUS_COMPLETE;
+}
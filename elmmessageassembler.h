@@ -0,0 +1,54 @@
+#ifndef ELMMESSAGEASSEMBLER_H
+#define ELMMESSAGEASSEMBLER_H
+
+#include <QByteArrayView>
+
+// Rebuilds ECU messages from ELM response lines as they arrive, before the '>' prompt.
+// CAN ISO-TP with headers off:  "014", "0: 49 02 01 31 44 34", "1: 47 50 ..."  (length, then indexed lines)
+// CAN ISO-TP with headers on:   "7E8 10 14 49 02 01 31 44 34", "7E8 21 47 50 ..." (PCI bytes)
+// KWP2000 blocks longer than one line are joined until their length is reached: from the format
+// byte with headers on ("83 F1 15 ..."), otherwise from the DTC count (58 <count>) or the record
+// length expected for the request (expectRecord).
+// J1850 / other KWP2000 / single-frame CAN: each hex line is one whole message, headers (if on) kept.
+// "7F xx 78" (response pending) is skipped so the real answer that follows becomes the message.
+class ElmMessageAssembler
+{
+public:
+    enum Status {
+        STATUS_IGNORED,    // not part of a message (text, flow control, response pending)
+        STATUS_PENDING,    // more frames to come
+        STATUS_COMPLETE,   // message() holds a whole message
+        STATUS_ERROR       // frame out of sequence; the partial message was dropped
+    };
+
+    static const int MAX_MESSAGE = 4095;   // ISO-TP first-frame length limit
+
+    void reset();
+    // What the next request returns: kwp enables block joining, sid and length describe the
+    // record (0, 0 if unknown). Kept across reset(), until the next call.
+    void expectRecord(bool kwp, quint8 sid = 0, int length = 0);
+    Status feed(QByteArrayView line);
+
+    // Valid after STATUS_COMPLETE until the next feed() or reset()
+    const quint8 *data() const { return m_buffer; }
+    int size() const { return m_size; }
+    int canId() const { return m_canId; }
+
+private:
+    Status startMessage(int expected);
+    Status append(const quint8 *bytes, int count);
+    int blockLength(const quint8 *bytes, int size) const;
+
+    quint8 m_buffer[MAX_MESSAGE];
+    int m_size{0};
+    int m_expected{-1};    // ISO-TP length in progress, -1 when no multi-frame message is open
+    int m_nextIndex{0};    // expected "N:" index or consecutive-frame sequence number (low nibble)
+    int m_canId{-1};
+    bool m_lineBlock{false};   // the open message goes on in plain hex lines (KWP2000)
+    bool m_complete{false};
+    bool m_kwp{false};
+    quint8 m_recordSid{0};
+    int m_recordLength{0};
+};
+
+#endif // ELMMESSAGEASSEMBLER_H
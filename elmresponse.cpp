@@ -0,0 +1,164 @@
+#include "elmresponse.h"
+
+namespace {
+
+bool isHexDigit(QChar c)
+{
+    const char16_t u = c.unicode();
+    return (u >= '0' && u <= '9') || (u >= 'A' && u <= 'F') || (u >= 'a' && u <= 'f');
+}
+
+// Mode bytes are only recognised in upper case ("41", not "4a")
+bool isModeByte(QChar first, QChar second)
+{
+    const char16_t u = second.unicode();
+    return first == QLatin1Char('4') && ((u >= '0' && u <= '9') || (u >= 'A' && u <= 'F'));
+}
+
+bool startsWithCan(QStringView text)
+{
+    return text.size() >= 2 && text[0] == QLatin1Char('7') && (text[1] == QLatin1Char('E') || text[1] == QLatin1Char('e'));
+}
+
+bool isLineBreak(QChar c)
+{
+    return c == QLatin1Char('>') || c == QLatin1Char('\r') || c == QLatin1Char('\n');
+}
+
+} // namespace
+
+const ElmResponse &ElmResponseParser::parse(QStringView response)
+{
+    m_result = ElmResponse();
+    classify(response);
+    return m_result;
+}
+
+void ElmResponseParser::classify(QStringView text)
+{
+    text = text.trimmed();
+
+    // One scan for the separators that pick the branch
+    bool hasSpace = false;
+    bool hasBreak = false;
+    for (QChar c : text) {
+        hasSpace |= (c == QLatin1Char(' '));
+        hasBreak |= (c == QLatin1Char('>') || c == QLatin1Char('\r'));
+    }
+
+    // Unspaced CAN ("7E8034105F"): space it as "7E8 03 41 05 5F" and continue with that
+    if (startsWithCan(text) && !hasSpace) {
+        text = spaceCanLine(text);
+        hasSpace = text.contains(QLatin1Char(' '));
+        hasBreak = text.contains(QLatin1Char('>')) || text.contains(QLatin1Char('\r'));
+    }
+
+    // CAN: id, PCI byte, then the mode byte ("7E8 03 41 0C 20 00")
+    if (startsWithCan(text) && hasSpace) {
+        int words = 0;
+        qsizetype modeStart = -1;
+        for (qsizetype i = 0; i < text.size(); ++i) {
+            if (text[i] == QLatin1Char(' ') || (i > 0 && text[i - 1] != QLatin1Char(' '))) {
+                continue;
+            }
+            // Word starts at i
+            qsizetype end = i;
+            while (end < text.size() && text[end] != QLatin1Char(' ')) {
+                ++end;
+            }
+            ++words;
+            if (modeStart < 0 && end - i == 2 && isModeByte(text[i], text[i + 1])) {
+                modeStart = i;
+            }
+        }
+
+        if (words >= 3 && modeStart >= 0) {
+            m_result.format = ElmResponse::FORMAT_CAN;
+            m_result.tokens = ElmResponse::TOKENS_WORDS;
+            m_result.header = text.first(modeStart).trimmed();
+            m_result.payload = text.sliced(modeStart);
+            return;
+        }
+    }
+
+    // Spaced, no header ("41 0C 20 00", KWP2000 and J1850)
+    if (text.size() >= 5 && isHexDigit(text[0]) && isHexDigit(text[1]) && text[2] == QLatin1Char(' ')
+        && isHexDigit(text[3]) && isHexDigit(text[4])) {
+        if (text[0] == QLatin1Char('4')) {
+            m_result.format = ElmResponse::FORMAT_SPACED;
+            m_result.tokens = ElmResponse::TOKENS_WORDS;
+            m_result.payload = text;
+            return;
+        }
+    }
+
+    // Raw, unspaced ("410C2000"), modes 1 to 6
+    if (text.size() >= 4 && isHexDigit(text[0]) && isHexDigit(text[1]) && isHexDigit(text[2]) && isHexDigit(text[3])) {
+        if (text[0] == QLatin1Char('4') && text[1] >= QLatin1Char('1') && text[1] <= QLatin1Char('6')) {
+            m_result.format = ElmResponse::FORMAT_RAW;
+            m_result.tokens = ElmResponse::TOKENS_PAIRS;
+            m_result.payload = text;
+            return;
+        }
+    }
+
+    // Several lines: join them with spaces and classify the result once more
+    if (hasBreak) {
+        m_result.multiLine = true;
+        classify(joinLines(text));
+        return;
+    }
+
+    // Anything else: the first mode byte anywhere in the text
+    if (text.size() > 4) {
+        for (qsizetype i = 0; i + 1 < text.size(); ++i) {
+            if (isModeByte(text[i], text[i + 1])) {
+                m_result.format = ElmResponse::FORMAT_SCAN;
+                m_result.tokens = ElmResponse::TOKENS_PAIRS;
+                m_result.header = text.first(i).trimmed();
+                m_result.payload = text.sliced(i);
+                return;
+            }
+        }
+    }
+
+    m_result.format = text.isEmpty() ? ElmResponse::FORMAT_EMPTY : ElmResponse::FORMAT_CHUNKS;
+    m_result.tokens = ElmResponse::TOKENS_PAIRS_TAIL;
+    m_result.payload = text;
+}
+
+QStringView ElmResponseParser::spaceCanLine(QStringView text)
+{
+    // 3-character id, then two-character chunks
+    m_spaced.clear();
+    if (text.size() >= 3) {
+        m_spaced.append(text.constData(), 3);
+        m_spaced.append(QLatin1Char(' '));
+    }
+    for (qsizetype i = 3; i < text.size(); i += 2) {
+        m_spaced.append(text[i]);
+        if (i + 1 < text.size()) {
+            m_spaced.append(text[i + 1]);
+            m_spaced.append(QLatin1Char(' '));
+        }
+    }
+    return QStringView(m_spaced.constData(), m_spaced.size()).trimmed();
+}
+
+QStringView ElmResponseParser::joinLines(QStringView text)
+{
+    // Reads from the input or m_spaced, never from m_joined itself
+    m_joined.clear();
+    qsizetype start = 0;
+    for (qsizetype i = 0; i <= text.size(); ++i) {
+        if (i == text.size() || isLineBreak(text[i])) {
+            if (i > start) {
+                const QStringView line = text.sliced(start, i - start).trimmed();
+                m_joined.append(line.constData(), line.size());
+                m_joined.append(QLatin1Char(' '));
+            }
+            start = i + 1;
+        }
+    }
+    return QStringView(m_joined.constData(), m_joined.size());
+}
@@ -0,0 +1,78 @@
+#ifndef ELMRESPONSE_H
+#define ELMRESPONSE_H
+
+#include <QStringView>
+#include <QVarLengthArray>
+
+// One ELM response classified without regexes or temporary strings.
+// header and payload are views into the input (or into the parser's buffers for
+// unspaced CAN and multi-line input) and stay valid until the parser's next parse().
+struct ElmResponse {
+    enum Format {
+        FORMAT_EMPTY,
+        FORMAT_CAN,       // "7E8 03 41 0C 20" / "7E803410C20": CAN id and PCI byte in front
+        FORMAT_SPACED,    // "41 0C 20 00": KWP2000 and J1850 lines
+        FORMAT_RAW,       // "410C2000"
+        FORMAT_SCAN,      // mode byte found further into otherwise unknown text
+        FORMAT_CHUNKS     // nothing recognised
+    };
+
+    // How the payload splits into byte tokens
+    enum Tokens {
+        TOKENS_WORDS,       // space-separated words
+        TOKENS_PAIRS,       // two-character chunks, a dangling character is dropped
+        TOKENS_PAIRS_TAIL   // two-character chunks, a dangling character is its own token
+    };
+
+    Format format{FORMAT_EMPTY};
+    Tokens tokens{TOKENS_WORDS};
+    bool multiLine{false};   // lines were joined before classifying
+    QStringView header;      // CAN id / text before the mode byte, empty if none
+    QStringView payload;     // from the mode byte on
+
+    template<typename Fn>
+    void forEachToken(Fn fn) const
+    {
+        const qsizetype size = payload.size();
+        if (tokens == TOKENS_WORDS) {
+            qsizetype start = 0;
+            for (qsizetype i = 0; i <= size; ++i) {
+                if (i == size || payload[i] == QLatin1Char(' ')) {
+                    if (i > start) {
+                        fn(payload.sliced(start, i - start));
+                    }
+                    start = i + 1;
+                }
+            }
+            return;
+        }
+
+        qsizetype i = 0;
+        for (; i + 1 < size; i += 2) {
+            fn(payload.sliced(i, 2));
+        }
+        if (tokens == TOKENS_PAIRS_TAIL && i < size) {
+            fn(payload.sliced(i, 1));
+        }
+    }
+};
+
+// Deterministic classifier behind ELM::prepareResponseToDecode.
+// Checks run in a fixed order: CAN, spaced, raw, multi-line (joined, then classified once more),
+// mode-byte scan, plain chunks.
+class ElmResponseParser
+{
+public:
+    const ElmResponse &parse(QStringView response);
+
+private:
+    void classify(QStringView text);
+    QStringView spaceCanLine(QStringView text);
+    QStringView joinLines(QStringView text);
+
+    QVarLengthArray<QChar, 256> m_spaced;
+    QVarLengthArray<QChar, 256> m_joined;
+    ElmResponse m_result;
+};
+
+#endif // ELMRESPONSE_H
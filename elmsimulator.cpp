@@ -0,0 +1,695 @@
+#include "elmsimulator.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+const int MAX_COMMAND_LENGTH = 64;
+const int MAX_REQUEST_BYTES = 7;     // ELM327 limit for J1850 and KWP data bytes
+const int MAX_REPLY_BYTES = 40;
+
+// Key the table sends (27 02 CD 46) for the seed answered to 27 01
+const quint8 SECURITY_SEED[2] = {0x5A, 0x3C};
+const quint8 SECURITY_KEY[2] = {0xCD, 0x46};
+
+// Bosch hardware number, as the EDC15 sends it for 1A 80
+const char ECU_IDENTIFICATION[] = "0281010982";
+
+// Functional OBD headers the ELM uses until ATSH
+const quint8 KWP_FUNCTIONAL_HEADER[3] = {0xC1, 0x33, 0xF1};
+const quint8 J1850_FUNCTIONAL_HEADER[3] = {0x68, 0x6A, 0xF1};
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// SAE J1850 CRC-8: polynomial 0x1D, initial 0xFF, inverted
+quint8 j1850Crc(const quint8 *data, int size)
+{
+    quint8 crc = 0xFF;
+    for (int i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? quint8((crc << 1) ^ 0x1D) : quint8(crc << 1);
+        }
+    }
+    return quint8(~crc);
+}
+
+void putWord(quint8 *out, double value)
+{
+    const int word = qBound(0, int(std::lround(value)), 0xFFFF);
+    out[0] = quint8(word >> 8);
+    out[1] = quint8(word);
+}
+
+bool isKwp(char protocol)
+{
+    return protocol == '4' || protocol == '5';
+}
+
+// The WJ modules are on J1850 VPW (2). An adapter set to PWM (1) decodes nothing on that bus,
+// so PWM requests get NO DATA like any other protocol the vehicle doesn't use.
+bool isJ1850(char protocol)
+{
+    return protocol == '2';
+}
+
+const char *protocolDescription(char protocol)
+{
+    switch (protocol) {
+    case '1': return "SAE J1850 PWM";
+    case '2': return "SAE J1850 VPW";
+    case '3': return "ISO 9141-2";
+    case '4': return "ISO 14230-4 (KWP 5BAUD)";
+    case '5': return "ISO 14230-4 (KWP FAST)";
+    case '6': return "ISO 15765-4 (CAN 11/500)";
+    case '7': return "ISO 15765-4 (CAN 29/500)";
+    case '8': return "ISO 15765-4 (CAN 11/250)";
+    case '9': return "ISO 15765-4 (CAN 29/250)";
+    default: return "AUTO";
+    }
+}
+
+} // namespace
+
+ElmSimulator::ElmSimulator(const ElmSimulatorConfig &config)
+    : m_config(config)
+{
+    reset();
+}
+
+void ElmSimulator::reset()
+{
+    m_random = m_config.seed ? m_config.seed : 1;
+    m_requests = 0;
+    m_clockMs = 0;
+    m_clearedDtcs = 0;
+    m_protocol = '0';
+    resetAdapter();
+}
+
+quint64 ElmSimulator::requestCount() const
+{
+    return m_requests;
+}
+
+void ElmSimulator::resetAdapter()
+{
+    // ATSP survives a reset (the ELM stores it), everything else returns to its default
+    m_echo = true;
+    m_linefeeds = false;
+    m_headers = false;
+    m_spaces = true;
+    m_activeProtocol = m_protocol;
+    m_headerSet = false;
+    m_busInitialized = false;
+    m_seedSent = false;
+    m_securityGranted = false;
+}
+
+ElmSimulatorReply ElmSimulator::respond(QByteArrayView command)
+{
+    ElmSimulatorReply reply;
+    ++m_requests;
+
+    // The ELM ignores spaces and case and stops at the CR
+    char line[MAX_COMMAND_LENGTH];
+    int length = 0;
+    bool tooLong = false;
+    qsizetype end = 0;
+    while (end < command.size() && command[end] != '\r') {
+        const char c = command[end++];
+        if (c == ' ' || c == '\n') {
+            continue;
+        }
+        if (length == MAX_COMMAND_LENGTH) {
+            tooLong = true;
+            continue;
+        }
+        line[length++] = (c >= 'a' && c <= 'z') ? char(c - 'a' + 'A') : c;
+    }
+
+    const QByteArray echo = m_echo ? command.first(end).toByteArray() : QByteArray();
+    int latencyMs = m_config.atLatencyMs;
+    QByteArray body;
+
+    if (tooLong) {
+        body = textLine("?");
+    } else if (length >= 2 && line[0] == 'A' && line[1] == 'T') {
+        body = handleAt(QByteArray(line + 2, length - 2), latencyMs);
+    } else if (length > 0) {
+        quint8 request[MAX_REQUEST_BYTES];
+        int size = 0;
+        bool valid = length % 2 == 0 && length / 2 <= MAX_REQUEST_BYTES;
+        for (int i = 0; valid && i < length; i += 2) {
+            const int high = hexValue(line[i]);
+            const int low = hexValue(line[i + 1]);
+            valid = high >= 0 && low >= 0;
+            request[size++] = quint8(high << 4 | low);
+        }
+        body = valid ? handleRequest(request, size, latencyMs) : textLine("?");
+    }
+
+    reply.latencyMs = latencyMs + jitter();
+    reply.bytes = finish(echo, body);
+    m_clockMs += quint64(reply.latencyMs);
+    return reply;
+}
+
+QByteArray ElmSimulator::handleAt(const QByteArray &command, int &latencyMs)
+{
+    auto is = [&command](const char *name) { return command == name; };
+    auto flag = [&command](char name, bool &value) {
+        if (command.size() == 2 && command.at(0) == name && (command.at(1) == '0' || command.at(1) == '1')) {
+            value = command.at(1) == '1';
+            return true;
+        }
+        return false;
+    };
+
+    if (is("Z") || is("WS")) {
+        resetAdapter();
+        latencyMs = is("Z") ? m_config.resetLatencyMs : m_config.resetLatencyMs / 5;
+        return textLine("") + textLine("ELM327 v1.5");
+    }
+    if (is("D")) {
+        resetAdapter();
+        return textLine("OK");
+    }
+    if (is("I")) {
+        return textLine("ELM327 v1.5");
+    }
+    if (is("@1")) {
+        return textLine("OBDII to RS232 Interpreter");
+    }
+    if (flag('E', m_echo) || flag('L', m_linefeeds) || flag('H', m_headers) || flag('S', m_spaces)) {
+        return textLine("OK");
+    }
+
+    if ((command.startsWith("SP") || command.startsWith("TP")) && command.size() >= 3) {
+        // "SP5", "SPA5": automatic with a preferred protocol searches the same way here
+        const char number = command.at(command.size() - 1);
+        if (number < '0' || number > '9' || command.size() > 4) {
+            return textLine("?");
+        }
+        if (command.size() == 4 && command.at(2) != 'A') {
+            return textLine("?");
+        }
+        m_protocol = command.size() == 4 ? '0' : number;
+        m_activeProtocol = m_protocol;
+        m_busInitialized = false;
+        m_seedSent = false;
+        m_securityGranted = false;
+        return textLine("OK");
+    }
+    if (command.startsWith("SH")) {
+        if (command.size() != 8) {
+            return textLine("?");
+        }
+        for (int i = 0; i < 3; ++i) {
+            const int high = hexValue(command.at(2 + 2 * i));
+            const int low = hexValue(command.at(3 + 2 * i));
+            if (high < 0 || low < 0) {
+                return textLine("?");
+            }
+            m_header[i] = quint8(high << 4 | low);
+        }
+        m_headerSet = true;
+        return textLine("OK");
+    }
+    if (is("FI")) {
+        if (!isKwp(m_protocol == '0' ? m_activeProtocol : m_protocol)) {
+            return textLine("?");
+        }
+        latencyMs = 3 * m_config.kwpLatencyMs;
+        if (chance(m_config.busErrorRate)) {
+            m_busInitialized = false;
+            return textLine("BUS INIT: ...ERROR");
+        }
+        m_busInitialized = true;
+        return textLine("BUS INIT: ...OK");
+    }
+    if (is("PC")) {
+        m_busInitialized = false;
+        return textLine("OK");
+    }
+    if (is("DP")) {
+        if (m_protocol == '0' && m_activeProtocol != '0') {
+            return textLine((QByteArray("AUTO, ") + protocolDescription(m_activeProtocol)).constData());
+        }
+        return textLine(protocolDescription(m_protocol));
+    }
+    if (is("DPN")) {
+        const char number[3] = {m_protocol == '0' ? 'A' : m_protocol, m_activeProtocol, '\0'};
+        return textLine(m_protocol == '0' ? number : number + 1);
+    }
+    if (is("RV")) {
+        char voltage[8];
+        std::snprintf(voltage, sizeof(voltage), "%.1fV", wave(45000, 13.9, 14.3));
+        return textLine(voltage);
+    }
+    if (is("MA")) {
+        // Monitoring runs until the next character arrives; on a quiet KWP bus nothing shows up
+        latencyMs = 100;
+        if (!isJ1850(m_activeProtocol == '0' ? m_protocol : m_activeProtocol)) {
+            return QByteArray();
+        }
+        static const quint8 BROADCAST_HEADER[3] = {0x48, 0x6B, 0x10};
+        quint8 frame[4] = {0x41, 0x0C, 0, 0};
+        putWord(frame + 2, 4 * wave(20000, 750, 2600));
+        const QByteArray line = formatEcuLine(BROADCAST_HEADER, frame, 4, false);
+        return line + line;
+    }
+
+    // Settings that change nothing observable here
+    static const char *const ACCEPTED[] = {"ST", "AT", "WM", "CAF", "M0", "M1", "R0", "R1", "IB", "KW", "SW"};
+    for (const char *prefix : ACCEPTED) {
+        if (command.startsWith(prefix)) {
+            return textLine("OK");
+        }
+    }
+    return textLine("?");
+}
+
+QByteArray ElmSimulator::handleRequest(const quint8 *request, int size, int &latencyMs)
+{
+    QByteArray body;
+
+    if (m_activeProtocol == '0') {
+        // The search finds the EDC15 when it is addressed, the J1850 modules otherwise
+        m_activeProtocol = (m_headerSet && m_header[1] == 0x15) ? '5' : '2';
+        latencyMs += 4 * m_config.kwpLatencyMs;
+        body += textLine("SEARCHING...");
+    }
+
+    const char protocol = m_activeProtocol;
+    const bool kwp = isKwp(protocol);
+    if (!kwp && !isJ1850(protocol)) {
+        latencyMs += m_config.noDataLatencyMs;
+        return body + textLine("NO DATA");
+    }
+
+    // KWP needs its bus initialized; the ELM does it on the first request
+    if (kwp && !m_busInitialized) {
+        latencyMs += 3 * m_config.kwpLatencyMs;
+        if (chance(m_config.busErrorRate)) {
+            return body + textLine("BUS INIT: ...ERROR");
+        }
+        m_busInitialized = true;
+        body += textLine("BUS INIT: ...OK");
+    }
+
+    latencyMs += kwp ? m_config.kwpLatencyMs : m_config.j1850LatencyMs;
+    if (chance(m_config.busErrorRate)) {
+        return body + textLine((nextRandom() & 1) ? "BUS ERROR" : "BUS BUSY");
+    }
+
+    const Target module = target(protocol);
+    quint8 reply[MAX_REPLY_BYTES];
+    const int replySize = module == TARGET_NONE ? 0 : ecuReply(module, request, size, reply);
+    if (replySize == 0 || chance(m_config.noDataRate)) {
+        latencyMs += m_config.noDataLatencyMs;
+        return body + textLine("NO DATA");
+    }
+
+    // Physical replies come back from the addressed module to the tester
+    const quint8 *requestHeader = m_headerSet ? m_header : (kwp ? KWP_FUNCTIONAL_HEADER : J1850_FUNCTIONAL_HEADER);
+    quint8 header[3];
+    if (kwp) {
+        header[0] = quint8(0x80 | replySize);
+        header[1] = requestHeader[2];
+        header[2] = 0x15;
+    } else if (requestHeader[1] == 0x6A) {
+        header[0] = 0x48;
+        header[1] = 0x6B;
+        header[2] = 0x10;
+    } else {
+        header[0] = requestHeader[0];
+        header[1] = requestHeader[2];
+        header[2] = requestHeader[1];
+    }
+    return body + formatEcuLine(header, reply, replySize, kwp);
+}
+
+ElmSimulator::Target ElmSimulator::target(char protocol) const
+{
+    if (isKwp(protocol)) {
+        const quint8 address = m_headerSet ? m_header[1] : KWP_FUNCTIONAL_HEADER[1];
+        return (address == 0x15 || address == 0x33) ? TARGET_EDC15 : TARGET_NONE;
+    }
+
+    switch (m_headerSet ? m_header[1] : J1850_FUNCTIONAL_HEADER[1]) {
+    case 0x18: return TARGET_TRANSMISSION;
+    case 0x10:
+    case 0x6A: return TARGET_PCM;
+    case 0x28: return TARGET_ABS;
+    default: return TARGET_NONE;
+    }
+}
+
+int ElmSimulator::ecuReply(Target module, const quint8 *request, int size, quint8 *reply)
+{
+    // Stored codes, until 04 clears them: P0380 glow plugs, P0740 TCC, C1014 ABS pump; PCM has none
+    static const quint8 DTCS[][2] = {{0, 0}, {0x03, 0x80}, {0x07, 0x40}, {0, 0}, {0x50, 0x14}};
+
+    switch (request[0]) {
+    case 0x03: {
+        const bool stored = DTCS[module][0] != 0 && !(m_clearedDtcs & (1u << module));
+        reply[0] = 0x43;
+        reply[1] = stored ? 1 : 0;
+        if (stored) {
+            reply[2] = DTCS[module][0];
+            reply[3] = DTCS[module][1];
+        }
+        return stored ? 4 : 2;
+    }
+    case 0x04:
+        m_clearedDtcs |= quint8(1u << module);
+        reply[0] = 0x44;
+        return 1;
+    default:
+        break;
+    }
+
+    const int replySize = module == TARGET_EDC15 ? engineReply(request, size, reply)
+                                                 : j1850Reply(module, request, size, reply);
+    if (replySize == 0 && module == TARGET_EDC15) {
+        // KWP negative response: service not supported
+        reply[0] = 0x7F;
+        reply[1] = request[0];
+        reply[2] = 0x11;
+        return 3;
+    }
+    return replySize;
+}
+
+int ElmSimulator::engineReply(const quint8 *request, int size, quint8 *reply)
+{
+    const quint8 sid = request[0];
+    const quint8 id = size > 1 ? request[1] : 0;
+    std::memset(reply, 0, MAX_REPLY_BYTES);
+
+    auto negative = [reply, sid](quint8 code) {
+        reply[0] = 0x7F;
+        reply[1] = sid;
+        reply[2] = code;
+        return 3;
+    };
+
+    switch (sid) {
+    case 0x81:
+        m_busInitialized = true;
+        reply[0] = 0xC1;
+        reply[1] = 0xEF;
+        reply[2] = 0x8F;
+        return 3;
+    case 0x3E:
+        reply[0] = 0x7E;
+        return 1;
+    case 0x27:
+        if (id == 0x01) {
+            m_seedSent = true;
+            reply[0] = 0x67;
+            reply[1] = 0x01;
+            reply[2] = SECURITY_SEED[0];
+            reply[3] = SECURITY_SEED[1];
+            return 4;
+        }
+        if (id == 0x02) {
+            if (!m_seedSent) {
+                return negative(0x22);   // conditions not correct
+            }
+            m_seedSent = false;
+            if (size < 4 || request[2] != SECURITY_KEY[0] || request[3] != SECURITY_KEY[1]) {
+                return negative(0x35);   // invalid key
+            }
+            m_securityGranted = true;
+            reply[0] = 0x67;
+            reply[1] = 0x02;
+            reply[2] = 0x34;
+            return 3;
+        }
+        return negative(0x12);
+    case 0x31:
+        if (id != 0x25) {
+            return negative(0x12);
+        }
+        reply[0] = 0x71;
+        reply[1] = 0x25;
+        return 2;
+    case 0x1A: {
+        if (id != 0x80) {
+            return negative(0x12);
+        }
+        const int length = int(sizeof(ECU_IDENTIFICATION)) - 1;
+        reply[0] = 0x5A;
+        reply[1] = 0x80;
+        std::memcpy(reply + 2, ECU_IDENTIFICATION, length);
+        return 2 + length;
+    }
+    case 0x21:
+        break;
+    default:
+        return 0;
+    }
+
+    // A drive: speed and throttle on slow waves, everything else follows from them
+    const double speed = wave(60000, 0, 110);
+    const double throttle = wave(9000, 5, 85);
+    const double rpm = qMin(4200.0, 760 + speed * 20 + throttle * 6);
+    const double quantity = 5 + throttle * 0.55;
+    const double coolant = qMin(88.0, 40 + m_clockMs / 2000.0);
+    const double rail = 280 + throttle * 12.5;
+
+    reply[0] = 0x61;
+    reply[1] = id;
+    switch (id) {
+    case 0x20:   // MAF actual / specified, mg per stroke
+        reply[6] = quint8(qBound(0.0, 200 + throttle * 4, 255.0) * 0.8);
+        reply[7] = quint8(qBound(0.0, 205 + throttle * 4, 255.0) * 0.8);
+        return 8;
+    case 0x12:   // rail pressure actual, 0.1 bar
+    case 0x22:   // rail pressure specified
+        putWord(reply + 10, (id == 0x12 ? rail - wave(1700, 0, 15) : rail) * 10);
+        return 12;
+    case 0x15:   // boost, mbar absolute
+        putWord(reply + 8, 1000 + throttle * 14);
+        return 10;
+    case 0x28:   // rpm, injection quantity (0.01 mg), per-cylinder corrections around 32768
+        putWord(reply + 2, rpm);
+        putWord(reply + 4, quantity * 100);
+        for (int cylinder = 0; cylinder < 5; ++cylinder) {
+            putWord(reply + 18 + 2 * cylinder, 32768 + wave(3000 + 700 * cylinder, -120, 120));
+        }
+        return 28;
+    case 0x30:   // coolant and intake air (0.1 K), pedal (0.01 %)
+        putWord(reply + 2, (coolant + 273.15) * 10);
+        putWord(reply + 4, (wave(120000, 22, 34) + 273.15) * 10);
+        putWord(reply + 14, throttle * 100);
+        return 16;
+    case 0x05:
+        putWord(reply + 2, (coolant + 273.15) * 10);
+        return 6;
+    case 0x0C:
+        putWord(reply + 2, rpm);
+        return 6;
+    case 0x0D:
+        reply[2] = quint8(speed);
+        return 6;
+    default:
+        return negative(0x12);
+    }
+}
+
+int ElmSimulator::j1850Reply(Target module, const quint8 *request, int size, quint8 *reply)
+{
+    // J1850 modules answer the first PID of a multi-PID request only
+    if (size < 2) {
+        return 0;
+    }
+    const quint8 mode = request[0];
+    const quint8 pid = request[1];
+    std::memset(reply, 0, MAX_REPLY_BYTES);
+    reply[0] = quint8(mode + 0x40);
+    reply[1] = pid;
+
+    if (mode == 0x02 && module == TARGET_PCM) {
+        return 6;   // no freeze frame stored
+    }
+    if (mode != 0x01) {
+        return 0;
+    }
+
+    const double speed = wave(60000, 0, 110);
+    const double throttle = wave(9000, 5, 85);
+    const double rpm = qMin(4200.0, 760 + speed * 20 + throttle * 6);
+    const int gear = speed < 15 ? 1 : speed < 30 ? 2 : speed < 50 ? 3 : speed < 75 ? 4 : 5;
+    static const double RATIOS[] = {0, 3.59, 2.19, 1.41, 1.00, 0.83};
+
+    switch (module) {
+    case TARGET_TRANSMISSION:
+        switch (pid) {
+        case 0x00:   // oil temperature +40, gear, line pressure (0.1 psi)
+            reply[3] = quint8(qMin(95.0, 30 + m_clockMs / 3000.0) + 40);
+            reply[4] = quint8(gear);
+            putWord(reply + 5, (60 + throttle * 1.2) * 10);
+            return 8;
+        case 0x0D:   // input and output shaft speed
+            putWord(reply + 2, rpm * (gear == 1 && speed < 5 ? 0.3 : 0.97));
+            putWord(reply + 4, rpm * 0.97 / RATIOS[gear]);
+            return 8;
+        case 0xA4:
+            putWord(reply + 2, RATIOS[gear] * 1000);
+            return 4;
+        case 0xA5:   // shift solenoids A / B, TCC duty
+            reply[3] = gear == 1 || gear == 4 ? 0xFF : 0;
+            reply[4] = gear >= 3 ? 0xFF : 0;
+            reply[5] = speed > 60 ? quint8(180 + wave(5000, 0, 60)) : 0;
+            return 6;
+        case 0xA6:
+            putWord(reply + 2, (60 + throttle * 1.2) * 10);
+            return 4;
+        case 0x05:
+            reply[2] = quint8(qMin(95.0, 30 + m_clockMs / 3000.0) + 40);
+            return 3;
+        default:
+            return 0;
+        }
+    case TARGET_PCM:
+        switch (pid) {
+        case 0x00:   // speed, load, barometric pressure
+            reply[3] = quint8(speed);
+            reply[4] = quint8(throttle);
+            reply[6] = 98;
+            return 8;
+        case 0x06:   // short / long term trim around 128
+            reply[3] = quint8(128 + wave(2500, -6, 6));
+            reply[4] = quint8(128 + wave(90000, -3, 3));
+            return 6;
+        case 0x14:   // narrow-band O2, 5 mV
+            reply[3] = quint8(wave(900, 20, 170));
+            reply[4] = quint8(wave(4000, 90, 140));
+            return 6;
+        case 0x0C:
+            putWord(reply + 2, rpm * 4);
+            return 4;
+        case 0x01:
+            reply[3] = 0x07;
+            reply[4] = 0x65;
+            return 6;
+        default:
+            return 0;
+        }
+    case TARGET_ABS:
+        switch (pid) {
+        case 0xA0: {  // wheel speeds, 0.1 km/h; the outer wheels run a little faster in curves
+            const double curve = wave(15000, -1.5, 1.5);
+            putWord(reply + 2, (speed + curve) * 10);
+            putWord(reply + 4, (speed - curve) * 10);
+            putWord(reply + 6, (speed + curve * 0.8) * 10);
+            putWord(reply + 8, (speed - curve * 0.8) * 10);
+            return 10;
+        }
+        case 0xA1:
+            reply[2] = throttle < 8 ? 1 : 0;   // brake switch
+            return 4;
+        case 0xA2:   // yaw rate (0.1 deg/s), lateral acceleration (0.01 m/s2), both around 32768
+            putWord(reply + 3, 32768 + wave(15000, -80, 80) * (speed / 110));
+            putWord(reply + 5, 32768 + wave(15000, -250, 250) * (speed / 110));
+            return 8;
+        default:
+            return 0;
+        }
+    default:
+        return 0;
+    }
+}
+
+QByteArray ElmSimulator::formatEcuLine(const quint8 *header, const quint8 *data, int size, bool kwp) const
+{
+    quint8 frame[3 + MAX_REPLY_BYTES + 1];
+    int length = 0;
+    if (m_headers) {
+        std::memcpy(frame, header, 3);
+        length = 3;
+    }
+    std::memcpy(frame + length, data, size);
+    length += size;
+
+    if (m_headers) {
+        // KWP checksum is the byte sum, J1850 uses its CRC; both cover the header
+        quint8 check = 0;
+        if (kwp) {
+            for (int i = 0; i < length; ++i) {
+                check = quint8(check + frame[i]);
+            }
+        } else {
+            check = j1850Crc(frame, length);
+        }
+        frame[length++] = check;
+    }
+
+    QByteArray line;
+    line.reserve(length * 3 + 2);
+    for (int i = 0; i < length; ++i) {
+        if (m_spaces && i > 0) {
+            line.append(' ');
+        }
+        line.append(HEX_DIGITS[frame[i] >> 4]);
+        line.append(HEX_DIGITS[frame[i] & 0x0F]);
+    }
+    line.append(m_linefeeds ? "\r\n" : "\r");
+    return line;
+}
+
+QByteArray ElmSimulator::textLine(const char *text) const
+{
+    QByteArray line(text);
+    line.append(m_linefeeds ? "\r\n" : "\r");
+    return line;
+}
+
+QByteArray ElmSimulator::finish(const QByteArray &echo, const QByteArray &body) const
+{
+    // "<echo>\r<lines>\r>": the blank line before the prompt ends every answer
+    QByteArray out;
+    out.reserve(echo.size() + body.size() + 4);
+    if (!echo.isEmpty()) {
+        out.append(echo);
+        out.append('\r');
+    }
+    out.append(body);
+    out.append(m_linefeeds ? "\r\n>" : "\r>");
+    return out;
+}
+
+quint32 ElmSimulator::nextRandom()
+{
+    // xorshift32: cheap and reproducible from the seed
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+    return m_random;
+}
+
+bool ElmSimulator::chance(double rate)
+{
+    return rate > 0 && nextRandom() < rate * 4294967296.0;
+}
+
+int ElmSimulator::jitter()
+{
+    return m_config.jitterMs > 0 ? int(nextRandom() % quint32(m_config.jitterMs + 1)) : 0;
+}
+
+double ElmSimulator::wave(double periodMs, double low, double high) const
+{
+    const double phase = 2 * 3.14159265358979 * double(m_clockMs) / periodMs;
+    return low + (high - low) * (0.5 - 0.5 * std::cos(phase));
+}
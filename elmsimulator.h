@@ -0,0 +1,88 @@
+#ifndef ELMSIMULATOR_H
+#define ELMSIMULATOR_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include "global.h"
+
+struct ElmSimulatorConfig {
+    quint32 seed{1};
+    int atLatencyMs{4};          // adapter-only commands
+    int resetLatencyMs{600};     // ATZ (ATWS answers in a fifth of that)
+    int kwpLatencyMs{45};        // EDC15 block reads
+    int j1850LatencyMs{30};      // J1850 modules
+    int jitterMs{10};            // added uniformly to every reply
+    int noDataLatencyMs{200};    // adapter timeout before NO DATA (ATST default)
+    double noDataRate{0.0};      // ECU requests answered with NO DATA
+    double busErrorRate{0.0};    // ECU requests answered with BUS ERROR / BUS BUSY
+};
+
+// Output of one command, prompt included
+struct ElmSimulatorReply {
+    QByteArray bytes;
+    int latencyMs{0};
+};
+
+// In-process ELM327 v1.5 with the WJ modules behind it: EDC15 on KWP2000 (header 81 15 F1)
+// and transmission, PCM and ABS on J1850 VPW (81 18 F1 / 81 10 F1 / 81 28 F1); J1850 PWM finds nothing.
+// Understands the AT commands of the init and switch sequences, echo, spaces, headers
+// (with format bytes and checksums) and linefeeds, and answers the requests in
+// WJCommandTable with the layouts WJDataParser decodes. Sensor values follow a drive on a
+// clock that advances by the simulated latencies, so a seed always gives the same session.
+// Plain synchronous object: a session costs microseconds, so load tests can run thousands
+// of them per second (benchmarks/simulatorload); SimulatorTransport adds the latencies on a timer.
+class ElmSimulator
+{
+public:
+    explicit ElmSimulator(const ElmSimulatorConfig &config = ElmSimulatorConfig());
+
+    // Power-on state; the random sequence restarts from the seed
+    void reset();
+
+    // One command line, with or without the CR
+    ElmSimulatorReply respond(QByteArrayView command);
+
+    quint64 requestCount() const;
+
+private:
+    enum Target : quint8 { TARGET_NONE, TARGET_EDC15, TARGET_TRANSMISSION, TARGET_PCM, TARGET_ABS };
+
+    void resetAdapter();
+    QByteArray handleAt(const QByteArray &command, int &latencyMs);
+    QByteArray handleRequest(const quint8 *request, int size, int &latencyMs);
+    int ecuReply(Target target, const quint8 *request, int size, quint8 *reply);
+    int engineReply(const quint8 *request, int size, quint8 *reply);
+    int j1850Reply(Target target, const quint8 *request, int size, quint8 *reply);
+    QByteArray formatEcuLine(const quint8 *header, const quint8 *data, int size, bool kwp) const;
+    Target target(char protocol) const;
+    QByteArray textLine(const char *text) const;
+    QByteArray finish(const QByteArray &echo, const QByteArray &body) const;
+
+    quint32 nextRandom();
+    bool chance(double rate);
+    int jitter();
+    double wave(double period, double low, double high) const;
+
+    ElmSimulatorConfig m_config;
+    quint32 m_random{1};
+    quint64 m_requests{0};
+    quint64 m_clockMs{0};        // simulated time: the sum of all latencies so far
+    quint8 m_clearedDtcs{0};     // one bit per Target
+
+    // Adapter settings
+    bool m_echo{true};
+    bool m_linefeeds{false};
+    bool m_headers{false};
+    bool m_spaces{true};
+    char m_protocol{'0'};        // as set by ATSP/ATTP, '0' = automatic
+    char m_activeProtocol{'0'};  // what the search settled on
+    quint8 m_header[3]{0, 0, 0};
+    bool m_headerSet{false};     // otherwise the protocol's functional OBD header
+    bool m_busInitialized{false};
+
+    // EDC15 session
+    bool m_seedSent{false};
+    bool m_securityGranted{false};
+};
+
+#endif // ELMSIMULATOR_H
@@ -1,9 +1,10 @@
 #include "elmtcpsocket.h"
 #include <QDebug>
 
-ElmTcpSocket::ElmTcpSocket(QObject *parent)
+ElmTcpSocket::ElmTcpSocket(QObject *parent) : QObject(parent)
 {
-
+    m_framer.setLineHandler([this](QByteArrayView line) { emit lineReceived(line); });
+    m_framer.setPromptHandler([this]() { emit promptReceived(); });
 }
 
 ElmTcpSocket::~ElmTcpSocket()
@@ -12,28 +13,23 @@ ElmTcpSocket::~ElmTcpSocket()
         delete socket;
 }
 
-void ElmTcpSocket::run()
-{
-    exec();
-}
-
 void ElmTcpSocket::connectTcp(const QString &ip, const quint16 &port)
 {
     QString msg{};
     msg.append("Connecting to Wifi " + ip + " : " + QString::number(port));
     emit stateChanged(msg);
-    QCoreApplication::processEvents();
 
+    disconnectTcp();
     this->socket = new QTcpSocket(this);
     if(socket)
     {
         connect(socket,&QTcpSocket::connected,this, &ElmTcpSocket::connected);
         connect(socket,&QTcpSocket::disconnected,this,&ElmTcpSocket::disconnected);
         connect(socket,&QTcpSocket::stateChanged,this,&ElmTcpSocket::stateChange);
-        //connect(socket,&QTcpSocket::readyRead,this,&ElmTcpSocket::readyRead);
+        connect(socket,&QTcpSocket::readyRead,this,&ElmTcpSocket::readyRead);
         connect(socket, &QTcpSocket::errorOccurred, this, &ElmTcpSocket::socketError);
+        m_framer.reset();
         socket->connectToHost(ip, port);
-        socket->waitForConnected(3000);
     }
 }
 
@@ -43,6 +39,7 @@ void ElmTcpSocket::disconnectTcp()
     {
         socket->close();
         socket->deleteLater();
+        socket = nullptr;
     }
 }
 
@@ -52,78 +49,32 @@ bool ElmTcpSocket::isConnected()
 }
 
 
-bool ElmTcpSocket::send(const QString &command)
+bool ElmTcpSocket::write(QByteArrayView data)
 {
-    if(socket->isOpen())
-    {
-        connect(socket,&QTcpSocket::readyRead,this,&ElmTcpSocket::readyRead);
-
-        QByteArray dataToSend = command.toUtf8();
-
-        if (command.isEmpty())
-        {
-            // If toWrite is empty then just send a CR char.
-            dataToSend += ('\r');
-        }
-        else
-        {
-            // Check for CR at end.
-            if (dataToSend[dataToSend.size()] != '\r')
-                dataToSend += '\r';
-        }
-
-        socket->write(dataToSend);
-        return socket->waitForBytesWritten();
-    }
-    else
-        return false;
-}
-
-bool ElmTcpSocket::sendAsync(const QString &command)
-{
-    if(socket->isOpen())
-    {
-        QByteArray dataToSend = command.toUtf8();
-
-        if (command.isEmpty())
-        {
-            // If toWrite is empty then just send a CR char.
-            dataToSend += ('\r');
-        }
-        else
-        {
-            // Check for CR at end.
-            if (dataToSend[dataToSend.size()] != '\r')
-                dataToSend += '\r';
-        }
-
-        socket->write(dataToSend);
-        return socket->waitForBytesWritten();
-    }
+    // Buffered by QTcpSocket and flushed from the event loop, never waited on
+    if(socket && socket->isOpen())
+        return socket->write(data.data(), data.size()) == data.size();
     else
         return false;
 }
 
 void ElmTcpSocket::readyRead()
 {
-    QString strData{};
-    QByteArray data = socket->readAll();
-    byteblock += data;
-
-    strData = QString::fromStdString(byteblock.toStdString());
+    if(!socket)
+        return;
 
-    if(strData.contains("\r"))
+    // Read straight into the framer ring, lines come out of its handlers
+    qint64 bytesRead = 0;
+    do
     {
-        if(!strData.isEmpty())
-        {           
-            byteblock.clear();
-            if(!strData.isEmpty())
-            {
-                disconnect(socket,&QTcpSocket::readyRead,this,&ElmTcpSocket::readyRead);
-                emit dataReceived(strData);
-            }
+        bytesRead = socket->read(m_framer.writePointer(), m_framer.writableSize());
+        if(bytesRead > 0)
+        {
+            emit bytesReceived(QByteArrayView(m_framer.writePointer(), bytesRead));
+            m_framer.commit(bytesRead);
         }
     }
+    while (bytesRead > 0);
 }
 
 void ElmTcpSocket::connected()
@@ -138,53 +89,6 @@ void ElmTcpSocket::disconnected()
     emit tcpDisconnected();
 }
 
-QString ElmTcpSocket::checkData()
-{
-    QString strData{};
-
-    if (socket->waitForReadyRead())
-    {
-        QByteArray data = socket->readAll();
-        byteblock += data;
-
-        strData = QString::fromStdString(byteblock.toStdString());
-        if(strData.contains("\r"))
-        {
-            byteblock.clear();            
-            emit dataReceived(strData);
-            return strData;
-        }
-    }
-    return strData;
-}
-
-QString ElmTcpSocket::readData(const QString &command)
-{
-    QString strData{};
-
-    if(sendAsync(command))
-    {
-        if (socket->waitForReadyRead())
-        {            
-            QByteArray data;
-            data.reserve(static_cast<qint16>(socket->bytesAvailable()));
-            data = socket->readAll();
-            byteblock += data;
-
-            strData = QString::fromStdString(byteblock.toStdString());
-            if(strData.contains("\r"))
-            {
-                byteblock.clear();
-
-                disconnect(socket,&QTcpSocket::readyRead,this,&ElmTcpSocket::readyRead);
-                emit dataReceived(strData);
-                return strData;
-            }
-        }
-    }
-    return strData;
-}
-
 QString ElmTcpSocket::statetoString(QAbstractSocket::SocketState socketState)
 {
     QString statestring;
@@ -222,6 +126,9 @@ void ElmTcpSocket::stateChange(QAbstractSocket::SocketState socketState)
 
 void ElmTcpSocket::socketError(QAbstractSocket::SocketError)
 {
+    if(!socket)
+        return;
+
     auto errorString = socket->errorString();
     emit stateChanged(errorString);
 }
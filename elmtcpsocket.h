@@ -3,30 +3,23 @@
 
 #include <QObject>
 #include <QTcpSocket>
-#include <QCoreApplication>
-#include <QThread>
+#include "elmframer.h"
 
-class ElmTcpSocket : public QThread
+class ElmTcpSocket : public QObject
 {
     Q_OBJECT
 public:
     explicit ElmTcpSocket(QObject *parent=nullptr);
     ~ElmTcpSocket();
-    void run();
-    bool send(const QString &);
-    bool sendAsync(const QString &);
-    QString readData(const QString &);
-    QString checkData();
+    bool write(QByteArrayView data);
     void connectTcp(const QString &, const quint16 &);
     void disconnectTcp();
     bool isConnected();
 
 private:
-    QTcpSocket *socket;
-    QByteArray byteblock{};
-    QString returnedData{};
+    QTcpSocket *socket{nullptr};
+    ElmFramer m_framer;
     bool m_connected{false};
-    bool m_lockDataReady{false};
     QString statetoString(QAbstractSocket::SocketState);
 
 public slots:
@@ -36,7 +29,10 @@ public slots:
     void stateChange(QAbstractSocket::SocketState);
     void socketError(QAbstractSocket::SocketError);
 signals:
-    void dataReceived(QString);
+    void lineReceived(QByteArrayView line);
+    void promptReceived();
+    // Raw chunk as read, before framing (traffic capture)
+    void bytesReceived(QByteArrayView chunk);
     void stateChanged(QString);
     void tcpConnected();
     void tcpDisconnected();
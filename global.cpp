@@ -1,6 +1,9 @@
 #include "global.h"
+#include "wjcommandtable.h"
+#include "hexdecode.h"
 #include <QRegularExpression>
 #include <QDebug>
+#include <array>
 
 // Global variables for multi-protocol communication
 QStringList runtimeCommands = {};
@@ -91,7 +94,7 @@ const QString BODY = "8148F1";
 namespace Protocols {
 const QString KWP2000_FAST = "5";
 const QString ISO_14230_4_KWP_FAST = "5";
-const QString J1850_VPW = "1";
+const QString J1850_VPW = "2";
 const int ISO_BAUD_RATE = 10400;
 const int J1850_BAUD_RATE = 10400;
 const int DEFAULT_TIMEOUT = 1000;
@@ -111,55 +114,56 @@ const QString AIRBAG = "8138F13E";
 
 // Engine (EDC15) commands - KWP2000 Fast
 namespace Engine {
-const QString START_COMMUNICATION = "81";
-const QString SECURITY_ACCESS_REQUEST = "27 01";
-const QString SECURITY_ACCESS_KEY = "27 02 CD 46";
-const QString START_DIAGNOSTIC_ROUTINE = "31 25 00";
-const QString READ_DTC = "03";
-const QString CLEAR_DTC = "04";
-const QString READ_MAF_DATA = "21 20";
-const QString READ_RAIL_PRESSURE_ACTUAL = "21 12";
-const QString READ_RAIL_PRESSURE_SPEC = "21 22";
-const QString READ_MAP_DATA = "21 15";
-const QString READ_INJECTOR_DATA = "21 28";
-const QString READ_MISC_DATA = "21 30";
-const QString READ_COOLANT_TEMP = "21 05";
-const QString READ_ENGINE_RPM = "21 0C";
-const QString READ_VEHICLE_SPEED = "21 0D";
-const QString READ_BATTERY_VOLTAGE = "ATRV";
+const QString START_COMMUNICATION = WJCommandTable::text(CMD_ENGINE_START_COMMUNICATION);
+const QString SECURITY_ACCESS_REQUEST = WJCommandTable::text(CMD_ENGINE_SECURITY_ACCESS_REQUEST);
+const QString SECURITY_ACCESS_KEY = WJCommandTable::text(CMD_ENGINE_SECURITY_ACCESS_KEY);
+const QString START_DIAGNOSTIC_ROUTINE = WJCommandTable::text(CMD_ENGINE_START_DIAGNOSTIC_ROUTINE);
+const QString READ_ECU_ID = WJCommandTable::text(CMD_ENGINE_READ_ECU_ID);
+const QString READ_DTC = WJCommandTable::text(CMD_ENGINE_READ_DTC);
+const QString CLEAR_DTC = WJCommandTable::text(CMD_ENGINE_CLEAR_DTC);
+const QString READ_MAF_DATA = WJCommandTable::text(CMD_ENGINE_READ_MAF_DATA);
+const QString READ_RAIL_PRESSURE_ACTUAL = WJCommandTable::text(CMD_ENGINE_READ_RAIL_PRESSURE_ACTUAL);
+const QString READ_RAIL_PRESSURE_SPEC = WJCommandTable::text(CMD_ENGINE_READ_RAIL_PRESSURE_SPEC);
+const QString READ_MAP_DATA = WJCommandTable::text(CMD_ENGINE_READ_MAP_DATA);
+const QString READ_INJECTOR_DATA = WJCommandTable::text(CMD_ENGINE_READ_INJECTOR_DATA);
+const QString READ_MISC_DATA = WJCommandTable::text(CMD_ENGINE_READ_MISC_DATA);
+const QString READ_COOLANT_TEMP = WJCommandTable::text(CMD_ENGINE_READ_COOLANT_TEMP);
+const QString READ_ENGINE_RPM = WJCommandTable::text(CMD_ENGINE_READ_ENGINE_RPM);
+const QString READ_VEHICLE_SPEED = WJCommandTable::text(CMD_ENGINE_READ_VEHICLE_SPEED);
+const QString READ_BATTERY_VOLTAGE = WJCommandTable::text(CMD_ENGINE_READ_BATTERY_VOLTAGE);
 } // End Engine namespace
 
 // Transmission commands - J1850 VPW
 namespace Transmission {
-const QString READ_DTC = "03";
-const QString CLEAR_DTC = "04";
-const QString READ_TRANS_DATA = "01 00";
-const QString READ_GEAR_RATIO = "01 A4";
-const QString READ_SOLENOID_STATUS = "01 A5";
-const QString READ_PRESSURE_DATA = "01 A6";
-const QString READ_TEMP_DATA = "01 05";
-const QString READ_SPEED_DATA = "01 0D";
+const QString READ_DTC = WJCommandTable::text(CMD_TRANS_READ_DTC);
+const QString CLEAR_DTC = WJCommandTable::text(CMD_TRANS_CLEAR_DTC);
+const QString READ_TRANS_DATA = WJCommandTable::text(CMD_TRANS_READ_TRANS_DATA);
+const QString READ_GEAR_RATIO = WJCommandTable::text(CMD_TRANS_READ_GEAR_RATIO);
+const QString READ_SOLENOID_STATUS = WJCommandTable::text(CMD_TRANS_READ_SOLENOID_STATUS);
+const QString READ_PRESSURE_DATA = WJCommandTable::text(CMD_TRANS_READ_PRESSURE_DATA);
+const QString READ_TEMP_DATA = WJCommandTable::text(CMD_TRANS_READ_TEMP_DATA);
+const QString READ_SPEED_DATA = WJCommandTable::text(CMD_TRANS_READ_SPEED_DATA);
 } // End Transmission namespace
 
 // PCM commands - J1850 VPW
 namespace PCM {
-const QString READ_DTC = "03";
-const QString CLEAR_DTC = "04";
-const QString READ_LIVE_DATA = "01 00";
-const QString READ_FUEL_TRIM = "01 06";
-const QString READ_O2_SENSORS = "01 14";
-const QString READ_ENGINE_DATA = "01 0C";
-const QString READ_EMISSION_DATA = "01 01";
-const QString READ_FREEZE_FRAME = "02 00";
+const QString READ_DTC = WJCommandTable::text(CMD_PCM_READ_DTC);
+const QString CLEAR_DTC = WJCommandTable::text(CMD_PCM_CLEAR_DTC);
+const QString READ_LIVE_DATA = WJCommandTable::text(CMD_PCM_READ_LIVE_DATA);
+const QString READ_FUEL_TRIM = WJCommandTable::text(CMD_PCM_READ_FUEL_TRIM);
+const QString READ_O2_SENSORS = WJCommandTable::text(CMD_PCM_READ_O2_SENSORS);
+const QString READ_ENGINE_DATA = WJCommandTable::text(CMD_PCM_READ_ENGINE_DATA);
+const QString READ_EMISSION_DATA = WJCommandTable::text(CMD_PCM_READ_EMISSION_DATA);
+const QString READ_FREEZE_FRAME = WJCommandTable::text(CMD_PCM_READ_FREEZE_FRAME);
 } // End PCM namespace
 
 // ABS commands - J1850 VPW
 namespace ABS {
-const QString READ_DTC = "03";
-const QString CLEAR_DTC = "04";
-const QString READ_WHEEL_SPEEDS = "01 A0";
-const QString READ_BRAKE_DATA = "01 A1";
-const QString READ_STABILITY_DATA = "01 A2";
+const QString READ_DTC = WJCommandTable::text(CMD_ABS_READ_DTC);
+const QString CLEAR_DTC = WJCommandTable::text(CMD_ABS_CLEAR_DTC);
+const QString READ_WHEEL_SPEEDS = WJCommandTable::text(CMD_ABS_READ_WHEEL_SPEEDS);
+const QString READ_BRAKE_DATA = WJCommandTable::text(CMD_ABS_READ_BRAKE_DATA);
+const QString READ_STABILITY_DATA = WJCommandTable::text(CMD_ABS_READ_STABILITY_DATA);
 } // End ABS namespace
 
 // Expected response prefixes
@@ -266,7 +270,7 @@ QList<WJCommand> WJCommands::getInitSequence(WJProtocol protocol) {
         commands.append(WJCommand("ATH1", "OK", "Headers on", 1000, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION, false));
         commands.append(WJCommand("ATS0", "OK", "Spaces off", 1000, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION, false));
         commands.append(WJCommand("ATST32", "OK", "Set timeout for J1850", 1000, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION, false));
-        commands.append(WJCommand("ATSP1", "OK", "Set protocol J1850 VPW", 2000, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION, true));
+        commands.append(WJCommand("ATSP2", "OK", "Set protocol J1850 VPW", 2000, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION, true));
         commands.append(WJCommand("ATDP", "J1850 VPW", "Verify protocol", 1500, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION, false));
 
         // J1850 doesn't use wakeup messages or fast init like KWP2000
@@ -276,6 +280,37 @@ QList<WJCommand> WJCommands::getInitSequence(WJProtocol protocol) {
     return commands;
 }
 
+QList<WJCommand> WJCommands::getWarmInitSequence(WJProtocol protocol, const QString& engineHeader, bool securityAccess) {
+    if (protocol != PROTOCOL_ISO_14230_4_KWP_FAST) {
+        return getInitSequence(protocol);
+    }
+
+    const QString header = engineHeader.isEmpty() ? WJ::Headers::ENGINE_EDC15 : engineHeader;
+    QList<WJCommand> commands;
+
+    // ATWS resets like ATZ but skips the LED test; the adapter answers within a second
+    commands.append(WJCommand("ATWS", "ELM327", "Warm start ELM327", 1500, protocol, MODULE_ENGINE_EDC15, true));
+    commands.append(WJCommand("ATE0", "OK", "Echo off", 1000, protocol, MODULE_ENGINE_EDC15, true));
+    commands.append(WJCommand("ATL0", "OK", "Linefeed off", 1000, protocol, MODULE_ENGINE_EDC15, true));
+    commands.append(WJCommand("ATH0", "OK", "Headers off", 1000, protocol, MODULE_ENGINE_EDC15, true));
+    commands.append(WJCommand("ATS0", "OK", "Spaces off", 1000, protocol, MODULE_ENGINE_EDC15, true));
+    commands.append(WJCommand("ATSP5", "OK", "Set protocol KWP2000 Fast", 1500, protocol, MODULE_ENGINE_EDC15, true));
+    commands.append(WJCommand("ATWM" + header + "3E", "OK", "Set wakeup message for EDC15", 1000, protocol, MODULE_ENGINE_EDC15, true));
+    commands.append(WJCommand("ATSH" + header, "OK", "Set header for EDC15", 1000, protocol, MODULE_ENGINE_EDC15, true));
+
+    // The KWP session itself can't be cached: fast init and start communication every time
+    commands.append(WJCommand("ATFI", "BUS INIT: OK", "Fast initialization", 4000, protocol, MODULE_ENGINE_EDC15, true));
+    commands.append(WJCommand("81", "C1 EF 8F", "Start communication", 3000, protocol, MODULE_ENGINE_EDC15, false));
+
+    if (securityAccess) {
+        commands.append(WJCommand("27 01", "67 01", "Security access request", 3000, protocol, MODULE_ENGINE_EDC15, false));
+        commands.append(WJCommand("27 02 CD 46", "7F 27", "Security access key", 3000, protocol, MODULE_ENGINE_EDC15, false));
+        commands.append(WJCommand("31 25 00", "71 25", "Start diagnostic routine", 3000, protocol, MODULE_ENGINE_EDC15, false));
+    }
+
+    return commands;
+}
+
 QList<WJCommand> WJCommands::getProtocolSwitchCommands(WJProtocol fromProtocol, WJProtocol toProtocol) {
     QList<WJCommand> commands;
     if (fromProtocol == toProtocol) {
@@ -293,7 +328,7 @@ QList<WJCommand> WJCommands::getProtocolSwitchCommands(WJProtocol fromProtocol,
         commands.append(WJCommand("ATH0", "OK", "Headers off for KWP", 500, PROTOCOL_ISO_14230_4_KWP_FAST, MODULE_ENGINE_EDC15));
     }
     else if (toProtocol == PROTOCOL_J1850_VPW) {
-        commands.append(WJCommand("ATSP1", "OK", "Switch to J1850 VPW", 2000, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION));
+        commands.append(WJCommand("ATSP2", "OK", "Switch to J1850 VPW", 2000, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION));
         commands.append(WJCommand("ATH1", "OK", "Headers on for J1850", 500, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION));
         commands.append(WJCommand("ATST32", "OK", "Set J1850 timeout", 500, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION));
     }
@@ -448,7 +483,7 @@ QList<WJCommand> WJCommands::getProtocolDetectionCommands() {
     commands.append(WJCommand("81", "C1", "Test engine communication", 2000, PROTOCOL_ISO_14230_4_KWP_FAST, MODULE_ENGINE_EDC15));
 
     // Try J1850 VPW (transmission/other modules)
-    commands.append(WJCommand("ATSP1", "OK", "Try J1850 VPW", 1000, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION));
+    commands.append(WJCommand("ATSP2", "OK", "Try J1850 VPW", 1000, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION));
     commands.append(WJCommand("ATSH" + WJ::Headers::TRANSMISSION, "OK", "Set transmission header for test", 500, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION));
     commands.append(WJCommand("0100", "41", "Test transmission communication", 2000, PROTOCOL_J1850_VPW, MODULE_TRANSMISSION));
 
@@ -574,34 +609,13 @@ bool isValidResponse(const QString& response, WJProtocol protocol) {
 }
 
 bool isError(const QString& response, WJProtocol protocol) {
-    if (response.isEmpty()) {
-        return false;
-    }
-
-    QString upperResponse = response.toUpper();
-
-    if (protocol == PROTOCOL_ISO_14230_4_KWP_FAST) {
-        for (const QString& error : WJ::KWP2000_ERROR_CODES) {
-            if (upperResponse.contains(error)) {
-                return true;
-            }
-        }
-    }
-    else if (protocol == PROTOCOL_J1850_VPW) {
-        for (const QString& error : WJ::J1850_ERROR_CODES) {
-            if (upperResponse.contains(error)) {
-                return true;
-            }
-        }
-    }
-
-    for (const QString& error : WJ::ALL_ERROR_CODES) {
-        if (upperResponse.contains(error)) {
-            return true;
-        }
-    }
+    // The KWP2000 and J1850 lists are subsets of ALL_ERROR_CODES, so one match covers every protocol
+    Q_UNUSED(protocol);
+    return classifyError(response).isError();
+}
 
-    return false;
+ElmError classifyError(QStringView response) {
+    return ElmErrorMatcher::getInstance().match(response);
 }
 
 QString cleanData(const QString& input, WJProtocol protocol) {
@@ -619,8 +633,26 @@ QString cleanData(const QString& input, WJProtocol protocol) {
     return cleaned;
 }
 
+int decodeHex(QStringView data, quint8 *out, int capacity) {
+    const HexDecode::Result result = HexDecode::decode(data, out, capacity);
+    return result.isValid() ? result.size : -1;
+}
+
 QList<int> parseHexBytes(const QString& data) {
     QList<int> bytes;
+
+    // Clean hex line: decode in one pass
+    quint8 decoded[256];
+    const HexDecode::Result result = HexDecode::decode(QStringView(data), decoded, int(sizeof(decoded)));
+    if (result.isValid()) {
+        bytes.reserve(result.size);
+        for (int i = 0; i < result.size; ++i) {
+            bytes.append(decoded[i]);
+        }
+        return bytes;
+    }
+
+    // Mixed text: keep the two-digit tokens only
     QStringList parts = data.split(" ", Qt::SkipEmptyParts);
 
     for (const QString& part : parts) {
@@ -840,141 +872,262 @@ QStringList getABSSpecificDTCs() {
 } // namespace WJ_DTCs
 
 // Enhanced data parser implementation
-bool WJDataParser::parseEngineMAFData(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::ENGINE_MAF)) {
-        return false;
-    }
+// Typed decoders work on the decoded response, SID first; the dispatch below checked the length
+static void decodeEngineMAF(const quint8 *b, int n, WJSensorData& sensorData) {
+    Q_UNUSED(n);
+    sensorData.engine.mafActual = b[6];
+    sensorData.engine.mafSpecified = b[7];
+    sensorData.engine.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.engine.dataValid = true;
+    sensorData.currentProtocol = PROTOCOL_ISO_14230_4_KWP_FAST;
+    sensorData.activeModule = MODULE_ENGINE_EDC15;
+}
+
+static void decodeEngineRailPressure(const quint8 *b, int n, WJSensorData& sensorData) {
+    Q_UNUSED(n);
+    int railActualRaw = WJUtils::bytesToInt16(b[10], b[11]);
+    sensorData.engine.railPressureActual = WJUtils::convertPressure(railActualRaw);
+    sensorData.engine.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.engine.dataValid = true;
+}
+
+static void decodeEngineMAP(const quint8 *b, int n, WJSensorData& sensorData) {
+    Q_UNUSED(n);
+    sensorData.engine.mapActual = WJUtils::bytesToInt16(b[8], b[9]);
+    sensorData.engine.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.engine.dataValid = true;
+}
+
+static void decodeEngineInjector(const quint8 *b, int n, WJSensorData& sensorData) {
+    sensorData.engine.engineRPM = WJUtils::bytesToInt16(b[2], b[3]);
+    sensorData.engine.injectionQuantity = WJUtils::convertPercentage(WJUtils::bytesToInt16(b[4], b[5]));
+
+    if (n >= 28) {
+        sensorData.engine.injector1Correction = (WJUtils::bytesToInt16(b[18], b[19]) - 32768) / 100.0;
+        sensorData.engine.injector2Correction = (WJUtils::bytesToInt16(b[20], b[21]) - 32768) / 100.0;
+        sensorData.engine.injector3Correction = (WJUtils::bytesToInt16(b[22], b[23]) - 32768) / 100.0;
+        sensorData.engine.injector4Correction = (WJUtils::bytesToInt16(b[24], b[25]) - 32768) / 100.0;
+        sensorData.engine.injector5Correction = (WJUtils::bytesToInt16(b[26], b[27]) - 32768) / 100.0;
+    }
+
+    sensorData.engine.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.engine.dataValid = true;
+}
+
+static void decodeEngineMisc(const quint8 *b, int n, WJSensorData& sensorData) {
+    Q_UNUSED(n);
+    sensorData.engine.coolantTemp = WJUtils::convertTemperature(WJUtils::bytesToInt16(b[2], b[3]));
+    sensorData.engine.intakeAirTemp = WJUtils::convertTemperature(WJUtils::bytesToInt16(b[4], b[5]));
+    sensorData.engine.throttlePosition = WJUtils::convertPercentage(WJUtils::bytesToInt16(b[14], b[15]));
+    sensorData.engine.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.engine.dataValid = true;
+}
+
+static void decodeTransmissionData(const quint8 *b, int n, WJSensorData& sensorData) {
+    Q_UNUSED(n);
+    sensorData.transmission.oilTemp = b[3] - 40;
+    sensorData.transmission.currentGear = b[4] & 0x0F;
+    sensorData.transmission.linePresssure = WJUtils::bytesToInt16(b[5], b[6]) * 0.1;
+    sensorData.transmission.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.transmission.dataValid = true;
+    sensorData.currentProtocol = PROTOCOL_J1850_VPW;
+    sensorData.activeModule = MODULE_TRANSMISSION;
+}
+
+static void decodeTransmissionSpeeds(const quint8 *b, int n, WJSensorData& sensorData) {
+    Q_UNUSED(n);
+    sensorData.transmission.inputSpeed = WJUtils::bytesToInt16(b[2], b[3]);
+    sensorData.transmission.outputSpeed = WJUtils::bytesToInt16(b[4], b[5]);
+    sensorData.transmission.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.transmission.dataValid = true;
+}
+
+static void decodeTransmissionSolenoids(const quint8 *b, int n, WJSensorData& sensorData) {
+    Q_UNUSED(n);
+    sensorData.transmission.shiftSolenoidA = WJUtils::convertPercentage(b[3]);
+    sensorData.transmission.shiftSolenoidB = WJUtils::convertPercentage(b[4]);
+    sensorData.transmission.tccSolenoid = WJUtils::convertPercentage(b[5]);
+    sensorData.transmission.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.transmission.dataValid = true;
+}
+
+static void decodePCMData(const quint8 *b, int n, WJSensorData& sensorData) {
+    Q_UNUSED(n);
+    sensorData.pcm.vehicleSpeed = b[3];
+    sensorData.pcm.engineLoad = WJUtils::convertPercentage(b[4]);
+    sensorData.pcm.barometricPressure = b[6];
+    sensorData.pcm.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.pcm.dataValid = true;
+    sensorData.currentProtocol = PROTOCOL_J1850_VPW;
+    sensorData.activeModule = MODULE_PCM;
+}
+
+static void decodePCMFuelTrim(const quint8 *b, int n, WJSensorData& sensorData) {
+    Q_UNUSED(n);
+    sensorData.pcm.fuelTrimST = (b[3] - 128) * 100.0 / 128.0;
+    sensorData.pcm.fuelTrimLT = (b[4] - 128) * 100.0 / 128.0;
+    sensorData.pcm.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.pcm.dataValid = true;
+}
+
+static void decodePCMO2Sensors(const quint8 *b, int n, WJSensorData& sensorData) {
+    Q_UNUSED(n);
+    sensorData.pcm.o2Sensor1 = b[3] * 0.005;
+    sensorData.pcm.o2Sensor2 = b[4] * 0.005;
+    sensorData.pcm.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.pcm.dataValid = true;
+}
+
+static void decodeABSWheelSpeeds(const quint8 *b, int n, WJSensorData& sensorData) {
+    Q_UNUSED(n);
+    sensorData.abs.wheelSpeedFL = WJUtils::bytesToInt16(b[2], b[3]) * 0.1;
+    sensorData.abs.wheelSpeedFR = WJUtils::bytesToInt16(b[4], b[5]) * 0.1;
+    sensorData.abs.wheelSpeedRL = WJUtils::bytesToInt16(b[6], b[7]) * 0.1;
+    sensorData.abs.wheelSpeedRR = WJUtils::bytesToInt16(b[8], b[9]) * 0.1;
+    sensorData.abs.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.abs.dataValid = true;
+    sensorData.currentProtocol = PROTOCOL_J1850_VPW;
+    sensorData.activeModule = MODULE_ABS;
+}
+
+static void decodeABSStability(const quint8 *b, int n, WJSensorData& sensorData) {
+    Q_UNUSED(n);
+    sensorData.abs.yawRate = (WJUtils::bytesToInt16(b[3], b[4]) - 32768) * 0.1;
+    sensorData.abs.lateralAccel = (WJUtils::bytesToInt16(b[5], b[6]) - 32768) * 0.01;
+    sensorData.abs.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+    sensorData.abs.dataValid = true;
+}
+
+typedef void (*WJDecoder)(const quint8 *bytes, int size, WJSensorData& sensorData);
+
+// Indexed by WJParserId; battery (text) and DTCs (lists) have their own entry points
+static constexpr WJDecoder WJ_DECODERS[] = {
+    nullptr,                      // PARSER_NONE
+    decodeEngineMAF,              // PARSER_ENGINE_MAF
+    decodeEngineRailPressure,     // PARSER_ENGINE_RAIL_PRESSURE
+    decodeEngineMAP,              // PARSER_ENGINE_MAP
+    decodeEngineInjector,         // PARSER_ENGINE_INJECTOR
+    decodeEngineMisc,             // PARSER_ENGINE_MISC
+    nullptr,                      // PARSER_ENGINE_BATTERY
+    decodeTransmissionData,       // PARSER_TRANS_DATA
+    decodeTransmissionSpeeds,     // PARSER_TRANS_SPEEDS
+    decodeTransmissionSolenoids,  // PARSER_TRANS_SOLENOIDS
+    decodePCMData,                // PARSER_PCM_DATA
+    decodePCMFuelTrim,            // PARSER_PCM_FUEL_TRIM
+    decodePCMO2Sensors,           // PARSER_PCM_O2_SENSORS
+    decodeABSWheelSpeeds,         // PARSER_ABS_WHEEL_SPEEDS
+    decodeABSStability,           // PARSER_ABS_STABILITY
+    nullptr,                      // PARSER_DTC
+};
+static_assert(std::size(WJ_DECODERS) == PARSER_DTC + 1, "one decoder slot per WJParserId");
 
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 8) {
-        return false;
-    }
+// (module, local id) -> command table index; each module reads its data through a single service
+static const int WJ_DISPATCH_MODULES = 16;
+static const quint8 WJ_NO_COMMAND = 0xFF;
 
-    try {
-        sensorData.engine.mafActual = bytes[6];
-        sensorData.engine.mafSpecified = bytes[7];
-        sensorData.engine.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.engine.dataValid = true;
-        sensorData.currentProtocol = PROTOCOL_ISO_14230_4_KWP_FAST;
-        sensorData.activeModule = MODULE_ENGINE_EDC15;
-        return true;
-    } catch (...) {
-        return false;
-    }
-}
+struct WJDispatchTable {
+    std::array<quint8, WJ_DISPATCH_MODULES * 256> command{};
+};
 
-bool WJDataParser::parseEngineRailPressureData(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::ENGINE_RAIL_PRESSURE)) {
-        return false;
+static constexpr WJDispatchTable buildDispatchTable() {
+    WJDispatchTable table;
+    for (quint8 &entry : table.command) {
+        entry = WJ_NO_COMMAND;
     }
-
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 12) {
-        return false;
-    }
-
-    try {
-        int railActualRaw = WJUtils::bytesToInt16(bytes[10], bytes[11]);
-        sensorData.engine.railPressureActual = WJUtils::convertPressure(railActualRaw);
-        sensorData.engine.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.engine.dataValid = true;
-        return true;
-    } catch (...) {
-        return false;
+    for (const WJCommandDescriptor &d : WJCommandTable::TABLE) {
+        if (WJ_DECODERS[d.parser] && d.requestLength >= 2) {
+            table.command[d.module * 256 + d.request[1]] = quint8(d.id);
+        }
     }
+    return table;
 }
 
-bool WJDataParser::parseEngineMAPData(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::ENGINE_RAIL_PRESSURE)) {
-        return false;
+static constexpr bool dispatchIsUnambiguous() {
+    for (const WJCommandDescriptor &a : WJCommandTable::TABLE) {
+        for (const WJCommandDescriptor &b : WJCommandTable::TABLE) {
+            if (a.id < b.id && WJ_DECODERS[a.parser] && WJ_DECODERS[b.parser]
+                && a.module == b.module && a.request[1] == b.request[1]) {
+                return false;
+            }
+        }
     }
+    return true;
+}
 
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 10) {
-        return false;
-    }
+static constexpr WJDispatchTable WJ_DISPATCH = buildDispatchTable();
+static_assert(dispatchIsUnambiguous(), "two decoders share a (module, local id) pair");
 
-    try {
-        int mapActualRaw = WJUtils::bytesToInt16(bytes[8], bytes[9]);
-        sensorData.engine.mapActual = mapActualRaw;
-        sensorData.engine.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.engine.dataValid = true;
-        return true;
-    } catch (...) {
+// Legacy single-response entry points: the response must be exactly what the command asks for
+static bool decodeAs(WJCommandId command, const QString& data, WJSensorData& sensorData) {
+    const WJCommandDescriptor &d = WJCommandTable::descriptor(command);
+    quint8 bytes[256];
+    const int size = WJUtils::decodeHex(data, bytes, int(sizeof(bytes)));
+    if (size < d.minResponseLength || size < 2 || bytes[0] != d.responseSid || bytes[1] != d.request[1]) {
         return false;
     }
+    WJ_DECODERS[d.parser](bytes, size, sensorData);
+    return true;
 }
 
-bool WJDataParser::parseEngineInjectorData(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::ENGINE_INJECTOR)) {
-        return false;
+bool WJDataParser::decode(const QString& data, WJModule module, WJSensorData& sensorData) {
+    quint8 bytes[256];
+    const int size = WJUtils::decodeHex(data, bytes, int(sizeof(bytes)));
+    if (size < 0) {
+        // Not hex: the only text answer is the adapter's ATRV ("12.4V")
+        return module == MODULE_ENGINE_EDC15 && parseEngineBatteryVoltage(data, sensorData);
     }
+    return decode(bytes, size, module, sensorData);
+}
 
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 14) {
+bool WJDataParser::decode(const quint8 *bytes, int size, WJModule module, WJSensorData& sensorData) {
+    if (int(module) < 0 || int(module) >= WJ_DISPATCH_MODULES) {
         return false;
     }
 
-    try {
-        int rpmRaw = WJUtils::bytesToInt16(bytes[2], bytes[3]);
-        sensorData.engine.engineRPM = rpmRaw;
-
-        int iqRaw = WJUtils::bytesToInt16(bytes[4], bytes[5]);
-        sensorData.engine.injectionQuantity = WJUtils::convertPercentage(iqRaw);
-
-        if (bytes.size() >= 28) {
-            int inj1Raw = WJUtils::bytesToInt16(bytes[18], bytes[19]);
-            sensorData.engine.injector1Correction = (inj1Raw - 32768) / 100.0;
-
-            int inj2Raw = WJUtils::bytesToInt16(bytes[20], bytes[21]);
-            sensorData.engine.injector2Correction = (inj2Raw - 32768) / 100.0;
-
-            int inj3Raw = WJUtils::bytesToInt16(bytes[22], bytes[23]);
-            sensorData.engine.injector3Correction = (inj3Raw - 32768) / 100.0;
+    // With headers on (ATH1) the SID follows 3 header bytes (J1850) or 3-4 (KWP)
+    for (int offset : {0, 3, 4}) {
+        if (size < offset + 2) {
+            break;
+        }
 
-            int inj4Raw = WJUtils::bytesToInt16(bytes[24], bytes[25]);
-            sensorData.engine.injector4Correction = (inj4Raw - 32768) / 100.0;
+        const quint8 index = WJ_DISPATCH.command[module * 256 + bytes[offset + 1]];
+        if (index == WJ_NO_COMMAND) {
+            continue;
+        }
 
-            if (bytes.size() >= 28) {
-                int inj5Raw = WJUtils::bytesToInt16(bytes[26], bytes[27]);
-                sensorData.engine.injector5Correction = (inj5Raw - 32768) / 100.0;
-            }
+        const WJCommandDescriptor &d = WJCommandTable::TABLE[index];
+        if (bytes[offset] != d.responseSid) {
+            continue;
+        }
+        // Too short at this offset: the bytes may still match at a later one
+        if (size - offset < d.minResponseLength) {
+            continue;
         }
 
-        sensorData.engine.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.engine.dataValid = true;
+        WJ_DECODERS[d.parser](bytes + offset, size - offset, sensorData);
         return true;
-    } catch (...) {
-        return false;
     }
+    return false;
 }
 
-bool WJDataParser::parseEngineMiscData(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::ENGINE_RAIL_PRESSURE)) {
-        return false;
-    }
-
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 16) {
-        return false;
-    }
+bool WJDataParser::parseEngineMAFData(const QString& data, WJSensorData& sensorData) {
+    return decodeAs(CMD_ENGINE_READ_MAF_DATA, data, sensorData);
+}
 
-    try {
-        int coolantRaw = WJUtils::bytesToInt16(bytes[2], bytes[3]);
-        sensorData.engine.coolantTemp = WJUtils::convertTemperature(coolantRaw);
+bool WJDataParser::parseEngineRailPressureData(const QString& data, WJSensorData& sensorData) {
+    return decodeAs(CMD_ENGINE_READ_RAIL_PRESSURE_ACTUAL, data, sensorData);
+}
 
-        int iatRaw = WJUtils::bytesToInt16(bytes[4], bytes[5]);
-        sensorData.engine.intakeAirTemp = WJUtils::convertTemperature(iatRaw);
+bool WJDataParser::parseEngineMAPData(const QString& data, WJSensorData& sensorData) {
+    return decodeAs(CMD_ENGINE_READ_MAP_DATA, data, sensorData);
+}
 
-        int tpsRaw = WJUtils::bytesToInt16(bytes[14], bytes[15]);
-        sensorData.engine.throttlePosition = WJUtils::convertPercentage(tpsRaw);
+bool WJDataParser::parseEngineInjectorData(const QString& data, WJSensorData& sensorData) {
+    return decodeAs(CMD_ENGINE_READ_INJECTOR_DATA, data, sensorData);
+}
 
-        sensorData.engine.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.engine.dataValid = true;
-        return true;
-    } catch (...) {
-        return false;
-    }
+bool WJDataParser::parseEngineMiscData(const QString& data, WJSensorData& sensorData) {
+    return decodeAs(CMD_ENGINE_READ_MISC_DATA, data, sensorData);
 }
 
 bool WJDataParser::parseEngineBatteryVoltage(const QString& data, WJSensorData& sensorData) {
@@ -1003,244 +1156,37 @@ bool WJDataParser::parseEngineBatteryVoltage(const QString& data, WJSensorData&
 
 // Transmission data parsing (J1850)
 bool WJDataParser::parseTransmissionData(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::TRANS_DATA)) {
-        return false;
-    }
-
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 8) {
-        return false;
-    }
-
-    try {
-        if (bytes.size() > 3) {
-            int tempRaw = bytes[3];
-            sensorData.transmission.oilTemp = tempRaw - 40;
-        }
-
-        if (bytes.size() > 4) {
-            sensorData.transmission.currentGear = bytes[4] & 0x0F;
-        }
-
-        if (bytes.size() > 6) {
-            int pressureRaw = WJUtils::bytesToInt16(bytes[5], bytes[6]);
-            sensorData.transmission.linePresssure = pressureRaw * 0.1;
-        }
-
-        sensorData.transmission.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.transmission.dataValid = true;
-        sensorData.currentProtocol = PROTOCOL_J1850_VPW;
-        sensorData.activeModule = MODULE_TRANSMISSION;
-        return true;
-    } catch (...) {
-        return false;
-    }
+    return decodeAs(CMD_TRANS_READ_TRANS_DATA, data, sensorData);
 }
 
 bool WJDataParser::parseTransmissionSpeeds(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::TRANS_DATA)) {
-        return false;
-    }
-
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 8) {
-        return false;
-    }
-
-    try {
-        if (bytes.size() > 4) {
-            int inputSpeedRaw = WJUtils::bytesToInt16(bytes[2], bytes[3]);
-            sensorData.transmission.inputSpeed = inputSpeedRaw;
-        }
-
-        if (bytes.size() > 6) {
-            int outputSpeedRaw = WJUtils::bytesToInt16(bytes[4], bytes[5]);
-            sensorData.transmission.outputSpeed = outputSpeedRaw;
-        }
-
-        sensorData.transmission.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.transmission.dataValid = true;
-        return true;
-    } catch (...) {
-        return false;
-    }
+    return decodeAs(CMD_TRANS_READ_SPEED_DATA, data, sensorData);
 }
 
 bool WJDataParser::parseTransmissionSolenoids(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::TRANS_DATA)) {
-        return false;
-    }
-
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 6) {
-        return false;
-    }
-
-    try {
-        if (bytes.size() > 3) {
-            sensorData.transmission.shiftSolenoidA = WJUtils::convertPercentage(bytes[3]);
-        }
-
-        if (bytes.size() > 4) {
-            sensorData.transmission.shiftSolenoidB = WJUtils::convertPercentage(bytes[4]);
-        }
-
-        if (bytes.size() > 5) {
-            sensorData.transmission.tccSolenoid = WJUtils::convertPercentage(bytes[5]);
-        }
-
-        sensorData.transmission.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.transmission.dataValid = true;
-        return true;
-    } catch (...) {
-        return false;
-    }
+    return decodeAs(CMD_TRANS_READ_SOLENOID_STATUS, data, sensorData);
 }
 
 // PCM data parsing (J1850)
 bool WJDataParser::parsePCMData(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::PCM_DATA)) {
-        return false;
-    }
-
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 8) {
-        return false;
-    }
-
-    try {
-        if (bytes.size() > 3) {
-            sensorData.pcm.vehicleSpeed = bytes[3];
-        }
-
-        if (bytes.size() > 4) {
-            sensorData.pcm.engineLoad = WJUtils::convertPercentage(bytes[4]);
-        }
-
-        if (bytes.size() > 6) {
-            sensorData.pcm.barometricPressure = bytes[6];
-        }
-
-        sensorData.pcm.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.pcm.dataValid = true;
-        sensorData.currentProtocol = PROTOCOL_J1850_VPW;
-        sensorData.activeModule = MODULE_PCM;
-        return true;
-    } catch (...) {
-        return false;
-    }
+    return decodeAs(CMD_PCM_READ_LIVE_DATA, data, sensorData);
 }
 
 bool WJDataParser::parsePCMFuelTrim(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::PCM_DATA)) {
-        return false;
-    }
-
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 6) {
-        return false;
-    }
-
-    try {
-        if (bytes.size() > 3) {
-            sensorData.pcm.fuelTrimST = (bytes[3] - 128) * 100.0 / 128.0;
-        }
-
-        if (bytes.size() > 4) {
-            sensorData.pcm.fuelTrimLT = (bytes[4] - 128) * 100.0 / 128.0;
-        }
-
-        sensorData.pcm.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.pcm.dataValid = true;
-        return true;
-    } catch (...) {
-        return false;
-    }
+    return decodeAs(CMD_PCM_READ_FUEL_TRIM, data, sensorData);
 }
 
 bool WJDataParser::parsePCMO2Sensors(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::PCM_DATA)) {
-        return false;
-    }
-
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 6) {
-        return false;
-    }
-
-    try {
-        if (bytes.size() > 3) {
-            sensorData.pcm.o2Sensor1 = bytes[3] * 0.005;
-        }
-
-        if (bytes.size() > 4) {
-            sensorData.pcm.o2Sensor2 = bytes[4] * 0.005;
-        }
-
-        sensorData.pcm.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.pcm.dataValid = true;
-        return true;
-    } catch (...) {
-        return false;
-    }
+    return decodeAs(CMD_PCM_READ_O2_SENSORS, data, sensorData);
 }
 
 // ABS data parsing (J1850)
 bool WJDataParser::parseABSWheelSpeeds(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::ABS_DATA)) {
-        return false;
-    }
-
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 10) {
-        return false;
-    }
-
-    try {
-        if (bytes.size() >= 10) {
-            sensorData.abs.wheelSpeedFL = WJUtils::bytesToInt16(bytes[2], bytes[3]) * 0.1;
-            sensorData.abs.wheelSpeedFR = WJUtils::bytesToInt16(bytes[4], bytes[5]) * 0.1;
-            sensorData.abs.wheelSpeedRL = WJUtils::bytesToInt16(bytes[6], bytes[7]) * 0.1;
-            sensorData.abs.wheelSpeedRR = WJUtils::bytesToInt16(bytes[8], bytes[9]) * 0.1;
-        }
-
-        sensorData.abs.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.abs.dataValid = true;
-        sensorData.currentProtocol = PROTOCOL_J1850_VPW;
-        sensorData.activeModule = MODULE_ABS;
-        return true;
-    } catch (...) {
-        return false;
-    }
+    return decodeAs(CMD_ABS_READ_WHEEL_SPEEDS, data, sensorData);
 }
 
 bool WJDataParser::parseABSStabilityData(const QString& data, WJSensorData& sensorData) {
-    if (!data.startsWith(WJ::Responses::ABS_DATA)) {
-        return false;
-    }
-
-    QList<int> bytes = WJUtils::parseHexBytes(data);
-    if (bytes.size() < 8) {
-        return false;
-    }
-
-    try {
-        if (bytes.size() > 4) {
-            int yawRaw = WJUtils::bytesToInt16(bytes[3], bytes[4]);
-            sensorData.abs.yawRate = (yawRaw - 32768) * 0.1;
-        }
-
-        if (bytes.size() > 6) {
-            int accelRaw = WJUtils::bytesToInt16(bytes[5], bytes[6]);
-            sensorData.abs.lateralAccel = (accelRaw - 32768) * 0.01;
-        }
-
-        sensorData.abs.lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        sensorData.abs.dataValid = true;
-        return true;
-    } catch (...) {
-        return false;
-    }
+    return decodeAs(CMD_ABS_READ_STABILITY_DATA, data, sensorData);
 }
 
 // Fault code parsing for all modules
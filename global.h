@@ -6,6 +6,7 @@
 #include <QList>
 #include <QHash>
 #include <QDateTime>
+#include "elmerror.h"
 
 // Forward declarations
 class ELM;
@@ -224,6 +225,7 @@ extern const QString START_COMMUNICATION;
 extern const QString SECURITY_ACCESS_REQUEST;
 extern const QString SECURITY_ACCESS_KEY;
 extern const QString START_DIAGNOSTIC_ROUTINE;
+extern const QString READ_ECU_ID;
 extern const QString READ_DTC;
 extern const QString CLEAR_DTC;
 extern const QString READ_MAF_DATA;
@@ -323,6 +325,10 @@ namespace WJCommands {
 // Get initialization sequence for specific protocol
 QList<WJCommand> getInitSequence(WJProtocol protocol);
 
+// Reconnect to a vehicle seen before: warm start instead of ATZ, no protocol check,
+// the cached header, and security access only if it worked last time
+QList<WJCommand> getWarmInitSequence(WJProtocol protocol, const QString& engineHeader, bool securityAccess);
+
 // Get protocol switching commands
 QList<WJCommand> getProtocolSwitchCommands(WJProtocol fromProtocol, WJProtocol toProtocol);
 
@@ -364,10 +370,14 @@ QString formatDTCCode(int byte1, int byte2, WJProtocol protocol);
 bool isValidHexData(const QString& data);
 bool isValidResponse(const QString& response, WJProtocol protocol);
 bool isError(const QString& response, WJProtocol protocol);
+// Which error the response reports (NO DATA, BUS INIT, 7F with its NRC...), ELM_ERROR_NONE if none
+ElmError classifyError(QStringView response);
 
 // Data cleaning and parsing
 QString cleanData(const QString& input, WJProtocol protocol);
 QList<int> parseHexBytes(const QString& data);
+// Single pass, no allocation: "41 0D 2A" -> {0x41, 0x0D, 0x2A}. Returns the byte count, -1 if not hex
+int decodeHex(QStringView data, quint8 *out, int capacity);
 int bytesToInt16(int highByte, int lowByte);
 
 // Utility functions
@@ -397,6 +407,11 @@ QStringList getABSSpecificDTCs();
 // Enhanced data parser for multi-protocol support
 class WJDataParser {
 public:
+    // Hex-decodes once and dispatches on (module, response SID, local id) to the matching decoder.
+    // Returns false when no decoder knows the response or it is too short.
+    static bool decode(const QString& data, WJModule module, WJSensorData& sensorData);
+    static bool decode(const quint8 *bytes, int size, WJModule module, WJSensorData& sensorData);
+
     // Engine data parsing (ISO_14230_4_KWP_FAST)
     static bool parseEngineMAFData(const QString& data, WJSensorData& sensorData);
     static bool parseEngineRailPressureData(const QString& data, WJSensorData& sensorData);
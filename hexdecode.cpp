@@ -0,0 +1,279 @@
+#include "hexdecode.h"
+#include <QVarLengthArray>
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HEXDECODE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define HEXDECODE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+const int BLOCK = 16;
+
+// Classifies 16 characters: nibble value per character, bit masks of hex digits and separators
+struct Block {
+    alignas(16) quint8 nibbles[BLOCK];
+    quint32 hexMask;
+    quint32 separatorMask;
+};
+
+inline quint8 scalarNibble(char c, bool &isHex)
+{
+    isHex = true;
+    if (c >= '0' && c <= '9') {
+        return quint8(c - '0');
+    }
+    const char lower = char(c | 0x20);
+    if (lower >= 'a' && lower <= 'f') {
+        return quint8(lower - 'a' + 10);
+    }
+    isHex = false;
+    return 0;
+}
+
+inline bool isSeparator(char c)
+{
+    return c == ' ' || c == '\r' || c == '\n' || c == '\t';
+}
+
+// An odd digit count is a CAN line only when it starts like one: three digits set apart by a
+// separator ("7E8 06 41 0D"), or an ECU response id 7E8-7EF run into the data ("7E803410D2A").
+// Anything else ("61 20 0") is a truncated or corrupted line with a dangling digit.
+bool startsWithCanId(const char *text, int length)
+{
+    int i = 0;
+    while (i < length && isSeparator(text[i])) {
+        ++i;
+    }
+
+    quint8 id[3];
+    for (int n = 0; n < 3; ++n, ++i) {
+        bool isHex = false;
+        if (i >= length) {
+            return false;
+        }
+        id[n] = scalarNibble(text[i], isHex);
+        if (!isHex) {
+            return false;
+        }
+    }
+
+    if (i < length && isSeparator(text[i])) {
+        return true;
+    }
+    return i < length && id[0] == 0x7 && id[1] == 0xE && id[2] >= 0x8;
+}
+
+#if defined(HEXDECODE_SSE2)
+
+// SSE2 has only signed compares: shift the range so [lo, hi] lands at the bottom of signed char
+inline __m128i inRange(__m128i v, char lo, char hi)
+{
+    const __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8(char(-128 - lo)));
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8(char(-128 + (hi - lo + 1))));
+}
+
+inline void classify(const char *p, Block &block)
+{
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+    const __m128i digit = inRange(v, '0', '9');
+    const __m128i alpha = inRange(lower, 'a', 'f');
+    const __m128i separator = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                                        _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))),
+                                           _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                                                        _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))));
+
+    const __m128i digitValue = _mm_and_si128(digit, _mm_sub_epi8(v, _mm_set1_epi8('0')));
+    const __m128i alphaValue = _mm_and_si128(alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)));
+    _mm_store_si128(reinterpret_cast<__m128i *>(block.nibbles), _mm_or_si128(digitValue, alphaValue));
+
+    block.hexMask = quint32(_mm_movemask_epi8(_mm_or_si128(digit, alpha)));
+    block.separatorMask = quint32(_mm_movemask_epi8(separator));
+}
+
+// 16 nibbles -> 8 bytes
+inline void packPairs(const quint8 *nibbles, quint8 *out)
+{
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(nibbles));
+    const __m128i high = _mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0x00FF)), 4);
+    const __m128i low = _mm_srli_epi16(v, 8);
+    const __m128i bytes = _mm_packus_epi16(_mm_or_si128(high, low), _mm_setzero_si128());
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out), bytes);
+}
+const int PACK_NIBBLES = 16;
+
+#elif defined(HEXDECODE_NEON)
+
+inline quint32 movemask(uint8x16_t mask)
+{
+    static const uint8_t weights[BLOCK] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bits = vandq_u8(mask, vld1q_u8(weights));
+    return quint32(vaddv_u8(vget_low_u8(bits))) | (quint32(vaddv_u8(vget_high_u8(bits))) << 8);
+}
+
+inline void classify(const char *p, Block &block)
+{
+    const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+    const uint8x16_t lower = vorrq_u8(v, vdupq_n_u8(0x20));
+
+    const uint8x16_t digitValue = vsubq_u8(v, vdupq_n_u8('0'));
+    const uint8x16_t alphaValue = vsubq_u8(lower, vdupq_n_u8('a' - 10));
+    const uint8x16_t digit = vcleq_u8(digitValue, vdupq_n_u8(9));
+    const uint8x16_t alpha = vandq_u8(vcgeq_u8(alphaValue, vdupq_n_u8(10)), vcleq_u8(alphaValue, vdupq_n_u8(15)));
+    const uint8x16_t separator = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('\r'))),
+                                          vorrq_u8(vceqq_u8(v, vdupq_n_u8('\n')), vceqq_u8(v, vdupq_n_u8('\t'))));
+
+    vst1q_u8(block.nibbles, vorrq_u8(vandq_u8(digit, digitValue), vandq_u8(alpha, alphaValue)));
+    block.hexMask = movemask(vorrq_u8(digit, alpha));
+    block.separatorMask = movemask(separator);
+}
+
+// 32 nibbles -> 16 bytes
+inline void packPairs(const quint8 *nibbles, quint8 *out)
+{
+    const uint8x16x2_t pairs = vld2q_u8(nibbles);
+    vst1q_u8(out, vorrq_u8(vshlq_n_u8(pairs.val[0], 4), pairs.val[1]));
+}
+const int PACK_NIBBLES = 32;
+
+#else
+
+inline void classify(const char *p, Block &block)
+{
+    block.hexMask = 0;
+    block.separatorMask = 0;
+    for (int i = 0; i < BLOCK; ++i) {
+        bool isHex;
+        block.nibbles[i] = scalarNibble(p[i], isHex);
+        block.hexMask |= quint32(isHex) << i;
+        block.separatorMask |= quint32(isSeparator(p[i])) << i;
+    }
+}
+
+inline void packPairs(const quint8 *nibbles, quint8 *out)
+{
+    for (int i = 0; i < 8; ++i) {
+        out[i] = quint8(nibbles[2 * i] << 4 | nibbles[2 * i + 1]);
+    }
+}
+const int PACK_NIBBLES = 16;
+
+#endif
+
+} // namespace
+
+HexDecode::Result HexDecode::decode(const char *text, int length, quint8 *out, int capacity, quint64 *invalidBits)
+{
+    Result result;
+    length = qMax(0, length);
+    if (invalidBits) {
+        std::memset(invalidBits, 0, sizeof(quint64) * size_t((length + 63) / 64));
+    }
+
+    // Pass 1: classify 16 characters at a time and compact the hex digits into nibbles.
+    // Three extra nibbles leave room for a CAN header, PACK_NIBBLES for the packer's over-read.
+    const int maxNibbles = 2 * qMax(0, capacity) + 3;
+    QVarLengthArray<quint8, 512 + PACK_NIBBLES> nibbles(qMin(length, maxNibbles + 1) + PACK_NIBBLES);
+    int count = 0;
+
+    Block block;
+    for (int pos = 0; pos < length && count <= maxNibbles; pos += BLOCK) {
+        const int valid = qMin(BLOCK, length - pos);
+        if (valid == BLOCK) {
+            classify(text + pos, block);
+        } else {
+            char tail[BLOCK] = {};
+            std::memcpy(tail, text + pos, size_t(valid));
+            classify(tail, block);
+        }
+
+        const quint32 validMask = (1u << valid) - 1;
+        const quint32 hexMask = block.hexMask & validMask;
+        const quint32 invalidMask = ~(block.hexMask | block.separatorMask) & validMask;
+        if (invalidMask) {
+            result.invalid += qPopulationCount(invalidMask);
+            if (invalidBits) {
+                invalidBits[pos / 64] |= quint64(invalidMask) << (pos % 64);
+            }
+        }
+
+        if (hexMask == 0xFFFF && count + BLOCK <= nibbles.size()) {
+            // Unspaced run: no compaction needed
+            std::memcpy(nibbles.data() + count, block.nibbles, BLOCK);
+            count += BLOCK;
+        } else {
+            for (quint32 m = hexMask; m && count < nibbles.size(); m &= m - 1) {
+                nibbles[count++] = block.nibbles[qCountTrailingZeroBits(m)];
+            }
+        }
+    }
+
+    if (count > maxNibbles) {
+        count = maxNibbles;
+        result.truncated = true;
+    }
+
+    // An odd digit count means a 3-digit (11-bit) CAN id in front, or a dangling digit
+    int start = 0;
+    if ((count & 1) && count >= 3 && startsWithCanId(text, length)) {
+        result.canId = nibbles[0] << 8 | nibbles[1] << 4 | nibbles[2];
+        start = 3;
+    } else if (count & 1) {
+        result.invalid++;
+        count--;
+    }
+
+    int pairs = (count - start) / 2;
+    if (pairs > capacity) {
+        pairs = qMax(0, capacity);
+        result.truncated = true;
+    }
+
+    // Pass 2: join nibble pairs into bytes
+    const quint8 *src = nibbles.constData() + start;
+    int written = 0;
+    const int bytesPerPack = PACK_NIBBLES / 2;
+    for (; written + bytesPerPack <= pairs; written += bytesPerPack) {
+        packPairs(src + 2 * written, out + written);
+    }
+    for (; written < pairs; ++written) {
+        out[written] = quint8(src[2 * written] << 4 | src[2 * written + 1]);
+    }
+
+    result.size = pairs;
+    return result;
+}
+
+HexDecode::Result HexDecode::decode(QByteArrayView text, quint8 *out, int capacity, quint64 *invalidBits)
+{
+    return decode(text.data(), int(text.size()), out, capacity, invalidBits);
+}
+
+HexDecode::Result HexDecode::decode(QStringView text, quint8 *out, int capacity, quint64 *invalidBits)
+{
+    // Narrow to ASCII; anything wider can't be hex and becomes an invalid character
+    QVarLengthArray<char, 256> latin1(text.size());
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        const char16_t c = text[i].unicode();
+        latin1[i] = c < 0x80 ? char(c) : '\x01';
+    }
+    return decode(latin1.constData(), int(latin1.size()), out, capacity, invalidBits);
+}
+
+const char *HexDecode::implementation()
+{
+#if defined(HEXDECODE_SSE2)
+    return "sse2";
+#elif defined(HEXDECODE_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
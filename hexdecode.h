@@ -0,0 +1,33 @@
+#ifndef HEXDECODE_H
+#define HEXDECODE_H
+
+#include <QtGlobal>
+#include <QByteArrayView>
+#include <QStringView>
+
+// ASCII hex to bytes in one pass, SSE2 or NEON where available, scalar otherwise.
+// Accepts ELM lines with or without spaces ("41 0D 2A", "410D2A") and an optional
+// 11-bit CAN header in front ("7E8 03 41 0D 2A", "7E803410D2A"). Other lines with an odd
+// digit count ("61 20 0") are truncated: the last digit counts as invalid.
+namespace HexDecode {
+
+struct Result {
+    int size{0};       // bytes written to out
+    int canId{-1};     // 11-bit CAN header that was skipped, -1 if the line had none
+    int invalid{0};    // characters that are neither hex digits nor separators, plus a dangling digit
+    bool truncated{false};  // out was too small
+
+    bool isValid() const { return invalid == 0 && !truncated; }
+};
+
+// invalidBits, when given, must hold (length + 63) / 64 words; bit i marks text[i] as invalid
+Result decode(const char *text, int length, quint8 *out, int capacity, quint64 *invalidBits = nullptr);
+Result decode(QByteArrayView text, quint8 *out, int capacity, quint64 *invalidBits = nullptr);
+Result decode(QStringView text, quint8 *out, int capacity, quint64 *invalidBits = nullptr);
+
+// Name of the code path decode() uses on this build ("sse2", "neon" or "scalar")
+const char *implementation();
+
+} // namespace HexDecode
+
+#endif // HEXDECODE_H
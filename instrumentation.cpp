@@ -0,0 +1,170 @@
+#include "instrumentation.h"
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+
+Instrumentation* Instrumentation::theInstance_ = nullptr;
+
+namespace {
+
+const char *moduleKey(int module)
+{
+    switch (module) {
+    case MODULE_ENGINE_EDC15: return "engine";
+    case MODULE_TRANSMISSION: return "transmission";
+    case MODULE_PCM: return "pcm";
+    case MODULE_ABS: return "abs";
+    default: return "unknown";
+    }
+}
+
+quint32 clampUs(qint64 us)
+{
+    return quint32(qBound<qint64>(0, us, 0xFFFFFFFF));
+}
+
+QJsonObject histogramJson(const LatencyHistogram &histogram)
+{
+    QJsonObject json;
+    json["count"] = double(histogram.count());
+    json["p50"] = double(histogram.percentile(0.50));
+    json["p90"] = double(histogram.percentile(0.90));
+    json["p99"] = double(histogram.percentile(0.99));
+    json["max"] = double(histogram.max());
+    return json;
+}
+
+QJsonObject seriesJson(const Instrumentation::Series &series)
+{
+    QJsonObject json;
+    json["requests"] = double(series.requests);
+    json["replies"] = double(series.replies);
+    json["noData"] = double(series.noData);
+    json["errors"] = double(series.errors);
+    json["timeouts"] = double(series.timeouts);
+    json["retries"] = double(series.retries);
+    json["queueUs"] = histogramJson(series.queueUs);
+    json["roundTripUs"] = histogramJson(series.roundTripUs);
+    json["parseUs"] = histogramJson(series.parseUs);
+    json["uiUs"] = histogramJson(series.uiUs);
+    return json;
+}
+
+void recordOutcome(Instrumentation::Series &series, qint64 queueUs, qint64 roundTripUs,
+                   int retries, Instrumentation::Outcome outcome)
+{
+    series.requests++;
+    series.retries += quint64(retries);
+    series.queueUs.record(clampUs(queueUs));
+
+    // Only replies time the bus; NO DATA and timeouts wait out a timeout, so they only count
+    switch (outcome) {
+    case Instrumentation::OUTCOME_REPLY:
+        series.replies++;
+        series.roundTripUs.record(clampUs(roundTripUs));
+        break;
+    case Instrumentation::OUTCOME_NO_DATA:
+        series.noData++;
+        break;
+    case Instrumentation::OUTCOME_ERROR:
+        series.errors++;
+        break;
+    case Instrumentation::OUTCOME_TIMEOUT:
+        series.timeouts++;
+        break;
+    }
+}
+
+} // namespace
+
+Instrumentation *Instrumentation::getInstance()
+{
+    if (theInstance_ == nullptr)
+    {
+        theInstance_ = new Instrumentation();
+    }
+    return theInstance_;
+}
+
+Instrumentation::Instrumentation()
+{
+    m_clock.start();
+}
+
+qint64 Instrumentation::nowUs() const
+{
+    return m_clock.nsecsElapsed() / 1000;
+}
+
+Instrumentation::Series &Instrumentation::commandSeries(const QString &command)
+{
+    auto it = m_commands.find(command);
+    if (it != m_commands.end()) {
+        return it.value();
+    }
+    return m_commands[m_commands.size() < MAX_COMMANDS ? command : QStringLiteral("other")];
+}
+
+void Instrumentation::recordRequest(const QString &command, WJModule module, qint64 queueUs, qint64 roundTripUs,
+                                    int retries, Outcome outcome)
+{
+    recordOutcome(commandSeries(command), queueUs, roundTripUs, retries, outcome);
+    recordOutcome(m_modules[module], queueUs, roundTripUs, retries, outcome);
+}
+
+void Instrumentation::recordParse(const QString &command, WJModule module, qint64 parseUs)
+{
+    commandSeries(command).parseUs.record(clampUs(parseUs));
+    m_modules[module].parseUs.record(clampUs(parseUs));
+}
+
+void Instrumentation::recordUiUpdate(WJModule module, qint64 uiUs)
+{
+    m_modules[module].uiUs.record(clampUs(uiUs));
+}
+
+void Instrumentation::reset()
+{
+    m_commands.clear();
+    m_modules.clear();
+    m_sinceUs = nowUs();
+}
+
+const QHash<QString, Instrumentation::Series> &Instrumentation::commands() const
+{
+    return m_commands;
+}
+
+const QHash<int, Instrumentation::Series> &Instrumentation::modules() const
+{
+    return m_modules;
+}
+
+QJsonObject Instrumentation::toJson() const
+{
+    QJsonObject modules;
+    for (auto it = m_modules.constBegin(); it != m_modules.constEnd(); ++it) {
+        modules[moduleKey(it.key())] = seriesJson(it.value());
+    }
+
+    QJsonObject commands;
+    for (auto it = m_commands.constBegin(); it != m_commands.constEnd(); ++it) {
+        commands[it.key()] = seriesJson(it.value());
+    }
+
+    QJsonObject json;
+    json["generated"] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    json["periodUs"] = double(nowUs() - m_sinceUs);
+    json["modules"] = modules;
+    json["commands"] = commands;
+    return json;
+}
+
+bool Instrumentation::dump(const QString &path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    return file.write(QJsonDocument(toJson()).toJson()) >= 0;
+}
@@ -0,0 +1,73 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include "global.h"
+#include "latencyhistogram.h"
+
+// Where each request's time goes, per command and per module, for proving throughput
+// changes and spotting flaky adapters. Times are in microseconds, on the UI thread:
+//  - queue: enqueue() until the command is written to the adapter
+//  - round trip: written until the prompt, retries included
+//  - parse: handling the decoded message (decoder, recorder, batch split)
+//  - ui: redrawing the module's labels (MainWindow only)
+// plus counts of replies, NO DATA, other adapter errors, timeouts and retries.
+// Histograms are never decayed: the figures cover the whole session until reset().
+class Instrumentation
+{
+public:
+    enum Outcome {
+        OUTCOME_REPLY,
+        OUTCOME_NO_DATA,
+        OUTCOME_ERROR,      // any other ELM error (BUS ERROR, STOPPED, 7F ..., ?)
+        OUTCOME_TIMEOUT     // the host gave up waiting for the prompt
+    };
+
+    struct Series {
+        LatencyHistogram queueUs;
+        LatencyHistogram roundTripUs;
+        LatencyHistogram parseUs;
+        LatencyHistogram uiUs;
+        quint64 requests{0};
+        quint64 replies{0};
+        quint64 noData{0};
+        quint64 errors{0};
+        quint64 timeouts{0};
+        quint64 retries{0};
+    };
+
+    static Instrumentation* getInstance();
+
+    // Monotonic clock the timestamps passed in here are taken from
+    qint64 nowUs() const;
+
+    void recordRequest(const QString &command, WJModule module, qint64 queueUs, qint64 roundTripUs,
+                       int retries, Outcome outcome);
+    void recordParse(const QString &command, WJModule module, qint64 parseUs);
+    void recordUiUpdate(WJModule module, qint64 uiUs);
+    void reset();
+
+    const QHash<QString, Series> &commands() const;
+    const QHash<int, Series> &modules() const;   // WJModule -> series
+
+    QJsonObject toJson() const;
+    bool dump(const QString &path) const;
+
+private:
+    Instrumentation();
+    Series &commandSeries(const QString &command);
+
+    QElapsedTimer m_clock;
+    qint64 m_sinceUs{0};
+    QHash<QString, Series> m_commands;
+    QHash<int, Series> m_modules;
+
+    // Manual commands are free text; past this many keys they are counted as "other"
+    static const int MAX_COMMANDS = 128;
+    static Instrumentation* theInstance_;
+};
+
+#endif // INSTRUMENTATION_H
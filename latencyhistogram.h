@@ -0,0 +1,90 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <QtAlgorithms>
+#include <array>
+
+// Log-linear histogram: exact below 8, then 8 sub-buckets per power of two (< 12.5 % error).
+// Fixed size, no allocation, cheap enough to record on every response.
+class LatencyHistogram
+{
+public:
+    static const int SUB_BUCKETS = 8;
+    static const int BUCKET_COUNT = 30 * SUB_BUCKETS;
+
+    void record(quint32 value)
+    {
+        m_counts[bucketFor(value)]++;
+        m_total++;
+        if (value > m_max) {
+            m_max = value;
+        }
+    }
+
+    // Smallest bucket upper bound that covers the given fraction (0..1) of the samples
+    quint32 percentile(double fraction) const
+    {
+        if (m_total == 0) {
+            return 0;
+        }
+
+        const quint64 wanted = quint64(fraction * double(m_total) + 0.5);
+        quint64 seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            seen += m_counts[i];
+            if (seen >= wanted && seen > 0) {
+                return qMin(upperBound(i), m_max);
+            }
+        }
+        return m_max;
+    }
+
+    // Halve all counts so old samples fade out and the percentiles follow the ECU
+    void decay()
+    {
+        m_total = 0;
+        for (quint32 &count : m_counts) {
+            count /= 2;
+            m_total += count;
+        }
+    }
+
+    void reset()
+    {
+        m_counts.fill(0);
+        m_total = 0;
+        m_max = 0;
+    }
+
+    quint64 count() const { return m_total; }
+    quint32 max() const { return m_max; }
+
+    static int bucketFor(quint32 value)
+    {
+        if (value < quint32(SUB_BUCKETS)) {
+            return int(value);
+        }
+        const int msb = 31 - int(qCountLeadingZeroBits(value));
+        const int shift = msb - 3;
+        const int sub = int((value >> shift) & (SUB_BUCKETS - 1));
+        return (shift + 1) * SUB_BUCKETS + sub;
+    }
+
+    static quint32 upperBound(int bucket)
+    {
+        if (bucket < SUB_BUCKETS) {
+            return quint32(bucket);
+        }
+        const int shift = bucket / SUB_BUCKETS - 1;
+        const quint32 lower = quint32(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+        return lower + ((quint32(1) << shift) - 1);
+    }
+
+private:
+    std::array<quint32, BUCKET_COUNT> m_counts{};
+    quint64 m_total{0};
+    quint32 m_max{0};
+};
+
+#endif // LATENCYHISTOGRAM_H
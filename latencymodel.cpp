@@ -0,0 +1,133 @@
+#include "latencymodel.h"
+#include <cmath>
+
+quint8 LatencyModel::serviceOf(const QString &command)
+{
+    bool ok = false;
+    const quint8 service = quint8(command.trimmed().left(2).toUInt(&ok, 16));
+    return ok ? service : ANY_SERVICE;
+}
+
+quint32 LatencyModel::key(WJModule module, quint8 service)
+{
+    return (quint32(module) << 8) | service;
+}
+
+void LatencyModel::update(Entry &entry, qint64 replyMs, qint64 totalMs)
+{
+    if (entry.samples == 0) {
+        entry.ewmaReply = double(replyMs);
+        entry.ewmaTotal = double(totalMs);
+    } else {
+        entry.ewmaReply += EWMA_ALPHA * (double(replyMs) - entry.ewmaReply);
+        entry.ewmaTotal += EWMA_ALPHA * (double(totalMs) - entry.ewmaTotal);
+    }
+
+    entry.reply.record(quint32(qMax<qint64>(0, replyMs)));
+    entry.total.record(quint32(qMax<qint64>(0, totalMs)));
+    entry.samples++;
+
+    if (entry.samples % DECAY_EVERY == 0) {
+        entry.reply.decay();
+        entry.total.decay();
+    }
+}
+
+void LatencyModel::recordReply(WJModule module, quint8 service, qint64 replyMs, qint64 totalMs)
+{
+    update(m_entries[key(module, service)], replyMs, totalMs);
+    if (service != ANY_SERVICE) {
+        update(m_entries[key(module, ANY_SERVICE)], replyMs, totalMs);
+    }
+}
+
+void LatencyModel::recordMiss(WJModule module, quint8 service, qint64 waitedMs)
+{
+    Entry &entry = m_entries[key(module, service)];
+    entry.misses++;
+
+    // A host timeout means the bound was too tight; NO DATA (waitedMs 0) says nothing about speed
+    if (waitedMs > 0) {
+        entry.total.record(quint32(waitedMs));
+        m_entries[key(module, ANY_SERVICE)].total.record(quint32(waitedMs));
+    }
+}
+
+bool LatencyModel::isTrusted(WJModule module, quint8 service) const
+{
+    auto it = m_entries.constFind(key(module, service));
+    return it != m_entries.constEnd() && it->samples >= quint64(MIN_SAMPLES);
+}
+
+LatencyModel::Stats LatencyModel::stats(WJModule module, quint8 service) const
+{
+    Stats result;
+    auto it = m_entries.constFind(key(module, service));
+    if (it == m_entries.constEnd()) {
+        return result;
+    }
+
+    result.ewmaReplyMs = it->ewmaReply;
+    result.ewmaTotalMs = it->ewmaTotal;
+    result.p99ReplyMs = it->reply.percentile(0.99);
+    result.p99TotalMs = it->total.percentile(0.99);
+    result.samples = it->samples;
+    result.misses = it->misses;
+    return result;
+}
+
+int LatencyModel::hostTimeoutMs(WJModule module, quint8 service, int fallbackMs) const
+{
+    if (!isTrusted(module, service)) {
+        service = ANY_SERVICE;
+        if (!isTrusted(module, service)) {
+            return fallbackMs;
+        }
+    }
+
+    // Twice the slow tail, or the average with headroom when the tail is still thin
+    const Stats s = stats(module, service);
+    const double bound = qMax(2.0 * s.p99TotalMs, 3.0 * s.ewmaTotalMs);
+    return qMax(HOST_TIMEOUT_MIN_MS, int(std::ceil(bound)));
+}
+
+QString LatencyModel::elmTimeout(WJModule module) const
+{
+    if (!isTrusted(module)) {
+        return QString();
+    }
+
+    // The ELM waits this long for (more) replies after each request
+    const Stats s = stats(module);
+    const double waitMs = qBound(double(ELM_TIMEOUT_MIN_MS), 1.5 * s.p99ReplyMs + 8.0, double(ELM_TIMEOUT_MAX_MS));
+    int units = int(std::ceil(waitMs / 4.0));
+
+    // Round up to 2^n or 1.5 * 2^n so small drifts don't re-send ATST every cycle
+    int step = 1;
+    while (step < units && (step * 3) / 2 < units) {
+        step *= 2;
+    }
+    units = (step >= units) ? step : (step * 3) / 2;
+    units = qMin(units, 0xFF);
+
+    return QString("%1").arg(units, 2, 16, QChar('0')).toUpper();
+}
+
+void LatencyModel::seed(WJModule module, const Stats &stats)
+{
+    // MIN_SAMPLES replies at the remembered tail keep the p99 bounds where they were
+    Entry &entry = m_entries[key(module, ANY_SERVICE)];
+    entry = Entry();
+    entry.ewmaReply = stats.ewmaReplyMs;
+    entry.ewmaTotal = stats.ewmaTotalMs;
+    for (int i = 0; i < MIN_SAMPLES; ++i) {
+        entry.reply.record(stats.p99ReplyMs);
+        entry.total.record(stats.p99TotalMs);
+    }
+    entry.samples = MIN_SAMPLES;
+}
+
+void LatencyModel::clear()
+{
+    m_entries.clear();
+}
@@ -0,0 +1,69 @@
+#ifndef LATENCYMODEL_H
+#define LATENCYMODEL_H
+
+#include <QHash>
+#include <QString>
+#include "global.h"
+#include "latencyhistogram.h"
+
+// Learned response times per ECU and per service (first request byte).
+// Two figures are kept: time to the ECU's first reply line, which bounds the ELM ATST wait,
+// and time to the prompt, which bounds how long the host waits for the whole exchange.
+class LatencyModel
+{
+public:
+    struct Stats {
+        double ewmaReplyMs{0.0};
+        double ewmaTotalMs{0.0};
+        quint32 p99ReplyMs{0};
+        quint32 p99TotalMs{0};
+        quint64 samples{0};
+        quint64 misses{0};
+    };
+
+    static const quint8 ANY_SERVICE = 0xFF;
+
+    static quint8 serviceOf(const QString &command);
+
+    void recordReply(WJModule module, quint8 service, qint64 replyMs, qint64 totalMs);
+    // ELM gave up (NO DATA) or the host timed out after waitedMs
+    void recordMiss(WJModule module, quint8 service, qint64 waitedMs);
+
+    bool isTrusted(WJModule module, quint8 service = ANY_SERVICE) const;
+    Stats stats(WJModule module, quint8 service = ANY_SERVICE) const;
+
+    // Host-side timeout for one request; fallbackMs until enough samples exist
+    int hostTimeoutMs(WJModule module, quint8 service, int fallbackMs) const;
+    // ATST argument (hex, 4 ms units) for the module, empty until enough samples exist
+    QString elmTimeout(WJModule module) const;
+
+    // Starts the module from remembered stats (another session), trusted right away;
+    // live replies take over as they come in
+    void seed(WJModule module, const Stats &stats);
+
+    void clear();
+
+private:
+    struct Entry {
+        double ewmaReply{0.0};
+        double ewmaTotal{0.0};
+        LatencyHistogram reply;
+        LatencyHistogram total;
+        quint64 samples{0};
+        quint64 misses{0};
+    };
+
+    static quint32 key(WJModule module, quint8 service);
+    void update(Entry &entry, qint64 replyMs, qint64 totalMs);
+
+    QHash<quint32, Entry> m_entries;
+
+    static const int MIN_SAMPLES = 8;
+    static const int DECAY_EVERY = 256;          // halve histograms so p99 tracks recent traffic
+    static constexpr double EWMA_ALPHA = 0.125;
+    static const int ELM_TIMEOUT_MIN_MS = 20;
+    static const int ELM_TIMEOUT_MAX_MS = 1020;  // ATST FF
+    static const int HOST_TIMEOUT_MIN_MS = 100;
+};
+
+#endif // LATENCYMODEL_H
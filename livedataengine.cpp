@@ -0,0 +1,394 @@
+#include "livedataengine.h"
+#include <algorithm>
+#include "elminterface.h"
+
+LiveDataEngine::LiveDataEngine(ElmInterface *elmInterface, QObject *parent)
+    : QObject(parent)
+    , m_elm(elmInterface)
+{
+    m_rateTimer.setInterval(RATE_REPORT_INTERVAL_MS);
+    connect(&m_rateTimer, &QTimer::timeout, this, &LiveDataEngine::reportRates);
+
+    m_cycleTimer.setSingleShot(true);
+    connect(&m_cycleTimer, &QTimer::timeout, this, &LiveDataEngine::startCycle);
+
+    if (m_elm) {
+        connect(m_elm, &ElmInterface::responseReceived, this, &LiveDataEngine::onResponseReceived);
+        connect(m_elm, &ElmInterface::messageReceived, this, &LiveDataEngine::onMessageReceived);
+        connect(m_elm, &ElmInterface::requestTimedOut, this, &LiveDataEngine::onRequestTimedOut);
+    }
+
+    setSignalSet(defaultSignals());
+}
+
+QList<LiveSignal> LiveDataEngine::defaultSignals(WJModule module)
+{
+    // Weights: pressures and airflow change every combustion cycle, temperatures hardly at all
+    const QList<LiveSignal> all = {
+        {"Rail pressure",        CMD_ENGINE_READ_RAIL_PRESSURE_ACTUAL, 4, "rail"},
+        {"MAF",                  CMD_ENGINE_READ_MAF_DATA,             3, "maf"},
+        {"MAP",                  CMD_ENGINE_READ_MAP_DATA,             3, "map"},
+        {"Rail pressure (spec)", CMD_ENGINE_READ_RAIL_PRESSURE_SPEC,   1, "rail_spec"},
+        {"Injectors",            CMD_ENGINE_READ_INJECTOR_DATA,        1, "injectors"},
+        {"Engine misc",          CMD_ENGINE_READ_MISC_DATA,            1, "engine_misc"},
+        {"Battery",              CMD_ENGINE_READ_BATTERY_VOLTAGE,      1, "battery"},
+        {"Transmission",         CMD_TRANS_READ_TRANS_DATA,            2, "transmission"},
+        {"Trans speeds",         CMD_TRANS_READ_SPEED_DATA,            2, "trans_speeds"},
+        {"Solenoids",            CMD_TRANS_READ_SOLENOID_STATUS,       1, "solenoids"},
+        {"PCM live",             CMD_PCM_READ_LIVE_DATA,               2, "pcm"},
+        {"Fuel trim",            CMD_PCM_READ_FUEL_TRIM,               1, "fuel_trim"},
+        {"O2 sensors",           CMD_PCM_READ_O2_SENSORS,              1, "o2"},
+        {"Wheel speeds",         CMD_ABS_READ_WHEEL_SPEEDS,            3, "wheel_speeds"},
+        {"Stability",            CMD_ABS_READ_STABILITY_DATA,          1, "stability"},
+    };
+
+    return forModule(all, module);
+}
+
+QList<LiveSignal> LiveDataEngine::forModule(const QList<LiveSignal> &signalSet, WJModule module)
+{
+    if (module == MODULE_UNKNOWN) {
+        return signalSet;
+    }
+
+    QList<LiveSignal> selected;
+    for (const LiveSignal &signal : signalSet) {
+        if (signal.descriptor().module == module) {
+            selected.append(signal);
+        }
+    }
+    return selected;
+}
+
+bool LiveDataEngine::parseSignalSet(const QString &spec, QList<LiveSignal> &signalSet, QString &error)
+{
+    const QList<LiveSignal> known = defaultSignals();
+    if (spec.trimmed().isEmpty()) {
+        signalSet = known;
+        return true;
+    }
+
+    QList<LiveSignal> parsed;
+    for (const QString &item : spec.split(',', Qt::SkipEmptyParts)) {
+        const QString key = item.section(':', 0, 0).trimmed().toLower();
+        auto found = std::find_if(known.begin(), known.end(), [&key](const LiveSignal &signal) { return signal.key == key; });
+        if (found == known.end()) {
+            error = "Unknown signal: " + key;
+            return false;
+        }
+
+        LiveSignal signal = *found;
+        if (item.contains(':')) {
+            bool ok = false;
+            signal.weight = item.section(':', 1).trimmed().toInt(&ok);
+            if (!ok || signal.weight < 1) {
+                error = "Bad weight for " + key + ": " + item.section(':', 1).trimmed();
+                return false;
+            }
+        }
+        parsed.append(signal);
+    }
+
+    if (parsed.isEmpty()) {
+        error = "No signals selected";
+        return false;
+    }
+    signalSet = parsed;
+    return true;
+}
+
+QString LiveDataEngine::signalSetToString(const QList<LiveSignal> &signalSet)
+{
+    QStringList items;
+    for (const LiveSignal &signal : signalSet) {
+        items.append(signal.key + ":" + QString::number(signal.weight));
+    }
+    return items.join(',');
+}
+
+void LiveDataEngine::setSignalSet(const QList<LiveSignal> &signalSet)
+{
+    m_signals = signalSet;
+    m_sampleCounts = QList<int>(m_signals.size(), 0);
+    m_inFlight.clear();
+    m_batches.clear();
+    buildSchedule();
+    m_cyclePos = 0;
+}
+
+QList<LiveSignal> LiveDataEngine::signalSet() const
+{
+    return m_signals;
+}
+
+void LiveDataEngine::setMinCycleInterval(int intervalMs)
+{
+    m_minCycleIntervalMs = qMax(0, intervalMs);
+}
+
+void LiveDataEngine::start()
+{
+    if (m_running || !m_elm || m_cycle.isEmpty()) {
+        return;
+    }
+
+    m_running = true;
+    m_lastProtocol = m_elm->adapterState().protocol;
+    m_sampleCounts.fill(0);
+    m_rateClock.start();
+    m_rateTimer.start();
+    startCycle();
+}
+
+void LiveDataEngine::stop()
+{
+    m_running = false;
+    m_cycleTimer.stop();
+    m_rateTimer.stop();
+
+    // Requests already queued still complete; their results are simply not counted
+    m_inFlight.clear();
+    m_batches.clear();
+}
+
+bool LiveDataEngine::isRunning() const
+{
+    return m_running;
+}
+
+void LiveDataEngine::readOnce(WJModule module)
+{
+    if (!m_elm) {
+        return;
+    }
+
+    WJProtocol lastProtocol = m_elm->adapterState().protocol;
+    const QList<LiveSignal> selected = defaultSignals(module);
+    for (const LiveSignal &signal : selected) {
+        const WJCommandDescriptor &descriptor = signal.descriptor();
+        if (descriptor.protocol != lastProtocol) {
+            m_elm->switchProtocol(descriptor.protocol);
+            lastProtocol = descriptor.protocol;
+        }
+        m_elm->enqueue(signal.command);
+    }
+}
+
+void LiveDataEngine::setSupportedPids(const std::bitset<256> &pids)
+{
+    m_batcher.reset();
+    m_batcher.setSupported(pids);
+}
+
+bool LiveDataEngine::isBatched(quint32 id) const
+{
+    return m_batches.contains(id);
+}
+
+void LiveDataEngine::buildSchedule()
+{
+    m_cycle.clear();
+
+    // Group by protocol first, then module (one header each): one protocol switch and one ATSH per group
+    QMap<QPair<int, int>, QList<int>> groups;
+    for (int i = 0; i < m_signals.size(); ++i) {
+        const WJCommandDescriptor &descriptor = m_signals.at(i).descriptor();
+        groups[qMakePair(int(descriptor.protocol), int(descriptor.module))].append(i);
+    }
+
+    for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+        const QList<int> &members = it.value();
+
+        int totalWeight = 0;
+        for (int index : members) {
+            totalWeight += qMax(1, m_signals.at(index).weight);
+        }
+
+        // Smooth weighted round-robin: weight 3 vs 1 gives A A B A, not A A A B
+        QList<int> current(members.size(), 0);
+        for (int step = 0; step < totalWeight; ++step) {
+            int best = 0;
+            for (int k = 0; k < members.size(); ++k) {
+                current[k] += qMax(1, m_signals.at(members.at(k)).weight);
+                if (current[k] > current[best]) {
+                    best = k;
+                }
+            }
+            current[best] -= totalWeight;
+            m_cycle.append(members.at(best));
+        }
+    }
+}
+
+void LiveDataEngine::startCycle()
+{
+    if (!m_running) {
+        return;
+    }
+
+    m_cyclePos = 0;
+    m_taken = QList<bool>(m_cycle.size(), false);
+    m_cycleClock.start();
+    fillPipeline();
+}
+
+void LiveDataEngine::fillPipeline()
+{
+    // Keep a couple of requests queued so the adapter never waits on us
+    while (m_running && m_inFlight.size() < PIPELINE_DEPTH && m_cyclePos < m_cycle.size()) {
+        const int first = m_cyclePos++;
+        if (m_taken.value(first)) {
+            continue;
+        }
+
+        const int index = m_cycle.at(first);
+        const LiveSignal &signal = m_signals.at(index);
+        const WJCommandDescriptor &descriptor = signal.descriptor();
+
+        if (descriptor.protocol != m_lastProtocol) {
+            m_elm->switchProtocol(descriptor.protocol);
+            m_lastProtocol = descriptor.protocol;
+        }
+
+        const QList<int> members = takeBatch(first);
+        if (members.size() < 2) {
+            quint32 id = m_elm->enqueue(signal.command);
+            m_inFlight.insert(id, {index});
+            continue;
+        }
+
+        Batch batch;
+        batch.module = descriptor.module;
+        int timeoutMs = 0;
+        for (int member : members) {
+            const WJCommandDescriptor &d = m_signals.at(member).descriptor();
+            batch.pids.append(d.request[1]);
+            timeoutMs = qMax(timeoutMs, int(d.timeoutMs));
+        }
+
+        quint32 id = m_elm->enqueue(PidBatcher::requestFor(batch.pids), batch.module, timeoutMs);
+        m_inFlight.insert(id, members);
+        m_batches.insert(id, batch);
+    }
+
+    if (m_running && m_inFlight.isEmpty() && m_cyclePos >= m_cycle.size()) {
+        const qint64 elapsed = m_cycleClock.elapsed();
+        emit cycleCompleted(elapsed);
+
+        // Zero-delay restart still goes through the event loop
+        m_cycleTimer.start(int(qMax<qint64>(0, m_minCycleIntervalMs - elapsed)));
+    }
+}
+
+QList<int> LiveDataEngine::takeBatch(int first)
+{
+    const int index = m_cycle.at(first);
+    const WJCommandDescriptor &descriptor = m_signals.at(index).descriptor();
+    QList<int> members{index};
+    if (!PidBatcher::isBatchable(descriptor) || !m_batcher.canShare(descriptor.request[1])) {
+        return members;
+    }
+
+    // Later positions of the same group, one occurrence per PID; the rest stay where they are
+    QVector<quint8> pids{descriptor.request[1]};
+    const int limit = m_batcher.limit(descriptor.module);
+    for (int pos = first + 1; pos < m_cycle.size() && members.size() < limit; ++pos) {
+        const WJCommandDescriptor &d = m_signals.at(m_cycle.at(pos)).descriptor();
+        if (d.module != descriptor.module) {
+            break;
+        }
+        if (m_taken.at(pos) || !PidBatcher::isBatchable(d) || !m_batcher.canShare(d.request[1])
+            || pids.contains(d.request[1])) {
+            continue;
+        }
+        m_taken[pos] = true;
+        pids.append(d.request[1]);
+        members.append(m_cycle.at(pos));
+    }
+    return members;
+}
+
+void LiveDataEngine::finishRequest(quint32 id, bool sampled)
+{
+    const QList<int> indexes = m_inFlight.take(id);
+    const Batch batch = m_batches.take(id);
+
+    for (int i = 0; i < indexes.size(); ++i) {
+        // A batch counts each signal whose PID actually came back
+        const bool counted = batch.pids.isEmpty() ? sampled : batch.answered.contains(batch.pids.at(i));
+        if (counted && indexes.at(i) < m_sampleCounts.size()) {
+            m_sampleCounts[indexes.at(i)]++;
+        }
+    }
+    fillPipeline();
+}
+
+void LiveDataEngine::onResponseReceived(quint32 id, const QString &command, WJModule module, const QStringList &lines)
+{
+    Q_UNUSED(command);
+    Q_UNUSED(module);
+
+    auto it = m_inFlight.constFind(id);
+    if (it == m_inFlight.constEnd()) {
+        return;
+    }
+
+    const QString response = lines.join(' ');
+
+    // Part of the PIDs back, or none for whatever reason (NO DATA, 7F 01 12, an error):
+    // the ECU takes fewer PIDs per request
+    auto batch = m_batches.constFind(id);
+    if (batch != m_batches.constEnd()) {
+        m_batcher.learn(batch->module, batch->pids.size(), batch->answered.size());
+    }
+
+    finishRequest(id, !response.isEmpty() && !WJUtils::isError(response, m_signals.at(it->first()).descriptor().protocol));
+}
+
+void LiveDataEngine::onMessageReceived(quint32 id, WJModule module, QByteArrayView message)
+{
+    auto it = m_batches.find(id);
+    if (it == m_batches.end()) {
+        return;
+    }
+
+    Batch &batch = *it;
+    PidBatcher::split(batch.module, batch.pids, message, [&](QByteArrayView part) {
+        const quint8 pid = quint8(part.at(1));
+        if (!batch.answered.contains(pid)) {
+            batch.answered.append(pid);
+        }
+        emit pidMessageReceived(id, module, part);
+    });
+}
+
+void LiveDataEngine::onRequestTimedOut(quint32 id, const QString &command)
+{
+    Q_UNUSED(command);
+
+    // An ECU may stay silent on a request it can't take whole; one dropped with the link says nothing
+    auto batch = m_batches.constFind(id);
+    if (batch != m_batches.constEnd() && m_elm->isConnected()) {
+        m_batcher.learn(batch->module, batch->pids.size(), 0);
+    }
+
+    if (m_inFlight.contains(id)) {
+        finishRequest(id, false);
+    }
+}
+
+void LiveDataEngine::reportRates()
+{
+    const double seconds = m_rateClock.restart() / 1000.0;
+    if (seconds <= 0.0) {
+        return;
+    }
+
+    QMap<QString, double> rates;
+    for (int i = 0; i < m_signals.size(); ++i) {
+        rates.insert(m_signals.at(i).name, m_sampleCounts.at(i) / seconds);
+    }
+    m_sampleCounts.fill(0);
+
+    emit sampleRatesUpdated(rates);
+}
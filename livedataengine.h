@@ -0,0 +1,112 @@
+#ifndef LIVEDATAENGINE_H
+#define LIVEDATAENGINE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QByteArrayView>
+#include <bitset>
+#include "global.h"
+#include "pidbatcher.h"
+#include "wjcommandtable.h"
+
+class ElmInterface;
+
+// One polled request; a single response may refresh several sensor values
+struct LiveSignal {
+    QString name;
+    WJCommandId command{CMD_COUNT};
+    int weight{1};  // relative sample rate against the other signals of the same module
+    QString key;    // name in settings ("rail", "wheel_speeds", ...)
+
+    const WJCommandDescriptor &descriptor() const { return WJCommandTable::descriptor(command); }
+};
+
+// Continuous acquisition across modules.
+// Signals are grouped by (protocol, header) so each cycle switches as little as possible;
+// inside a group a smooth weighted round-robin spreads the fast signals between the slow ones.
+// Mode 01 signals that come up together in a group share one request (see PidBatcher).
+class LiveDataEngine : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LiveDataEngine(ElmInterface *elmInterface, QObject *parent = nullptr);
+
+    static QList<LiveSignal> defaultSignals(WJModule module = MODULE_UNKNOWN);
+    // Signals of one module out of a set (the whole set for MODULE_UNKNOWN)
+    static QList<LiveSignal> forModule(const QList<LiveSignal> &signalSet, WJModule module);
+
+    // User signal set from settings: comma separated keys of defaultSignals(), each with an
+    // optional ":weight", e.g. "rail:6,maf:2,wheel_speeds". Empty means defaultSignals().
+    static bool parseSignalSet(const QString &spec, QList<LiveSignal> &signalSet, QString &error);
+    static QString signalSetToString(const QList<LiveSignal> &signalSet);
+
+    void setSignalSet(const QList<LiveSignal> &signalSet);
+    QList<LiveSignal> signalSet() const;
+
+    // Minimum time per full cycle; 0 polls back-to-back
+    void setMinCycleInterval(int intervalMs);
+
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    // Single pass over the signals of one module (all modules for MODULE_UNKNOWN)
+    void readOnce(WJModule module);
+
+    // ELM support bitmaps (mode 01) of a newly connected vehicle; PIDs outside them are not batched.
+    // Also forgets the PIDs-per-request limits learned from the previous one.
+    void setSupportedPids(const std::bitset<256> &pids);
+    // Request carries several PIDs; its messages come out split through pidMessageReceived instead
+    bool isBatched(quint32 id) const;
+
+signals:
+    void cycleCompleted(qint64 elapsedMs);
+    // One "41 pid data" message per PID of a batched request, same lifetime as ElmInterface::messageReceived
+    void pidMessageReceived(quint32 id, WJModule module, QByteArrayView message);
+    void sampleRatesUpdated(const QMap<QString, double> &samplesPerSecond);
+
+private slots:
+    void onResponseReceived(quint32 id, const QString &command, WJModule module, const QStringList &lines);
+    void onMessageReceived(quint32 id, WJModule module, QByteArrayView message);
+    void onRequestTimedOut(quint32 id, const QString &command);
+    void reportRates();
+    void startCycle();
+
+private:
+    void buildSchedule();
+    void fillPipeline();
+    QList<int> takeBatch(int first);
+    void finishRequest(quint32 id, bool sampled);
+
+    ElmInterface *m_elm{};
+    QList<LiveSignal> m_signals;
+    QList<int> m_cycle;             // signal indexes in send order for one full cycle
+    int m_cyclePos{0};
+    QElapsedTimer m_cycleClock;
+    int m_minCycleIntervalMs{0};
+    bool m_running{false};
+    WJProtocol m_lastProtocol{PROTOCOL_UNKNOWN};
+
+    QMap<quint32, QList<int>> m_inFlight;   // request id -> signal indexes
+    QList<bool> m_taken;                    // cycle positions already sent inside a batch
+
+    // Request carrying several mode 01 PIDs
+    struct Batch {
+        WJModule module{MODULE_UNKNOWN};
+        QVector<quint8> pids;                // same order as the signal indexes in m_inFlight
+        QVector<quint8> answered;
+    };
+    QMap<quint32, Batch> m_batches;
+    PidBatcher m_batcher;
+    QList<int> m_sampleCounts;
+    QElapsedTimer m_rateClock;
+    QTimer m_rateTimer;
+    QTimer m_cycleTimer;
+
+    static const int PIPELINE_DEPTH = 2;
+    static const int RATE_REPORT_INTERVAL_MS = 1000;
+};
+
+#endif // LIVEDATAENGINE_H
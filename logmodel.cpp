@@ -0,0 +1,113 @@
+#include "logmodel.h"
+#include <QBrush>
+#include <QColor>
+#include <QDateTime>
+
+namespace {
+
+// One batch per frame at 60 Hz
+const int PUBLISH_INTERVAL_MS = 16;
+
+} // namespace
+
+LogModel::LogModel(QObject *parent) : QAbstractListModel(parent)
+{
+    m_publishTimer.setSingleShot(true);
+    m_publishTimer.setInterval(PUBLISH_INTERVAL_MS);
+    connect(&m_publishTimer, &QTimer::timeout, this, &LogModel::publish);
+}
+
+void LogModel::log(LogSeverity severity, LogCode code, const QString &arg, const QString &arg2)
+{
+    if (m_records.push(LogRecord{QDateTime::currentMSecsSinceEpoch(), severity, code, arg, arg2})
+        && m_evictedRows < m_publishedRows) {
+        m_evictedRows++;
+    }
+
+    if (!m_publishTimer.isActive()) {
+        m_publishTimer.start();
+    }
+}
+
+void LogModel::clear()
+{
+    beginResetModel();
+    m_records.clear();
+    m_publishedRows = 0;
+    m_evictedRows = 0;
+    endResetModel();
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_publishedRows;
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const
+{
+    // Published rows that were overwritten since are blank until publish() removes them
+    const int row = index.row() - m_evictedRows;
+    if (!index.isValid() || row < 0 || row >= int(m_records.size())) {
+        return QVariant();
+    }
+
+    const LogRecord &record = m_records.at(std::size_t(row));
+    switch (role) {
+    case Qt::DisplayRole:
+        return format(record);
+    case Qt::ForegroundRole:
+        switch (record.severity) {
+        case SEVERITY_ERROR:
+            return QBrush(QColor(0xFF, 0x55, 0x55));
+        case SEVERITY_WARNING:
+            return QBrush(QColor(0xFF, 0xC1, 0x07));
+        default:
+            return QVariant();  // the view's green
+        }
+    default:
+        return QVariant();
+    }
+}
+
+QString LogModel::format(const LogRecord &record)
+{
+    const QString timestamp = QDateTime::fromMSecsSinceEpoch(record.timestampMs).toString("hh:mm:ss");
+
+    QString message;
+    switch (record.code) {
+    case LOG_COMMAND:
+        message = "→ " + record.arg;
+        break;
+    case LOG_RESPONSE:
+        message = "← " + record.arg;
+        break;
+    case LOG_NO_RESPONSE:
+        message = "⚠️ No response to " + record.arg;
+        break;
+    case LOG_ELM_ERROR:
+        message = QString("❌ WJ Error (%1): ").arg(record.arg) + record.arg2;
+        break;
+    case LOG_TEXT:
+    default:
+        message = record.arg;
+        break;
+    }
+    return QString("[%1] %2").arg(timestamp, message);
+}
+
+void LogModel::publish()
+{
+    if (m_evictedRows > 0) {
+        beginRemoveRows(QModelIndex(), 0, m_evictedRows - 1);
+        m_publishedRows -= m_evictedRows;
+        m_evictedRows = 0;
+        endRemoveRows();
+    }
+
+    const int rows = int(m_records.size());
+    if (rows > m_publishedRows) {
+        beginInsertRows(QModelIndex(), m_publishedRows, rows - 1);
+        m_publishedRows = rows;
+        endInsertRows();
+    }
+}
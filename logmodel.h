@@ -0,0 +1,37 @@
+#ifndef LOGMODEL_H
+#define LOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QTimer>
+#include "logringbuffer.h"
+
+// The system log as a list model over a LogRingBuffer. log() only stores the record;
+// rows are announced to the view in one batch per frame, and a row's text (timestamp
+// included) is only formatted when the view asks for it, i.e. for the visible rows.
+class LogModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    static constexpr std::size_t CAPACITY = 512;
+
+    explicit LogModel(QObject *parent = nullptr);
+
+    void log(LogSeverity severity, LogCode code, const QString &arg, const QString &arg2 = QString());
+    void clear();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    static QString format(const LogRecord &record);
+
+private slots:
+    void publish();
+
+private:
+    LogRingBuffer<CAPACITY> m_records;
+    int m_publishedRows{0};     // rows the view knows about
+    int m_evictedRows{0};       // of those, overwritten since the last publish()
+    QTimer m_publishTimer;
+};
+
+#endif // LOGMODEL_H
@@ -0,0 +1,85 @@
+#ifndef LOGRINGBUFFER_H
+#define LOGRINGBUFFER_H
+
+#include <QString>
+#include <array>
+#include <cstddef>
+
+enum LogSeverity : quint8 {
+    SEVERITY_INFO,
+    SEVERITY_SUCCESS,
+    SEVERITY_WARNING,
+    SEVERITY_ERROR
+};
+
+// What a record says; the text is only put together when a row is shown (LogModel::format)
+enum LogCode : quint8 {
+    LOG_TEXT,           // arg: the whole message
+    LOG_COMMAND,        // arg: command sent
+    LOG_RESPONSE,       // arg: response line, echo removed
+    LOG_NO_RESPONSE,    // arg: command that timed out
+    LOG_ELM_ERROR       // arg: error name, arg2: the line
+};
+
+struct LogRecord {
+    qint64 timestampMs{0};  // since the epoch
+    LogSeverity severity{SEVERITY_INFO};
+    LogCode code{LOG_TEXT};
+    QString arg;            // shared with the caller's string, never copied
+    QString arg2;
+};
+
+// Fixed number of log records, oldest overwritten first. Slots are reused, so pushing
+// only assigns (implicitly shared) strings; single-threaded, like the UI that owns it.
+template <std::size_t Capacity>
+class LogRingBuffer
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "LogRingBuffer capacity must be a power of two");
+
+public:
+    // True when the oldest record was overwritten to make room
+    bool push(const LogRecord &record)
+    {
+        const bool evicted = size() == Capacity;
+        m_slots[m_head & MASK] = record;
+        ++m_head;
+        if (evicted) {
+            ++m_tail;
+        }
+        return evicted;
+    }
+
+    // 0 is the oldest record
+    const LogRecord &at(std::size_t index) const
+    {
+        return m_slots[(m_tail + index) & MASK];
+    }
+
+    std::size_t size() const
+    {
+        return m_head - m_tail;
+    }
+
+    static constexpr std::size_t capacity()
+    {
+        return Capacity;
+    }
+
+    void clear()
+    {
+        for (LogRecord &slot : m_slots) {
+            slot = LogRecord();
+        }
+        m_head = 0;
+        m_tail = 0;
+    }
+
+private:
+    static constexpr std::size_t MASK = Capacity - 1;
+
+    std::array<LogRecord, Capacity> m_slots;
+    std::size_t m_head{0};
+    std::size_t m_tail{0};
+};
+
+#endif // LOGRINGBUFFER_H
@@ -1,6 +1,8 @@
 #include "mainwindow.h"
+#include "connectionmanager.h"
 #include <QtWidgets/QStyleFactory>
 #include <QApplication>
+#include <QCommandLineParser>
 
 int main(int argc, char *argv[])
 {
@@ -15,6 +17,36 @@ int main(int argc, char *argv[])
     a.setOrganizationDomain("www.turkaybiliyor.com");
     a.setApplicationName("Obd Reader");
 
+    // Field debugging: record the raw adapter traffic, or play a recording back instead of an adapter
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption captureOption("capture", "Write raw adapter traffic to <file>.", "file");
+    QCommandLineOption replayOption("replay", "Connect to a traffic capture instead of an adapter.", "file");
+    QCommandLineOption replayFastOption("replay-fast", "Replay as fast as possible instead of at recorded speed.");
+    // Offline testing: a simulated ELM327 with the WJ modules behind it
+    QCommandLineOption simulatorOption("simulator", "Offer the built-in adapter simulator as a connection.");
+    QCommandLineOption simulatorFastOption("simulator-fast", "Answer without simulated latencies.");
+    QCommandLineOption simulatorSeedOption("simulator-seed", "Seed for values, jitter and faults.", "seed", "1");
+    QCommandLineOption simulatorFaultsOption("simulator-faults", "Share of ECU requests answered NO DATA, and half that with bus errors.", "rate", "0");
+    parser.addOptions({captureOption, replayOption, replayFastOption,
+                       simulatorOption, simulatorFastOption, simulatorSeedOption, simulatorFaultsOption});
+    parser.process(a);
+
+    ConnectionManager *connectionManager = ConnectionManager::getInstance();
+    if (parser.isSet(captureOption)) {
+        connectionManager->startCapture(parser.value(captureOption));
+    }
+    if (parser.isSet(replayOption)) {
+        connectionManager->setReplayTrace(parser.value(replayOption), !parser.isSet(replayFastOption));
+    }
+    if (parser.isSet(simulatorOption)) {
+        ElmSimulatorConfig config;
+        config.seed = parser.value(simulatorSeedOption).toUInt();
+        config.noDataRate = qBound(0.0, parser.value(simulatorFaultsOption).toDouble(), 1.0);
+        config.busErrorRate = config.noDataRate / 2;
+        connectionManager->setSimulator(config, !parser.isSet(simulatorFastOption));
+    }
+
     MainWindow w;
     w.show();
     return a.exec();
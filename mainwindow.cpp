@@ -6,10 +6,18 @@
 #include <QTimer>
 #include <QDateTime>
 #include <QMessageBox>
+#include <QHeaderView>
+#include <QInputDialog>
 
 #include "elm.h"
 #include "settingsmanager.h"
 #include "connectionmanager.h"
+#include "elminterface.h"
+#include "instrumentation.h"
+#include "livedataengine.h"
+#include "logmodel.h"
+#include "sensorrecorder.h"
+#include "wjinitsession.h"
 
 // WJ Constants Implementation
 const QString MainWindow::WJ_ECU_HEADER_ENGINE = WJ::Headers::ENGINE_EDC15;
@@ -21,6 +29,91 @@ const int MainWindow::WJ_INIT_TIMEOUT = 30000;
 const int MainWindow::WJ_PROTOCOL_SWITCH_TIMEOUT = WJ::Protocols::PROTOCOL_SWITCH_TIMEOUT;
 const int MainWindow::WJ_MAX_RETRIES = 3;
 
+namespace {
+
+// How each signal is shown; the label it goes to depends on the layout, see sensorLabel()
+struct SensorDisplay {
+    WJSensorId sensor;
+    const char *unit;
+    int decimals;
+};
+
+const SensorDisplay SENSOR_DISPLAYS[] = {
+    {SENSOR_ENGINE_MAF_ACTUAL,              "g/s",   1},
+    {SENSOR_ENGINE_MAF_SPECIFIED,           "g/s",   1},
+    {SENSOR_ENGINE_RAIL_PRESSURE_ACTUAL,    "bar",   1},
+    {SENSOR_ENGINE_RAIL_PRESSURE_SPECIFIED, "bar",   1},
+    {SENSOR_ENGINE_MAP_ACTUAL,              "mbar",  0},
+    {SENSOR_ENGINE_MAP_SPECIFIED,           "mbar",  0},
+    {SENSOR_ENGINE_COOLANT_TEMP,            "°C",    1},
+    {SENSOR_ENGINE_INTAKE_AIR_TEMP,         "°C",    1},
+    {SENSOR_ENGINE_THROTTLE_POSITION,       "%",     1},
+    {SENSOR_ENGINE_RPM,                     "rpm",   0},
+    {SENSOR_ENGINE_INJECTION_QUANTITY,      "mg",    1},
+    {SENSOR_ENGINE_BATTERY_VOLTAGE,         "V",     2},
+    {SENSOR_ENGINE_INJECTOR1_CORRECTION,    "mg",    2},
+    {SENSOR_ENGINE_INJECTOR2_CORRECTION,    "mg",    2},
+    {SENSOR_ENGINE_INJECTOR3_CORRECTION,    "mg",    2},
+    {SENSOR_ENGINE_INJECTOR4_CORRECTION,    "mg",    2},
+    {SENSOR_ENGINE_INJECTOR5_CORRECTION,    "mg",    2},
+
+    {SENSOR_TRANS_OIL_TEMP,                 "°C",    1},
+    {SENSOR_TRANS_INPUT_SPEED,              "rpm",   0},
+    {SENSOR_TRANS_OUTPUT_SPEED,             "rpm",   0},
+    {SENSOR_TRANS_CURRENT_GEAR,             "",      0},
+    {SENSOR_TRANS_LINE_PRESSURE,            "psi",   1},
+    {SENSOR_TRANS_SHIFT_SOLENOID_A,         "%",     1},
+    {SENSOR_TRANS_SHIFT_SOLENOID_B,         "%",     1},
+    {SENSOR_TRANS_TCC_SOLENOID,             "%",     1},
+    {SENSOR_TRANS_TORQUE_CONVERTER,         "%",     1},
+
+    {SENSOR_PCM_VEHICLE_SPEED,              "km/h",  0},
+    {SENSOR_PCM_ENGINE_LOAD,                "%",     1},
+    {SENSOR_PCM_FUEL_TRIM_ST,               "%",     2},
+    {SENSOR_PCM_FUEL_TRIM_LT,               "%",     2},
+    {SENSOR_PCM_O2_SENSOR1,                 "V",     3},
+    {SENSOR_PCM_O2_SENSOR2,                 "V",     3},
+    {SENSOR_PCM_TIMING_ADVANCE,             "°",     1},
+    {SENSOR_PCM_BAROMETRIC_PRESSURE,        "kPa",   1},
+
+    {SENSOR_ABS_WHEEL_SPEED_FL,             "km/h",  1},
+    {SENSOR_ABS_WHEEL_SPEED_FR,             "km/h",  1},
+    {SENSOR_ABS_WHEEL_SPEED_RL,             "km/h",  1},
+    {SENSOR_ABS_WHEEL_SPEED_RR,             "km/h",  1},
+    {SENSOR_ABS_YAW_RATE,                   "deg/s", 2},
+    {SENSOR_ABS_LATERAL_ACCEL,              "g",     3},
+};
+
+const double DISPLAY_SCALE[] = {1.0, 10.0, 100.0, 1000.0};
+
+static_assert(SENSOR_COUNT <= 64, "dirtySensors has one bit per sensor");
+
+LogSeverity severityOf(const QString &message) {
+    if (message.startsWith("❌")) {
+        return SEVERITY_ERROR;
+    }
+    if (message.startsWith("⚠️")) {
+        return SEVERITY_WARNING;
+    }
+    if (message.startsWith("✓")) {
+        return SEVERITY_SUCCESS;
+    }
+    return SEVERITY_INFO;
+}
+
+// Labels keep their "--" placeholder until the module has answered once
+bool hasValidData(const WJSensorData &data, WJModule module) {
+    switch (module) {
+    case MODULE_ENGINE_EDC15: return data.engine.dataValid;
+    case MODULE_TRANSMISSION: return data.transmission.dataValid;
+    case MODULE_PCM: return data.pcm.dataValid;
+    case MODULE_ABS: return data.abs.dataValid;
+    default: return false;
+    }
+}
+
+} // namespace
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , centralWidget(nullptr)
@@ -30,11 +123,13 @@ MainWindow::MainWindow(QWidget *parent)
     , elm(nullptr)
     , settingsManager(nullptr)
     , connectionManager(nullptr)
+    , elmInterface(nullptr)
+    , liveDataEngine(nullptr)
+    , sensorRecorder(new SensorRecorder())
+    , initSession(nullptr)
     , currentInitState(STATE_DISCONNECTED)
-    , currentInitStep(0)
     , initializationTimer(new QTimer(this))
-    , continuousReadingTimer(new QTimer(this))
-    , engineSecurityAccessGranted(false)
+    , displayTimer(new QTimer(this))
     , currentProtocol(PROTOCOL_UNKNOWN)
     , currentModule(MODULE_UNKNOWN)
     , protocolSwitchingInProgress(false)
@@ -104,9 +199,6 @@ MainWindow::MainWindow(QWidget *parent)
     desktopRect = screen->availableGeometry();
     qDebug() << "Screen resolution:" << desktopRect.width() << "x" << desktopRect.height();
 
-    // Setup WJ initialization commands
-    setupWJInitializationCommands();
-
     // Setup UI FIRST - terminalDisplay burada oluşturuluyor
     setupUI();
     applyCarStereoStyling();
@@ -115,6 +207,21 @@ MainWindow::MainWindow(QWidget *parent)
     elm = ELM::getInstance();
     settingsManager = SettingsManager::getInstance();
     connectionManager = ConnectionManager::getInstance();
+    elmInterface = ElmInterface::getInstance();
+    liveDataEngine = new LiveDataEngine(elmInterface, this);
+    initSession = new WJInitSession(this);
+
+    // Started with --replay: the capture is offered as a third connection type
+    if (!connectionManager->replayTrace().isEmpty()) {
+        connectionTypeCombo->addItem("Replay", int(Replay));
+        connectionTypeCombo->setCurrentIndex(connectionTypeCombo->count() - 1);
+    }
+
+    // Started with --simulator: same for the built-in adapter simulator
+    if (connectionManager->hasSimulator()) {
+        connectionTypeCombo->addItem("Simulator", int(Simulator));
+        connectionTypeCombo->setCurrentIndex(connectionTypeCombo->count() - 1);
+    }
 
     // Setup connections
     setupConnections();
@@ -124,8 +231,18 @@ MainWindow::MainWindow(QWidget *parent)
     initializationTimer->setInterval(WJ_INIT_TIMEOUT);
     connect(initializationTimer, &QTimer::timeout, this, &MainWindow::onInitializationTimeout);
 
-    continuousReadingTimer->setInterval(readingInterval);
-    connect(continuousReadingTimer, &QTimer::timeout, this, &MainWindow::performContinuousRead);
+    // At most one sensor redraw per frame of the head unit's screen, however fast data comes in
+    const qreal refreshRate = screen->refreshRate() > 0 ? screen->refreshRate() : 60.0;
+    displayTimer->setSingleShot(true);
+    displayTimer->setTimerType(Qt::PreciseTimer);
+    displayTimer->setInterval(qMax(1, qRound(1000.0 / refreshRate)));
+    connect(displayTimer, &QTimer::timeout, this, &MainWindow::refreshSensorDisplays);
+
+    liveDataEngine->setMinCycleInterval(readingInterval);
+    connect(liveDataEngine, &LiveDataEngine::sampleRatesUpdated, this, &MainWindow::onSampleRatesUpdated);
+    connect(liveDataEngine, &LiveDataEngine::pidMessageReceived, this, &MainWindow::decodeMessage);
+    connect(initSession, &WJInitSession::logMessage, this, &MainWindow::logWJData);
+    connect(initSession, &WJInitSession::completed, this, &MainWindow::completeWJInitialization);
 
     // Initialize settings with platform-specific defaults
     initializeSettings();
@@ -151,11 +268,8 @@ MainWindow::~MainWindow() {
     if (settingsManager) {
         settingsManager->saveSettings();
     }
-}
 
-void MainWindow::setupWJInitializationCommands() {
-    // Start with ISO_14230_4_KWP_FAST for engine module by default
-    initializationCommands = WJCommands::getInitSequence(PROTOCOL_ISO_14230_4_KWP_FAST);
+    delete sensorRecorder;
 }
 
 void MainWindow::initializeSettings() {
@@ -399,7 +513,7 @@ void MainWindow::setupRightPanel() {
 
     // Auto-refresh controls
     QGroupBox* autoGroup = new QGroupBox("Auto Refresh");
-    autoGroup->setFixedHeight(120);
+    autoGroup->setFixedHeight(150);
     QVBoxLayout* autoLayout = new QVBoxLayout(autoGroup);
 
     continuousReadingCheckBox = new QCheckBox("Enable Auto Refresh");
@@ -419,17 +533,30 @@ void MainWindow::setupRightPanel() {
     intervalLayout->addWidget(intervalLabel);
     autoLayout->addLayout(intervalLayout);
 
+    QHBoxLayout* pollLayout = new QHBoxLayout();
+    allModulesCheckBox = new QCheckBox("All modules");
+    allModulesCheckBox->setFixedHeight(30);
+    sampleRateLabel = new QLabel("0.0 samples/s");
+    pollLayout->addWidget(allModulesCheckBox);
+    pollLayout->addWidget(sampleRateLabel);
+    autoLayout->addLayout(pollLayout);
+
     rightLayout->addWidget(autoGroup);
 
     // Terminal/Log section
     QGroupBox* logGroup = new QGroupBox("System Log");
     QVBoxLayout* logLayout = new QVBoxLayout(logGroup);
 
-    terminalDisplay = new QTextBrowser();
+    // Virtualized: only the visible rows are ever formatted
+    logModel = new LogModel(this);
+    terminalDisplay = new QListView();
+    terminalDisplay->setModel(logModel);
+    terminalDisplay->setUniformItemSizes(true);
+    terminalDisplay->setSelectionMode(QAbstractItemView::NoSelection);
     terminalDisplay->setFixedHeight(150);
     terminalDisplay->setFont(QFont("Consolas", 9));
     terminalDisplay->setStyleSheet(
-        "QTextBrowser {"
+        "QListView {"
         "    background-color: #000000;"
         "    color: #00FF00;"
         "    border: 1px solid #374151;"
@@ -437,6 +564,7 @@ void MainWindow::setupRightPanel() {
         "    font-family: 'Consolas', monospace;"
         "}"
         );
+    connect(logModel, &QAbstractItemModel::rowsInserted, terminalDisplay, &QListView::scrollToBottom);
     logLayout->addWidget(terminalDisplay);
 
     // Manual command controls
@@ -453,14 +581,20 @@ void MainWindow::setupRightPanel() {
     commandLayout->addWidget(sendCommandButton);
     logLayout->addLayout(commandLayout);
 
-    // Clear log and exit buttons
+    // Clear log, stats and exit buttons
     QHBoxLayout* controlLayout = new QHBoxLayout();
     clearTerminalButton = new QPushButton("Clear Log");
+    statsButton = new QPushButton("Stats");
+    signalsButton = new QPushButton("Signals");
     exitButton = new QPushButton("Exit");
     clearTerminalButton->setFixedHeight(30);
+    statsButton->setFixedHeight(30);
+    signalsButton->setFixedHeight(30);
     exitButton->setFixedHeight(30);
 
     controlLayout->addWidget(clearTerminalButton);
+    controlLayout->addWidget(statsButton);
+    controlLayout->addWidget(signalsButton);
     controlLayout->addWidget(exitButton);
     logLayout->addLayout(controlLayout);
 
@@ -533,13 +667,14 @@ void MainWindow::setupConnections() {
     connect(readingIntervalSlider, &QSlider::valueChanged, this, &MainWindow::onReadingIntervalChanged);
     connect(commandLineEdit, &QLineEdit::returnPressed, this, &MainWindow::onSendCommandClicked);
     connect(clearTerminalButton, &QPushButton::clicked, this, &MainWindow::onClearTerminalClicked);
+    connect(statsButton, &QPushButton::clicked, this, &MainWindow::onStatsClicked);
+    connect(signalsButton, &QPushButton::clicked, this, &MainWindow::onSignalsClicked);
     connect(exitButton, &QPushButton::clicked, this, &MainWindow::onExitClicked);
 
     // Connection manager signals
     if (connectionManager) {
         connect(connectionManager, &ConnectionManager::connected, this, &MainWindow::onConnected);
         connect(connectionManager, &ConnectionManager::disconnected, this, &MainWindow::onDisconnected);
-        connect(connectionManager, &ConnectionManager::dataReceived, this, &MainWindow::onDataReceived);
         connect(connectionManager, &ConnectionManager::stateChanged, this, &MainWindow::onConnectionStateChanged);
 
         // Bluetooth-specific signals
@@ -548,6 +683,14 @@ void MainWindow::setupConnections() {
         connect(connectionManager, &ConnectionManager::bluetoothDiscoveryCompleted,
                 this, &MainWindow::onBluetoothDiscoveryCompleted);
     }
+
+    // Responses arrive already matched to their request by the ELM prompt
+    if (elmInterface) {
+        connect(elmInterface, &ElmInterface::responseReceived, this, &MainWindow::onResponseReceived);
+        connect(elmInterface, &ElmInterface::messageReceived, this, &MainWindow::onMessageReceived);
+        connect(elmInterface, &ElmInterface::requestTimedOut, this, &MainWindow::onRequestTimedOut);
+        connect(elmInterface, &ElmInterface::protocolSwitched, this, &MainWindow::onProtocolSwitched);
+    }
 }
 
 // Apply car stereo specific styling
@@ -672,6 +815,22 @@ void MainWindow::onConnectionTypeChanged(int index) {
                       QString::number(settingsManager->getWifiPort()));
         }
     }
+    else if (connectionTypeCombo->itemData(index) == int(Replay)) {
+        connectionManager->setConnectionType(Replay);
+        btDeviceLabel->setVisible(false);
+        bluetoothDevicesCombo->setVisible(false);
+        scanBluetoothButton->setVisible(false);
+
+        logWJData("→ Connection type set to Replay: " + connectionManager->replayTrace());
+    }
+    else if (connectionTypeCombo->itemData(index) == int(Simulator)) {
+        connectionManager->setConnectionType(Simulator);
+        btDeviceLabel->setVisible(false);
+        bluetoothDevicesCombo->setVisible(false);
+        scanBluetoothButton->setVisible(false);
+
+        logWJData("→ Connection type set to Simulator");
+    }
     else if (index == 1) { // Bluetooth
         connectionManager->setConnectionType(BlueTooth);
         btDeviceLabel->setVisible(true);
@@ -838,10 +997,28 @@ void MainWindow::onModuleSelectionChanged(int index) {
         updateSensorLayoutForModule(module);
 
         logWJData("✓ Switched to " + moduleName);
+
+        // Single-module polling follows the selection
+        if (liveDataEngine->isRunning() && !allModulesCheckBox->isChecked()) {
+            stopContinuousReading();
+            startContinuousReading();
+        }
     }
 }
 
 void MainWindow::updateSensorLayoutForModule(WJModule module) {
+    // The sensorN slots are shared: another module's names for them must not write there any more
+    mafActualLabel = mafSpecifiedLabel = railPressureActualLabel = mapActualLabel = nullptr;
+    coolantTempLabel = intakeAirTempLabel = throttlePositionLabel = rpmLabel = nullptr;
+    injectionQuantityLabel = batteryVoltageLabel = vehicleSpeedLabel = engineLoadLabel = nullptr;
+    transOilTempLabel = transInputSpeedLabel = transOutputSpeedLabel = transCurrentGearLabel = nullptr;
+    transLinePressureLabel = transSolenoidALabel = transSolenoidBLabel = nullptr;
+    transTCCSolenoidLabel = transTorqueConverterLabel = nullptr;
+    fuelTrimSTLabel = fuelTrimLTLabel = o2Sensor1Label = o2Sensor2Label = nullptr;
+    timingAdvanceLabel = barometricPressureLabel = nullptr;
+    wheelSpeedFLLabel = wheelSpeedFRLabel = wheelSpeedRLLabel = wheelSpeedRRLabel = nullptr;
+    yawRateLabel = lateralAccelLabel = nullptr;
+
     // Map the universal sensor labels to module-specific data
     switch (module) {
     case MODULE_ENGINE_EDC15:
@@ -901,6 +1078,7 @@ void MainWindow::updateSensorLayoutForModule(WJModule module) {
 
     // Update sensor display texts with appropriate labels
     updateSensorLabelsForModule(module);
+    invalidateSensorDisplays();
 }
 
 void MainWindow::updateSensorLabelsForModule(WJModule module) {
@@ -1063,10 +1241,8 @@ void MainWindow::onProtocolSwitchRequested(WJProtocol protocol) {
         return;
     }
 
-    if (switchToProtocol(protocol)) {
-        currentProtocol = protocol;
-        logWJData("✓ Switched to protocol: " + WJUtils::getProtocolName(protocol));
-    } else {
+    // Success is reported by onProtocolSwitched once the adapter confirms it
+    if (!switchToProtocol(protocol)) {
         logWJData("❌ Failed to switch to protocol: " + WJUtils::getProtocolName(protocol));
     }
 }
@@ -1082,20 +1258,30 @@ bool MainWindow::switchToProtocol(WJProtocol protocol) {
 
     protocolSwitchingInProgress = true;
 
-    // Get protocol switch commands
-    QList<WJCommand> switchCommands = WJCommands::getProtocolSwitchCommands(currentProtocol, protocol);
-
-    for (const WJCommand& cmd : switchCommands) {
-        sendWJCommand(cmd.command);
-        QThread::msleep(cmd.timeoutMs / 10); // Short delay between commands
-    }
+    // Queued ahead of everything sent after this; the outcome arrives in onProtocolSwitched
+    logWJData("→ Switching protocol to: " + WJUtils::getProtocolName(protocol));
+    elmInterface->switchProtocol(protocol);
+    currentProtocol = protocol;
+    return true;
+}
 
+void MainWindow::onProtocolSwitched(WJProtocol protocol, bool ok, bool usedReset, qint64 elapsedMs) {
     protocolSwitchingInProgress = false;
-    currentProtocol = protocol;
 
-    logWJData(QString("✓ Protocol switched to: %1")
-                  .arg(WJUtils::getProtocolName(protocol)));
-    return true;
+    if (!ok) {
+        if (currentProtocol == protocol) {
+            currentProtocol = PROTOCOL_UNKNOWN;
+        }
+        logWJData(QString("❌ Protocol switch to %1 failed after %2 ms")
+                      .arg(WJUtils::getProtocolName(protocol))
+                      .arg(elapsedMs));
+        return;
+    }
+
+    logWJData(QString("✓ Protocol switched to: %1 in %2 ms (%3)")
+                  .arg(WJUtils::getProtocolName(protocol))
+                  .arg(elapsedMs)
+                  .arg(usedReset ? "full reset" : "fast switch"));
 }
 
 bool MainWindow::switchToModule(WJModule module) {
@@ -1140,11 +1326,8 @@ bool MainWindow::switchToModule(WJModule module) {
                     return false;
                 }
 
+                // Paced by the ELM prompt; no fixed delay between commands
                 sendWJCommand(cmd.command, module);
-
-                // Safer delay with bounds checking
-                int delayMs = qMax(10, cmd.timeoutMs / 20); // Minimum 10ms delay
-                QThread::msleep(delayMs);
             }
         } else {
             logWJData("→ No module-specific commands to execute");
@@ -1188,6 +1371,12 @@ bool MainWindow::connectToWJ() {
     if (connectionTypeCombo->currentIndex() == 0) {
         connectionManager->setConnectionType(Wifi);
         logWJData("→ Using WiFi connection");
+    } else if (connectionTypeCombo->currentData() == int(Replay)) {
+        connectionManager->setConnectionType(Replay);
+        logWJData("→ Replaying " + connectionManager->replayTrace());
+    } else if (connectionTypeCombo->currentData() == int(Simulator)) {
+        connectionManager->setConnectionType(Simulator);
+        logWJData("→ Using the built-in adapter simulator");
     } else {
         connectionManager->setConnectionType(BlueTooth);
         logWJData("→ Using Bluetooth connection");
@@ -1210,7 +1399,7 @@ bool MainWindow::connectToWJ() {
             connectionManager->connectElm(); // Will start discovery
         }
     } else {
-        connectionManager->connectElm(); // WiFi connection
+        connectionManager->connectElm(); // WiFi connection, replay or simulator
     }
 
     connectButton->setEnabled(false);
@@ -1227,6 +1416,15 @@ void MainWindow::disconnectFromWJ() {
 
     stopContinuousReading();
 
+    // Latencies and PIDs learned while polling go into the cache for the next connect
+    if (initialized) {
+        initSession->saveProfile();
+    }
+
+    if (elmInterface) {
+        elmInterface->clearQueue();
+    }
+
     if (connectionManager) {
         connectionManager->disConnectElm();
     }
@@ -1278,127 +1476,46 @@ void MainWindow::onConnectionStateChanged(const QString& state) {
 
 // WJ Communication Methods
 bool MainWindow::initializeWJCommunication() {
-    if (!connected || initializationCommands.isEmpty()) {
+    if (!connected) {
         return false;
     }
 
-    currentInitStep = 0;
     currentInitState = STATE_CONNECTING;
     initialized = false;
-    engineSecurityAccessGranted = false;
 
     logWJData("→ Starting WJ multi-protocol initialization...");
     logWJData("→ Target: Jeep Grand Cherokee WJ 2.7 CRD (All Modules)");
 
-    // Start with engine module (ISO_14230_4_KWP_FAST) initialization
-    const WJCommand& firstCmd = initializationCommands[0];
-    logWJData("→ " + firstCmd.description + ": " + firstCmd.command);
-
-    lastSentCommand = firstCmd.command;
-    connectionManager->send(firstCmd.command);
-
-    return true;
+    // Queues the whole sequence; answers come back through onResponseReceived
+    return initSession->start(connectionManager->endpoint());
 }
 
-void MainWindow::processWJInitResponse(const QString& response) {
-    if (currentInitStep >= initializationCommands.size()) {
-        // Initialization complete - even with some errors
-        currentInitState = STATE_READY_ISO9141;
-        initialized = true;
-        connectionStatusLabel->setText("Status: Ready");
-
-        logWJData("✓ WJ initialization completed!");
-        logWJData(QString("→ Engine security access: %1").arg(engineSecurityAccessGranted ? "Granted" : "Limited"));
-        logWJData("→ Basic diagnostics available");
-
-        // Enable diagnostic buttons
-        updateControlsForConnection(true);
-
-        initializationTimer->stop();
-
-        // Set initial protocol and module
-        currentProtocol = PROTOCOL_ISO_14230_4_KWP_FAST;
-        currentModule = MODULE_ENGINE_EDC15;
-        currentModuleLabel->setText("Current: " + WJUtils::getModuleName(currentModule));
-        protocolLabel->setText("Protocol: Ready");
-
-        // Test basic communication
-        QTimer::singleShot(2000, [this]() {
-            onReadAllSensorsClicked();
-        });
-
-        return;
-    }
+void MainWindow::completeWJInitialization() {
+    // Initialization complete - even with some errors
+    currentInitState = STATE_READY_ISO9141;
+    initialized = true;
+    connectionStatusLabel->setText("Status: Ready");
 
-    const WJCommand& currentCmd = initializationCommands[currentInitStep];
-    QString cleanResponse = removeCommandEcho(response).trimmed().toUpper();
-    bool responseOK = false;
-    bool shouldAdvanceStep = true;
+    logWJData("✓ WJ initialization completed!");
+    logWJData(QString("→ Engine security access: %1").arg(initSession->securityGranted() ? "Granted" : "Limited"));
+    logWJData("→ Basic diagnostics available");
 
-    // Handle errors more gracefully
-    if (isWJError(cleanResponse)) {
-        if (currentCmd.isCritical) {
-            // Critical command failed
-            logWJData("❌ Critical command failed: " + currentCmd.command + " - " + cleanResponse);
-            responseOK = true; // Continue anyway
-        } else {
-            // Non-critical command failed - just continue
-            logWJData("⚠️ Non-critical command failed: " + currentCmd.command + " - " + cleanResponse);
-            responseOK = true; // Continue
-        }
-    }
-    // Handle specific responses
-    else if (currentCmd.command == "ATZ") {
-        currentInitState = STATE_RESETTING;
-        if (cleanResponse.contains("ELM327") || cleanResponse.isEmpty()) {
-            logWJData("✓ ELM327 reset successful");
-            responseOK = true;
-        }
-    }
-    else if (currentCmd.command.startsWith("AT")) {
-        if (cleanResponse.contains("OK") || cleanResponse.isEmpty()) {
-            logWJData("✓ " + currentCmd.description);
-            responseOK = true;
-        }
-    }
-    else if (currentCmd.command == "81") {
-        // Start communication - don't require success
-        if (cleanResponse.contains("BUS INIT") || cleanResponse.contains("ERROR")) {
-            logWJData("⚠️ Engine communication attempted: " + cleanResponse);
-            responseOK = true; // Continue even with error
-        }
-    }
-    else if (currentCmd.command.startsWith("27")) {
-        // Security access - don't require success
-        logWJData("⚠️ Security access attempted: " + cleanResponse);
-        responseOK = true; // Continue regardless
-        engineSecurityAccessGranted = cleanResponse.contains("67");
-    }
-    else {
-        // Other commands
-        logWJData("→ " + currentCmd.description + ": " + cleanResponse);
-        responseOK = true; // Be permissive
-    }
+    // Enable diagnostic buttons
+    updateControlsForConnection(true);
 
-    // Always advance to next step unless explicitly told not to
-    if (shouldAdvanceStep) {
-        currentInitStep++;
+    initializationTimer->stop();
 
-        if (currentInitStep < initializationCommands.size()) {
-            const WJCommand& nextCmd = initializationCommands[currentInitStep];
+    // The session already refreshed the vehicle profile cache
+    liveDataEngine->setSupportedPids(elm->pidsChecked() ? elm->supportedPids() : std::bitset<256>());
 
-            // Use the command's timeout
-            int delay = nextCmd.timeoutMs;
+    // Set initial protocol and module
+    currentProtocol = PROTOCOL_ISO_14230_4_KWP_FAST;
+    currentModule = MODULE_ENGINE_EDC15;
+    currentModuleLabel->setText("Current: " + WJUtils::getModuleName(currentModule));
+    protocolLabel->setText("Protocol: Ready");
 
-            QTimer::singleShot(delay, [this, nextCmd]() {
-                if (connected && connectionManager) {
-                    logWJData("→ " + nextCmd.description + ": " + nextCmd.command);
-                    lastSentCommand = nextCmd.command;
-                    connectionManager->send(nextCmd.command);
-                }
-            });
-        }
-    }
+    // Test basic communication
+    onReadAllSensorsClicked();
 }
 
 void MainWindow::onInitializationTimeout() {
@@ -1436,54 +1553,64 @@ void MainWindow::sendWJCommand(const QString& command, WJModule targetModule) {
                       .arg(WJUtils::getModuleName(targetModule)));
     }
 
-    // Set appropriate ECU header based on current module
-    if (!command.startsWith("AT") && !currentECUHeader.isEmpty()) {
-        QString headerCommand = "ATSH" + currentECUHeader;
-        connectionManager->send(headerCommand);
-        QThread::msleep(50);
-    }
+    // ElmInterface sends ATSH/ATSP/... first only if the adapter isn't set up for the module yet
+    WJModule requestModule = (targetModule != MODULE_UNKNOWN) ? targetModule : currentModule;
 
-    lastSentCommand = cleanCommand;
-    logWJData("→ " + cleanCommand);
-    connectionManager->send(cleanCommand);
+    logModel->log(SEVERITY_INFO, LOG_COMMAND, cleanCommand);
+    elmInterface->enqueue(cleanCommand, requestModule);
 }
 
-void MainWindow::onDataReceived(const QString& data) {
-    if (data.isEmpty()) {
-        return;
-    }
+void MainWindow::onResponseReceived(quint32 id, const QString& command, WJModule module, const QStringList& lines) {
+    Q_UNUSED(id);
 
-    // Add to buffer
-    dataBuffer += data;
+    // Responses are delivered in request order, so echo removal uses the matching command
+    lastSentCommand = command;
 
-    // Handle different line endings (\n, \r\n, \r)
-    dataBuffer.replace("\r\n", "\n"); // Windows style
-    dataBuffer.replace("\r", "\n");   // Mac style
+    // Lines are still logged; data already decoded from messageReceived is not parsed again
+    const bool parse = (id != streamDecodedId);
+    for (const QString& line : lines) {
+        processDataLine(line, module, parse);
+    }
 
-    // Split by newlines
-    QStringList lines = dataBuffer.split('\n');
+    // The init sequence advances once per command, not once per line
+    if (!initialized) {
+        initSession->handleResponse(id, command, lines.join(' '));
+    }
+}
 
-    // Keep the last part if it doesn't end with newline
-    if (!dataBuffer.endsWith('\n')) {
-        dataBuffer = lines.takeLast();
-    } else {
-        dataBuffer.clear();
+void MainWindow::onMessageReceived(quint32 id, WJModule module, QByteArrayView message) {
+    // Batched mode 01 replies come back one PID at a time through pidMessageReceived
+    if (!liveDataEngine->isBatched(id)) {
+        decodeMessage(id, module, message);
+    }
+}
+
+void MainWindow::decodeMessage(quint32 id, WJModule module, QByteArrayView message) {
+    if (!initialized) {
+        return;
+    }
+    if (module == MODULE_UNKNOWN) {
+        module = currentModule;
     }
 
-    // Process each complete line
-    for (const QString& line : lines) {
-        if (!line.trimmed().isEmpty()) {
-            processDataLine(line.trimmed());
-        }
+    // Multi-frame blocks (injector data, DTC lists) decode as soon as their last frame is in
+    if (WJDataParser::decode(reinterpret_cast<const quint8*>(message.data()), int(message.size()), module, sensorData)) {
+        streamDecodedId = id;
+        sensorRecorder->record(sensorData, module);
+        markSensorsDirty(module);
     }
+}
 
-    // Log buffer status for debugging
-    if (!dataBuffer.isEmpty() && dataBuffer.length() > 100) {
-        qDebug() << "Large buffer without newline:" << dataBuffer.length() << "chars";
+void MainWindow::onRequestTimedOut(quint32 id, const QString& command) {
+    logModel->log(SEVERITY_WARNING, LOG_NO_RESPONSE, command);
+
+    if (!initialized) {
+        lastSentCommand = command;
+        initSession->handleResponse(id, command, QString());
     }
 }
 
-void MainWindow::processDataLine(const QString& line)
+void MainWindow::processDataLine(const QString& line, WJModule module, bool parse)
 {
     if (line.isEmpty()) {
         return;
@@ -1503,22 +1630,21 @@ void MainWindow::processDataLine(const QString& line)
     }
 
     // Check for errors
-    if (isWJError(cleanData)) {
-        logWJData("❌ WJ Error: " + cleanData);
+    const ElmError error = WJUtils::classifyError(cleanData);
+    if (error.isError()) {
+        logModel->log(SEVERITY_ERROR, LOG_ELM_ERROR, error.name(), cleanData);
         return;
     }
 
-    // Remove echo and log response
+    // Remove echo and log response; one record per polled line, so no text is built here
     QString response = removeCommandEcho(cleanData);
     if (!response.isEmpty() && !protocolSwitchingInProgress) {
-        logWJData("← " + response);
+        logModel->log(SEVERITY_INFO, LOG_RESPONSE, response);
     }
 
-    // Handle initialization or data processing
-    if (!initialized) {
-        processWJInitResponse(cleanData);
-    } else {
-        parseWJResponse(response);
+    // Initialization responses are handled per command in onResponseReceived
+    if (initialized && parse) {
+        parseWJResponse(response, module);
     }
 }
 
@@ -1553,29 +1679,25 @@ void MainWindow::logWJData(const QString& message) {
         message.contains("Kernel") ||    // Kernel info
         message.contains("Physical")) {  // Physical size
 
-        QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
-        terminalDisplay->append(QString("[%1] %2").arg(timestamp, message));
-        terminalDisplay->moveCursor(QTextCursor::End);
-    }
-
-    // Keep terminal manageable
-    if (terminalDisplay->document()->blockCount() > 50) {
-        QTextCursor cursor = terminalDisplay->textCursor();
-        cursor.movePosition(QTextCursor::Start);
-        cursor.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor, 10);
-        cursor.removeSelectedText();
+        // Stored as is; the timestamp is formatted only if the row gets shown
+        logModel->log(severityOf(message), LOG_TEXT, message);
     }
 }
 
-void MainWindow::parseWJResponse(const QString& response) {
+void MainWindow::parseWJResponse(const QString& response, WJModule module) {
     QString cleanResponse = cleanWJData(response);
 
     if (cleanResponse.isEmpty()) {
         return; // Don't process empty responses
     }
 
-    // Determine which module's data this is based on current module and response format
-    switch (currentModule) {
+    // Requests carry their module; fall back to the selected one for manual commands
+    if (module == MODULE_UNKNOWN) {
+        module = currentModule;
+    }
+
+    // Determine which module's data this is based on the request module and response format
+    switch (module) {
     case MODULE_ENGINE_EDC15:
         parseEngineData(cleanResponse);
         break;
@@ -1604,14 +1726,7 @@ void MainWindow::parseWJResponse(const QString& response) {
         }
         break;
     }
-
-    // Update displays with safety check
-    try {
-        updateSensorDisplays();
-    } catch (...) {
-        // Log error but don't crash
-        logWJData("❌ Error updating sensor displays");
-    }
+    sensorRecorder->record(sensorData, module);
 }
 
 // Simplified diagnostic command implementations
@@ -1623,23 +1738,12 @@ void MainWindow::onReadAllSensorsClicked() {
 
     logWJData("→ Reading all sensors for " + WJUtils::getModuleName(currentModule) + "...");
 
-    switch (currentModule) {
-    case MODULE_ENGINE_EDC15:
-        executeEngineCommands();
-        break;
-    case MODULE_TRANSMISSION:
-        executeTransmissionCommands();
-        break;
-    case MODULE_PCM:
-        executePCMCommands();
-        break;
-    case MODULE_ABS:
-        executeABSCommands();
-        break;
-    default:
+    if (currentModule == MODULE_UNKNOWN) {
         logWJData("❌ Unknown module selected");
         return;
     }
+
+    liveDataEngine->readOnce(currentModule);
 }
 
 void MainWindow::onReadFaultCodesClicked() {
@@ -1710,74 +1814,6 @@ void MainWindow::onClearFaultCodesClicked() {
     faultCodeList->clear();
 }
 
-// Command execution methods for each module
-void MainWindow::executeEngineCommands() {
-    QStringList commands = {
-        WJ::Engine::READ_MAF_DATA,
-        WJ::Engine::READ_RAIL_PRESSURE_ACTUAL,
-        WJ::Engine::READ_RAIL_PRESSURE_SPEC,
-        WJ::Engine::READ_MAP_DATA,
-        WJ::Engine::READ_INJECTOR_DATA,
-        WJ::Engine::READ_MISC_DATA,
-        WJ::Engine::READ_BATTERY_VOLTAGE
-    };
-
-    for (int i = 0; i < commands.size(); ++i) {
-        QTimer::singleShot(i * 300, [this, commands, i]() {
-            if (connected && currentModule == MODULE_ENGINE_EDC15) {
-                sendWJCommand(commands[i], MODULE_ENGINE_EDC15);
-            }
-        });
-    }
-}
-
-void MainWindow::executeTransmissionCommands() {
-    QStringList commands = {
-        WJ::Transmission::READ_TRANS_DATA,
-        WJ::Transmission::READ_SPEED_DATA,
-        WJ::Transmission::READ_SOLENOID_STATUS
-    };
-
-    for (int i = 0; i < commands.size(); ++i) {
-        QTimer::singleShot(i * 400, [this, commands, i]() {
-            if (connected && currentModule == MODULE_TRANSMISSION) {
-                sendWJCommand(commands[i], MODULE_TRANSMISSION);
-            }
-        });
-    }
-}
-
-void MainWindow::executePCMCommands() {
-    QStringList commands = {
-        WJ::PCM::READ_LIVE_DATA,
-        WJ::PCM::READ_FUEL_TRIM,
-        WJ::PCM::READ_O2_SENSORS
-    };
-
-    for (int i = 0; i < commands.size(); ++i) {
-        QTimer::singleShot(i * 400, [this, commands, i]() {
-            if (connected && currentModule == MODULE_PCM) {
-                sendWJCommand(commands[i], MODULE_PCM);
-            }
-        });
-    }
-}
-
-void MainWindow::executeABSCommands() {
-    QStringList commands = {
-        WJ::ABS::READ_WHEEL_SPEEDS,
-        WJ::ABS::READ_STABILITY_DATA
-    };
-
-    for (int i = 0; i < commands.size(); ++i) {
-        QTimer::singleShot(i * 400, [this, commands, i]() {
-            if (connected && currentModule == MODULE_ABS) {
-                sendWJCommand(commands[i], MODULE_ABS);
-            }
-        });
-    }
-}
-
 // Manual Command and UI Controls
 void MainWindow::onSendCommandClicked() {
     if (!connected || !connectionManager) {
@@ -1798,10 +1834,148 @@ void MainWindow::onSendCommandClicked() {
 }
 
 void MainWindow::onClearTerminalClicked() {
-    terminalDisplay->clear();
+    logModel->clear();
     logWJData("Terminal cleared");
 }
 
+void MainWindow::onSignalsClicked() {
+    QStringList keys;
+    for (const LiveSignal &signal : LiveDataEngine::defaultSignals()) {
+        keys.append(signal.key);
+    }
+
+    QString spec = settingsManager->getSignalSet();
+    if (spec.isEmpty()) {
+        spec = LiveDataEngine::signalSetToString(LiveDataEngine::defaultSignals());
+    }
+
+    bool accepted = false;
+    spec = QInputDialog::getText(this, "Signals",
+                                 "Signals to poll as key:weight, comma separated (empty = defaults).\n"
+                                 "Keys: " + keys.join(", "),
+                                 QLineEdit::Normal, spec, &accepted);
+    if (!accepted) {
+        return;
+    }
+
+    QList<LiveSignal> signalSet;
+    QString error;
+    if (!LiveDataEngine::parseSignalSet(spec, signalSet, error)) {
+        QMessageBox::warning(this, "Signals", error);
+        return;
+    }
+
+    settingsManager->setSignalSet(spec.trimmed());
+    settingsManager->saveSettings();
+    logWJData(QString("→ Signal set: %1 signals").arg(signalSet.size()));
+
+    // Takes effect right away when reading
+    if (liveDataEngine->isRunning()) {
+        stopContinuousReading();
+        startContinuousReading();
+    }
+}
+
+void MainWindow::onStatsClicked() {
+    if (!statsDialog) {
+        statsDialog = new QDialog(this);
+        statsDialog->setWindowTitle("Request Statistics");
+        statsDialog->resize(desktopRect.width() * 3 / 4, desktopRect.height() * 3 / 4);
+
+        statsTable = new QTableWidget(statsDialog);
+        statsTable->setColumnCount(12);
+        statsTable->setHorizontalHeaderLabels({"Module / Command", "Requests", "Replies", "NO DATA", "Errors",
+                                               "Timeouts", "Retries", "RTT p50 ms", "RTT p99 ms",
+                                               "Queue p99 ms", "Parse p99 µs", "UI p99 µs"});
+        statsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        statsTable->verticalHeader()->setVisible(false);
+
+        QPushButton* saveButton = new QPushButton("Save JSON");
+        QPushButton* resetButton = new QPushButton("Reset");
+        QPushButton* closeButton = new QPushButton("Close");
+        connect(saveButton, &QPushButton::clicked, this, &MainWindow::onSaveStatsClicked);
+        connect(resetButton, &QPushButton::clicked, this, [this]() {
+            Instrumentation::getInstance()->reset();
+            refreshStats();
+        });
+        connect(closeButton, &QPushButton::clicked, statsDialog, &QDialog::close);
+
+        QHBoxLayout* buttonLayout = new QHBoxLayout();
+        buttonLayout->addWidget(saveButton);
+        buttonLayout->addWidget(resetButton);
+        buttonLayout->addStretch();
+        buttonLayout->addWidget(closeButton);
+
+        QVBoxLayout* layout = new QVBoxLayout(statsDialog);
+        layout->addWidget(statsTable);
+        layout->addLayout(buttonLayout);
+
+        // Live while open, idle otherwise
+        statsTimer = new QTimer(statsDialog);
+        statsTimer->setInterval(1000);
+        connect(statsTimer, &QTimer::timeout, this, &MainWindow::refreshStats);
+        connect(statsDialog, &QDialog::finished, statsTimer, &QTimer::stop);
+    }
+
+    refreshStats();
+    statsTimer->start();
+    statsDialog->show();
+    statsDialog->raise();
+}
+
+void MainWindow::refreshStats() {
+    const Instrumentation* instrumentation = Instrumentation::getInstance();
+
+    auto addRow = [this](int row, const QString& name, const Instrumentation::Series& series) {
+        const auto ms = [](quint32 us) { return QString::number(us / 1000.0, 'f', 1); };
+        const QStringList cells = {
+            name,
+            QString::number(series.requests),
+            QString::number(series.replies),
+            QString::number(series.noData),
+            QString::number(series.errors),
+            QString::number(series.timeouts),
+            QString::number(series.retries),
+            ms(series.roundTripUs.percentile(0.50)),
+            ms(series.roundTripUs.percentile(0.99)),
+            ms(series.queueUs.percentile(0.99)),
+            QString::number(series.parseUs.percentile(0.99)),
+            QString::number(series.uiUs.percentile(0.99))
+        };
+        for (int column = 0; column < cells.size(); ++column) {
+            statsTable->setItem(row, column, new QTableWidgetItem(cells.at(column)));
+        }
+    };
+
+    // Modules first, then the commands sorted by name
+    const auto& modules = instrumentation->modules();
+    QStringList commands = instrumentation->commands().keys();
+    commands.sort();
+
+    statsTable->setRowCount(int(modules.size()) + int(commands.size()));
+    int row = 0;
+    for (int module = MODULE_UNKNOWN; module <= MODULE_RADIO; ++module) {
+        auto it = modules.constFind(module);
+        if (it != modules.constEnd()) {
+            addRow(row++, WJUtils::getModuleName(WJModule(module)), it.value());
+        }
+    }
+    for (const QString& command : commands) {
+        addRow(row++, "  " + command, *instrumentation->commands().constFind(command));
+    }
+    statsTable->resizeColumnsToContents();
+}
+
+void MainWindow::onSaveStatsClicked() {
+    // Next to settings.ini, like the recordings
+    const QString path = QDir::currentPath() + "/stats-" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".json";
+    if (Instrumentation::getInstance()->dump(path)) {
+        logWJData("✓ Statistics saved to " + path);
+    } else {
+        logWJData("❌ Could not write " + path);
+    }
+}
+
 void MainWindow::onExitClicked() {
     if (connected) {
         disconnectFromWJ();
@@ -1829,9 +2003,7 @@ void MainWindow::onReadingIntervalChanged(int intervalMs) {
     readingInterval = intervalMs;
     intervalLabel->setText(QString::number(intervalMs) + "ms");
 
-    if (continuousReadingTimer->isActive()) {
-        continuousReadingTimer->setInterval(intervalMs);
-    }
+    liveDataEngine->setMinCycleInterval(intervalMs);
 }
 
 void MainWindow::startContinuousReading() {
@@ -1839,60 +2011,76 @@ void MainWindow::startContinuousReading() {
         return;
     }
 
+    // The configured signals, of every module in one round-robin or just the selected one
+    QList<LiveSignal> signalSet;
+    QString error;
+    if (!LiveDataEngine::parseSignalSet(settingsManager->getSignalSet(), signalSet, error)) {
+        logWJData("⚠️ " + error + " - using the default signals");
+        signalSet = LiveDataEngine::defaultSignals();
+    }
+    WJModule pollModule = allModulesCheckBox->isChecked() ? MODULE_UNKNOWN : currentModule;
+    liveDataEngine->setSignalSet(LiveDataEngine::forModule(signalSet, pollModule));
+    liveDataEngine->setMinCycleInterval(readingInterval);
+
     logWJData("→ Starting continuous reading...");
-    continuousReadingTimer->setInterval(readingInterval);
-    continuousReadingTimer->start();
+    startRecording();
+    liveDataEngine->start();
 }
 
 void MainWindow::stopContinuousReading() {
-    if (continuousReadingTimer->isActive()) {
-        continuousReadingTimer->stop();
+    if (liveDataEngine && liveDataEngine->isRunning()) {
+        liveDataEngine->stop();
+        sampleRateLabel->setText("0.0 samples/s");
         logWJData("→ Stopped continuous reading");
     }
+    stopRecording();
 }
 
-void MainWindow::performContinuousRead() {
-    if (!connected || !initialized) {
-        stopContinuousReading();
+void MainWindow::startRecording() {
+    // One file per continuous reading session, next to settings.ini
+    const QString dir = QDir::currentPath() + "/recordings";
+    QDir().mkpath(dir);
+    const QString path = dir + "/wj-" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".wjr";
+
+    if (sensorRecorder->start(path)) {
+        logWJData("→ Recording to " + path);
+    } else {
+        logWJData("⚠️ Could not create recording " + path);
+    }
+}
+
+void MainWindow::stopRecording() {
+    if (!sensorRecorder->isRecording()) {
         return;
     }
 
-    // Read data based on current module
-    switch (currentModule) {
-    case MODULE_ENGINE_EDC15:
-        sendWJCommand(WJ::Engine::READ_MAF_DATA, MODULE_ENGINE_EDC15);
-        break;
-    case MODULE_TRANSMISSION:
-        sendWJCommand(WJ::Transmission::READ_TRANS_DATA, MODULE_TRANSMISSION);
-        break;
-    case MODULE_PCM:
-        sendWJCommand(WJ::PCM::READ_LIVE_DATA, MODULE_PCM);
-        break;
-    case MODULE_ABS:
-        sendWJCommand(WJ::ABS::READ_WHEEL_SPEEDS, MODULE_ABS);
-        break;
-    default:
-        break;
+    sensorRecorder->stop();
+    QString summary = QString("→ Recording saved (%1 KB)").arg(sensorRecorder->bytesWritten() / 1024);
+    if (sensorRecorder->droppedSamples() > 0) {
+        summary += QString(", %1 samples dropped").arg(sensorRecorder->droppedSamples());
+    }
+    logWJData(summary);
+}
+
+void MainWindow::onSampleRatesUpdated(const QMap<QString, double>& samplesPerSecond) {
+    double total = 0.0;
+    QStringList details;
+    for (auto it = samplesPerSecond.constBegin(); it != samplesPerSecond.constEnd(); ++it) {
+        total += it.value();
+        details.append(QString("%1: %2/s").arg(it.key()).arg(it.value(), 0, 'f', 1));
     }
+
+    sampleRateLabel->setText(QString("%1 samples/s").arg(total, 0, 'f', 1));
+    sampleRateLabel->setToolTip(details.join("\n"));
 }
 
 // Data Parsing Methods
 void MainWindow::parseEngineData(const QString& data) {
     if (data.isEmpty()) return;
 
-    // Use the WJDataParser to parse engine data
-    if (WJDataParser::parseEngineMAFData(data, sensorData)) {
-        updateEngineDisplay();
-    } else if (WJDataParser::parseEngineRailPressureData(data, sensorData)) {
-        updateEngineDisplay();
-    } else if (WJDataParser::parseEngineMAPData(data, sensorData)) {
-        updateEngineDisplay();
-    } else if (WJDataParser::parseEngineInjectorData(data, sensorData)) {
-        updateEngineDisplay();
-    } else if (WJDataParser::parseEngineMiscData(data, sensorData)) {
-        updateEngineDisplay();
-    } else if (WJDataParser::parseEngineBatteryVoltage(data, sensorData)) {
-        updateEngineDisplay();
+    // One hex decode, then straight to the decoder for the response's SID/local id
+    if (WJDataParser::decode(data, MODULE_ENGINE_EDC15, sensorData)) {
+        markSensorsDirty(MODULE_ENGINE_EDC15);
     } else if (data.startsWith("43")) {
         // Engine fault codes
         parseFaultCodes(data, MODULE_ENGINE_EDC15);
@@ -1902,13 +2090,9 @@ void MainWindow::parseEngineData(const QString& data) {
 void MainWindow::parseTransmissionData(const QString& data) {
     if (data.isEmpty()) return;
 
-    // Use the WJDataParser to parse transmission data
-    if (WJDataParser::parseTransmissionData(data, sensorData)) {
-        updateTransmissionDisplay();
-    } else if (WJDataParser::parseTransmissionSpeeds(data, sensorData)) {
-        updateTransmissionDisplay();
-    } else if (WJDataParser::parseTransmissionSolenoids(data, sensorData)) {
-        updateTransmissionDisplay();
+    // One hex decode, then straight to the decoder for the response's SID/local id
+    if (WJDataParser::decode(data, MODULE_TRANSMISSION, sensorData)) {
+        markSensorsDirty(MODULE_TRANSMISSION);
     } else if (data.startsWith("43")) {
         // Transmission fault codes
         parseFaultCodes(data, MODULE_TRANSMISSION);
@@ -1918,13 +2102,9 @@ void MainWindow::parseTransmissionData(const QString& data) {
 void MainWindow::parsePCMData(const QString& data) {
     if (data.isEmpty()) return;
 
-    // Use the WJDataParser to parse PCM data
-    if (WJDataParser::parsePCMData(data, sensorData)) {
-        updatePCMDisplay();
-    } else if (WJDataParser::parsePCMFuelTrim(data, sensorData)) {
-        updatePCMDisplay();
-    } else if (WJDataParser::parsePCMO2Sensors(data, sensorData)) {
-        updatePCMDisplay();
+    // One hex decode, then straight to the decoder for the response's SID/local id
+    if (WJDataParser::decode(data, MODULE_PCM, sensorData)) {
+        markSensorsDirty(MODULE_PCM);
     } else if (data.startsWith("43")) {
         // PCM fault codes
         parseFaultCodes(data, MODULE_PCM);
@@ -1934,11 +2114,9 @@ void MainWindow::parsePCMData(const QString& data) {
 void MainWindow::parseABSData(const QString& data) {
     if (data.isEmpty()) return;
 
-    // Use the WJDataParser to parse ABS data
-    if (WJDataParser::parseABSWheelSpeeds(data, sensorData)) {
-        updateABSDisplay();
-    } else if (WJDataParser::parseABSStabilityData(data, sensorData)) {
-        updateABSDisplay();
+    // One hex decode, then straight to the decoder for the response's SID/local id
+    if (WJDataParser::decode(data, MODULE_ABS, sensorData)) {
+        markSensorsDirty(MODULE_ABS);
     } else if (data.startsWith("43")) {
         // ABS fault codes
         parseFaultCodes(data, MODULE_ABS);
@@ -2042,160 +2220,117 @@ bool MainWindow::isImportantMessage(const QString& message)
 }
 
 // Display Update Methods
-void MainWindow::updateSensorDisplays() {
-    updateEngineDisplay();
-    updateTransmissionDisplay();
-    updatePCMDisplay();
-    updateABSDisplay();
-}
-
-void MainWindow::updateEngineDisplay() {
-    if (!sensorData.engine.dataValid) {
-        return; // Don't update if no valid data
-    }
-
-    // Add null pointer checks for ALL labels before calling setText()
-    if (mafActualLabel) {
-        mafActualLabel->setText(formatSensorValue(sensorData.engine.mafActual, "g/s", 1));
-    }
-    if (mafSpecifiedLabel) {
-        mafSpecifiedLabel->setText(formatSensorValue(sensorData.engine.mafSpecified, "g/s", 1));
-    }
-    if (railPressureActualLabel) {
-        railPressureActualLabel->setText(formatSensorValue(sensorData.engine.railPressureActual, "bar", 1));
-    }
-    if (railPressureSpecifiedLabel) {
-        railPressureSpecifiedLabel->setText(formatSensorValue(sensorData.engine.railPressureSpecified, "bar", 1));
-    }
-    if (mapActualLabel) {
-        mapActualLabel->setText(formatSensorValue(sensorData.engine.mapActual, "mbar", 0));
-    }
-    if (mapSpecifiedLabel) {
-        mapSpecifiedLabel->setText(formatSensorValue(sensorData.engine.mapSpecified, "mbar", 0));
-    }
-    if (coolantTempLabel) {
-        coolantTempLabel->setText(formatSensorValue(sensorData.engine.coolantTemp, "°C", 1));
-    }
-    if (intakeAirTempLabel) {
-        intakeAirTempLabel->setText(formatSensorValue(sensorData.engine.intakeAirTemp, "°C", 1));
-    }
-    if (throttlePositionLabel) {
-        throttlePositionLabel->setText(formatSensorValue(sensorData.engine.throttlePosition, "%", 1));
-    }
-    if (rpmLabel) {
-        rpmLabel->setText(formatSensorValue(sensorData.engine.engineRPM, "rpm", 0));
-    }
-    if (injectionQuantityLabel) {
-        injectionQuantityLabel->setText(formatSensorValue(sensorData.engine.injectionQuantity, "mg", 1));
-    }
-    if (batteryVoltageLabel) {
-        batteryVoltageLabel->setText(formatSensorValue(sensorData.engine.batteryVoltage, "V", 2));
+void MainWindow::markSensorsDirty(WJModule module) {
+    for (const WJSensorSignal &signal : WJSensorSignals::TABLE) {
+        if (signal.module == module) {
+            dirtySensors |= quint64(1) << signal.id;
+        }
     }
 
-    if (injector1Label) {
-        injector1Label->setText(formatSensorValue(sensorData.engine.injector1Correction, "mg", 2));
-    }
-    if (injector2Label) {
-        injector2Label->setText(formatSensorValue(sensorData.engine.injector2Correction, "mg", 2));
-    }
-    if (injector3Label) {
-        injector3Label->setText(formatSensorValue(sensorData.engine.injector3Correction, "mg", 2));
-    }
-    if (injector4Label) {
-        injector4Label->setText(formatSensorValue(sensorData.engine.injector4Correction, "mg", 2));
-    }
-    if (injector5Label) {
-        injector5Label->setText(formatSensorValue(sensorData.engine.injector5Correction, "mg", 2));
+    // Further decodes before the next frame only add bits
+    if (!displayTimer->isActive()) {
+        displayTimer->start();
     }
 }
 
-void MainWindow::updateTransmissionDisplay() {
-    if (!sensorData.transmission.dataValid) {
-        return;
-    }
-
-    if (transOilTempLabel) {
-        transOilTempLabel->setText(formatSensorValue(sensorData.transmission.oilTemp, "°C", 1));
-    }
-    if (transInputSpeedLabel) {
-        transInputSpeedLabel->setText(formatSensorValue(sensorData.transmission.inputSpeed, "rpm", 0));
-    }
-    if (transOutputSpeedLabel) {
-        transOutputSpeedLabel->setText(formatSensorValue(sensorData.transmission.outputSpeed, "rpm", 0));
-    }
-    if (transCurrentGearLabel) {
-        transCurrentGearLabel->setText(formatSensorValue(sensorData.transmission.currentGear, "", 0));
-    }
-    if (transLinePressureLabel) {
-        transLinePressureLabel->setText(formatSensorValue(sensorData.transmission.linePresssure, "psi", 1));
-    }
-    if (transSolenoidALabel) {
-        transSolenoidALabel->setText(formatSensorValue(sensorData.transmission.shiftSolenoidA, "%", 1));
-    }
-    if (transSolenoidBLabel) {
-        transSolenoidBLabel->setText(formatSensorValue(sensorData.transmission.shiftSolenoidB, "%", 1));
-    }
-    if (transTCCSolenoidLabel) {
-        transTCCSolenoidLabel->setText(formatSensorValue(sensorData.transmission.tccSolenoid, "%", 1));
+void MainWindow::invalidateSensorDisplays() {
+    // Labels were re-mapped or reset: every value is shown again on the next frame
+    shownLabelValues.clear();
+    for (const SensorDisplay &display : SENSOR_DISPLAYS) {
+        dirtySensors |= quint64(1) << display.sensor;
     }
-    if (transTorqueConverterLabel) {
-        transTorqueConverterLabel->setText(formatSensorValue(sensorData.transmission.torqueConverter, "%", 1));
+    if (!displayTimer->isActive()) {
+        displayTimer->start();
     }
 }
 
-void MainWindow::updatePCMDisplay() {
-    if (!sensorData.pcm.dataValid) {
-        return;
-    }
+void MainWindow::refreshSensorDisplays() {
+    const quint64 dirty = dirtySensors;
+    dirtySensors = 0;
 
-    if (vehicleSpeedLabel) {
-        vehicleSpeedLabel->setText(formatSensorValue(sensorData.pcm.vehicleSpeed, "km/h", 0));
-    }
-    if (engineLoadLabel) {
-        engineLoadLabel->setText(formatSensorValue(sensorData.pcm.engineLoad, "%", 1));
-    }
-    if (fuelTrimSTLabel) {
-        fuelTrimSTLabel->setText(formatSensorValue(sensorData.pcm.fuelTrimST, "%", 2));
-    }
-    if (fuelTrimLTLabel) {
-        fuelTrimLTLabel->setText(formatSensorValue(sensorData.pcm.fuelTrimLT, "%", 2));
-    }
-    if (o2Sensor1Label) {
-        o2Sensor1Label->setText(formatSensorValue(sensorData.pcm.o2Sensor1, "V", 3));
-    }
-    if (o2Sensor2Label) {
-        o2Sensor2Label->setText(formatSensorValue(sensorData.pcm.o2Sensor2, "V", 3));
-    }
-    if (timingAdvanceLabel) {
-        timingAdvanceLabel->setText(formatSensorValue(sensorData.pcm.timingAdvance, "°", 1));
-    }
-    if (barometricPressureLabel) {
-        barometricPressureLabel->setText(formatSensorValue(sensorData.pcm.barometricPressure, "kPa", 1));
-    }
-}
+    // SENSOR_DISPLAYS is grouped by module, so each module's labels are timed in one go
+    Instrumentation *instrumentation = Instrumentation::getInstance();
+    WJModule timedModule = MODULE_UNKNOWN;
+    qint64 startUs = 0;
 
-void MainWindow::updateABSDisplay() {
-    if (!sensorData.abs.dataValid) {
-        return;
-    }
+    for (const SensorDisplay &display : SENSOR_DISPLAYS) {
+        if (!(dirty & (quint64(1) << display.sensor))) {
+            continue;
+        }
+        const WJSensorSignal &signal = WJSensorSignals::TABLE[display.sensor];
+        if (signal.module != timedModule) {
+            const qint64 nowUs = instrumentation->nowUs();
+            if (timedModule != MODULE_UNKNOWN) {
+                instrumentation->recordUiUpdate(timedModule, nowUs - startUs);
+            }
+            timedModule = signal.module;
+            startUs = nowUs;
+        }
 
-    if (wheelSpeedFLLabel) {
-        wheelSpeedFLLabel->setText(formatSensorValue(sensorData.abs.wheelSpeedFL, "km/h", 1));
-    }
-    if (wheelSpeedFRLabel) {
-        wheelSpeedFRLabel->setText(formatSensorValue(sensorData.abs.wheelSpeedFR, "km/h", 1));
-    }
-    if (wheelSpeedRLLabel) {
-        wheelSpeedRLLabel->setText(formatSensorValue(sensorData.abs.wheelSpeedRL, "km/h", 1));
-    }
-    if (wheelSpeedRRLabel) {
-        wheelSpeedRRLabel->setText(formatSensorValue(sensorData.abs.wheelSpeedRR, "km/h", 1));
-    }
-    if (yawRateLabel) {
-        yawRateLabel->setText(formatSensorValue(sensorData.abs.yawRate, "deg/s", 2));
-    }
-    if (lateralAccelLabel) {
-        lateralAccelLabel->setText(formatSensorValue(sensorData.abs.lateralAccel, "g", 3));
+        QLabel *label = sensorLabel(display.sensor);
+        if (!label || !hasValidData(sensorData, signal.module)) {
+            continue;
+        }
+
+        // Compared at the shown precision, so noise below the last digit costs no text layout
+        const double value = signal.read(sensorData);
+        const qint64 shown = qRound64(value * DISPLAY_SCALE[display.decimals]);
+        auto shownIt = shownLabelValues.find(label);
+        if (shownIt != shownLabelValues.end() && *shownIt == shown) {
+            continue;
+        }
+        shownLabelValues.insert(label, shown);
+        label->setText(formatSensorValue(value, display.unit, display.decimals));
+    }
+
+    if (timedModule != MODULE_UNKNOWN) {
+        instrumentation->recordUiUpdate(timedModule, instrumentation->nowUs() - startUs);
+    }
+}
+
+QLabel* MainWindow::sensorLabel(quint16 sensor) const {
+    switch (sensor) {
+    case SENSOR_ENGINE_MAF_ACTUAL: return mafActualLabel;
+    case SENSOR_ENGINE_MAF_SPECIFIED: return mafSpecifiedLabel;
+    case SENSOR_ENGINE_RAIL_PRESSURE_ACTUAL: return railPressureActualLabel;
+    case SENSOR_ENGINE_RAIL_PRESSURE_SPECIFIED: return railPressureSpecifiedLabel;
+    case SENSOR_ENGINE_MAP_ACTUAL: return mapActualLabel;
+    case SENSOR_ENGINE_MAP_SPECIFIED: return mapSpecifiedLabel;
+    case SENSOR_ENGINE_COOLANT_TEMP: return coolantTempLabel;
+    case SENSOR_ENGINE_INTAKE_AIR_TEMP: return intakeAirTempLabel;
+    case SENSOR_ENGINE_THROTTLE_POSITION: return throttlePositionLabel;
+    case SENSOR_ENGINE_RPM: return rpmLabel;
+    case SENSOR_ENGINE_INJECTION_QUANTITY: return injectionQuantityLabel;
+    case SENSOR_ENGINE_BATTERY_VOLTAGE: return batteryVoltageLabel;
+    case SENSOR_ENGINE_INJECTOR1_CORRECTION: return injector1Label;
+    case SENSOR_ENGINE_INJECTOR2_CORRECTION: return injector2Label;
+    case SENSOR_ENGINE_INJECTOR3_CORRECTION: return injector3Label;
+    case SENSOR_ENGINE_INJECTOR4_CORRECTION: return injector4Label;
+    case SENSOR_ENGINE_INJECTOR5_CORRECTION: return injector5Label;
+    case SENSOR_TRANS_OIL_TEMP: return transOilTempLabel;
+    case SENSOR_TRANS_INPUT_SPEED: return transInputSpeedLabel;
+    case SENSOR_TRANS_OUTPUT_SPEED: return transOutputSpeedLabel;
+    case SENSOR_TRANS_CURRENT_GEAR: return transCurrentGearLabel;
+    case SENSOR_TRANS_LINE_PRESSURE: return transLinePressureLabel;
+    case SENSOR_TRANS_SHIFT_SOLENOID_A: return transSolenoidALabel;
+    case SENSOR_TRANS_SHIFT_SOLENOID_B: return transSolenoidBLabel;
+    case SENSOR_TRANS_TCC_SOLENOID: return transTCCSolenoidLabel;
+    case SENSOR_TRANS_TORQUE_CONVERTER: return transTorqueConverterLabel;
+    case SENSOR_PCM_VEHICLE_SPEED: return vehicleSpeedLabel;
+    case SENSOR_PCM_ENGINE_LOAD: return engineLoadLabel;
+    case SENSOR_PCM_FUEL_TRIM_ST: return fuelTrimSTLabel;
+    case SENSOR_PCM_FUEL_TRIM_LT: return fuelTrimLTLabel;
+    case SENSOR_PCM_O2_SENSOR1: return o2Sensor1Label;
+    case SENSOR_PCM_O2_SENSOR2: return o2Sensor2Label;
+    case SENSOR_PCM_TIMING_ADVANCE: return timingAdvanceLabel;
+    case SENSOR_PCM_BAROMETRIC_PRESSURE: return barometricPressureLabel;
+    case SENSOR_ABS_WHEEL_SPEED_FL: return wheelSpeedFLLabel;
+    case SENSOR_ABS_WHEEL_SPEED_FR: return wheelSpeedFRLabel;
+    case SENSOR_ABS_WHEEL_SPEED_RL: return wheelSpeedRLLabel;
+    case SENSOR_ABS_WHEEL_SPEED_RR: return wheelSpeedRRLabel;
+    case SENSOR_ABS_YAW_RATE: return yawRateLabel;
+    case SENSOR_ABS_LATERAL_ACCEL: return lateralAccelLabel;
+    default: return nullptr;
     }
 }
 
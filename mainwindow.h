@@ -12,7 +12,9 @@
 #include <QCheckBox>
 #include <QLineEdit>
 #include <QSlider>
-#include <QTextBrowser>
+#include <QListView>
+#include <QDialog>
+#include <QTableWidget>
 #include <QSpacerItem>
 #include <QTimer>
 #include <QScreen>
@@ -64,6 +66,11 @@
 class ELM;
 class SettingsManager;
 class ConnectionManager;
+class ElmInterface;
+class LiveDataEngine;
+class SensorRecorder;
+class LogModel;
+class WJInitSession;
 
 enum LogLevel {
     LOG_MINIMAL,    // Only critical events
@@ -108,12 +115,22 @@ private slots:
     void onClearTerminalClicked();
     void onExitClicked();
 
+    // Request timing and error counts (Instrumentation)
+    void onStatsClicked();
+    void onSignalsClicked();
+    void refreshStats();
+    void onSaveStatsClicked();
+
     // Connection events
     void onConnected();
     void onDisconnected();
-    void onDataReceived(const QString& data);
+    void onResponseReceived(quint32 id, const QString& command, WJModule module, const QStringList& lines);
+    void onMessageReceived(quint32 id, WJModule module, QByteArrayView message);
+    void decodeMessage(quint32 id, WJModule module, QByteArrayView message);
+    void onRequestTimedOut(quint32 id, const QString& command);
+    void onProtocolSwitched(WJProtocol protocol, bool ok, bool usedReset, qint64 elapsedMs);
     void onConnectionStateChanged(const QString& state);
-    void processDataLine(const QString& line);
+    void processDataLine(const QString& line, WJModule module = MODULE_UNKNOWN, bool parse = true);
 
     // WJ initialization timer
     void onInitializationTimeout();
@@ -158,10 +175,9 @@ private:
 
     // WJ Communication methods
     bool initializeWJCommunication();
-    void setupWJInitializationCommands();
-    void processWJInitResponse(const QString& response);
+    void completeWJInitialization();
     void sendWJCommand(const QString& command, WJModule targetModule = MODULE_UNKNOWN);
-    void parseWJResponse(const QString& response);
+    void parseWJResponse(const QString& response, WJModule module = MODULE_UNKNOWN);
 
     // Enhanced data parsing methods
     void parseEngineData(const QString& data);
@@ -178,11 +194,10 @@ private:
     bool validateWJResponse(const QString& response, const QString& expectedStart);
     void logWJData(const QString& message);
     bool isImportantMessage(const QString& message);
-    void updateSensorDisplays();
-    void updateEngineDisplay();
-    void updateTransmissionDisplay();
-    void updatePCMDisplay();
-    void updateABSDisplay();
+    void markSensorsDirty(WJModule module);
+    void invalidateSensorDisplays();
+    void refreshSensorDisplays();
+    QLabel* sensorLabel(quint16 sensor) const;
     QString formatSensorValue(double value, const QString& unit, int decimals = 1);
 
     // Connection management
@@ -193,18 +208,14 @@ private:
     // Continuous reading
     void startContinuousReading();
     void stopContinuousReading();
-    void performContinuousRead();
+    void startRecording();
+    void stopRecording();
+    void onSampleRatesUpdated(const QMap<QString, double>& samplesPerSecond);
 
     // Fault code management - simplified
     void displayFaultCodes(const QList<WJ_DTC>& dtcs, const QString& moduleLabel);
     void clearFaultCodesForModule(WJModule module);
 
-    // Simplified command execution methods
-    void executeEngineCommands();
-    void executeTransmissionCommands();
-    void executePCMCommands();
-    void executeABSCommands();
-
 private:
     // Main UI Panels - Car Stereo Layout
     QWidget* centralWidget;
@@ -294,30 +305,45 @@ private:
     QCheckBox* continuousReadingCheckBox;
     QSlider* readingIntervalSlider;
     QLabel* intervalLabel;
-    QTextBrowser* terminalDisplay;
+    QCheckBox* allModulesCheckBox;
+    QLabel* sampleRateLabel;
+    QListView* terminalDisplay;
+    LogModel* logModel{nullptr};
 
     // Advanced/Manual Controls (shown in right panel)
     QLineEdit* commandLineEdit;
     QPushButton* sendCommandButton;
     QPushButton* clearTerminalButton;
+    QPushButton* statsButton;
+    QPushButton* signalsButton;
     QPushButton* exitButton;
 
+    // Stats panel, created on first use
+    QDialog* statsDialog{nullptr};
+    QTableWidget* statsTable{nullptr};
+    QTimer* statsTimer{nullptr};
+
     // Core components
     ELM* elm;
     SettingsManager* settingsManager;
     ConnectionManager* connectionManager;
+    ElmInterface* elmInterface;
+    LiveDataEngine* liveDataEngine;
+    SensorRecorder* sensorRecorder;
+    WJInitSession* initSession;
 
     // WJ specific members
-    QList<WJCommand> initializationCommands;
     WJInitState currentInitState;
-    int currentInitStep;
     QTimer* initializationTimer;
-    QTimer* continuousReadingTimer;
     QString lastSentCommand;
-    QString currentECUHeader;
-    bool engineSecurityAccessGranted;
+    quint32 streamDecodedId{0};   // response whose message was already decoded from messageReceived
     WJSensorData sensorData;
 
+    // Decodes only mark signals dirty; displayTimer redraws the changed labels once per frame
+    QTimer* displayTimer;
+    quint64 dirtySensors{0};          // one bit per WJSensorId
+    QHash<QLabel*, qint64> shownLabelValues;  // value on each label, in units of its last shown digit
+
     // Protocol and module state
     WJProtocol currentProtocol;
     WJModule currentModule;
@@ -332,7 +358,6 @@ private:
     // Screen properties
     QRect desktopRect;
     LogLevel currentLogLevel = LOG_MINIMAL;
-    QString dataBuffer;
 
     // Car stereo specific settings
     bool showAdvancedControls = false;
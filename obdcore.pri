@@ -0,0 +1,65 @@
+# Everything below the UI: transports, ELM protocol handling, decoding, polling, recording.
+# Shared by the widget app (ObdReader.pro) and the headless logger (obdreaderd/obdreaderd.pro).
+
+QT += core network bluetooth
+CONFIG += c++17
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/connectionmanager.cpp \
+    $$PWD/elm.cpp \
+    $$PWD/elmadapterstate.cpp \
+    $$PWD/elmbluetoothmanager.cpp \
+    $$PWD/elmerror.cpp \
+    $$PWD/elmframer.cpp \
+    $$PWD/elminterface.cpp \
+    $$PWD/elmmessageassembler.cpp \
+    $$PWD/elmresponse.cpp \
+    $$PWD/elmsimulator.cpp \
+    $$PWD/elmtcpsocket.cpp \
+    $$PWD/global.cpp \
+    $$PWD/hexdecode.cpp \
+    $$PWD/instrumentation.cpp \
+    $$PWD/latencymodel.cpp \
+    $$PWD/livedataengine.cpp \
+    $$PWD/pidbatcher.cpp \
+    $$PWD/replaytransport.cpp \
+    $$PWD/sensorrecorder.cpp \
+    $$PWD/settingsmanager.cpp \
+    $$PWD/simulatortransport.cpp \
+    $$PWD/trafficcapture.cpp \
+    $$PWD/transportworker.cpp \
+    $$PWD/vehicleprofile.cpp \
+    $$PWD/wjcommandtable.cpp \
+    $$PWD/wjinitsession.cpp
+
+HEADERS += \
+    $$PWD/connectionmanager.h \
+    $$PWD/elm.h \
+    $$PWD/elmadapterstate.h \
+    $$PWD/elmbluetoothmanager.h \
+    $$PWD/elmerror.h \
+    $$PWD/elmframer.h \
+    $$PWD/elminterface.h \
+    $$PWD/elmmessageassembler.h \
+    $$PWD/elmresponse.h \
+    $$PWD/elmsimulator.h \
+    $$PWD/elmtcpsocket.h \
+    $$PWD/global.h \
+    $$PWD/hexdecode.h \
+    $$PWD/instrumentation.h \
+    $$PWD/latencyhistogram.h \
+    $$PWD/latencymodel.h \
+    $$PWD/livedataengine.h \
+    $$PWD/pidbatcher.h \
+    $$PWD/replaytransport.h \
+    $$PWD/sensorrecorder.h \
+    $$PWD/settingsmanager.h \
+    $$PWD/simulatortransport.h \
+    $$PWD/spscqueue.h \
+    $$PWD/trafficcapture.h \
+    $$PWD/transportworker.h \
+    $$PWD/vehicleprofile.h \
+    $$PWD/wjcommandtable.h \
+    $$PWD/wjinitsession.h
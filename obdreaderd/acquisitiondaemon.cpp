@@ -0,0 +1,411 @@
+#include "acquisitiondaemon.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+#include <algorithm>
+#include <cmath>
+#include "connectionmanager.h"
+#include "elm.h"
+#include "elminterface.h"
+#include "instrumentation.h"
+#include "livedataengine.h"
+#include "settingsmanager.h"
+#include "wjinitsession.h"
+
+namespace {
+
+// Same budget as the widget app: after that, poll with whatever the init achieved
+const int INIT_TIMEOUT_MS = 30000;
+// Unchanged values are repeated this often so readers can tell "steady" from "gone"
+const qint64 KEEPALIVE_MS = 1000;
+const int STATS_INTERVAL_MS = 60000;
+
+} // namespace
+
+bool DaemonConfig::load(const QString &path, DaemonConfig &config, QString &error)
+{
+    if (!QFileInfo::exists(path)) {
+        error = "Configuration not found: " + path;
+        return false;
+    }
+
+    QSettings settings(path, QSettings::IniFormat);
+    if (settings.status() != QSettings::NoError) {
+        error = "Cannot parse configuration: " + path;
+        return false;
+    }
+
+    settings.beginGroup("connection");
+    const QString type = settings.value("type", "wifi").toString().toLower();
+    if (type == "wifi") {
+        config.connectionType = Wifi;
+    } else if (type == "bluetooth") {
+        config.connectionType = BlueTooth;
+    } else if (type == "replay") {
+        config.connectionType = Replay;
+    } else if (type == "simulator") {
+        config.connectionType = Simulator;
+    } else {
+        error = "Unknown connection type: " + type;
+        return false;
+    }
+    config.host = settings.value("host", config.host).toString();
+    config.port = quint16(settings.value("port", config.port).toUInt());
+    config.bluetoothAddress = settings.value("bluetooth").toString();
+    config.replayPath = settings.value("replay").toString();
+    config.realTime = settings.value("realTime", config.realTime).toBool();
+    config.simulatorSeed = settings.value("simulatorSeed", config.simulatorSeed).toUInt();
+    config.simulatorFaults = qBound(0.0, settings.value("simulatorFaults", 0.0).toDouble(), 1.0);
+    config.reconnectMs = settings.value("reconnectMs", config.reconnectMs).toInt();
+    settings.endGroup();
+
+    if (config.connectionType == BlueTooth && config.bluetoothAddress.isEmpty()) {
+        error = "connection/bluetooth must name the adapter";
+        return false;
+    }
+    if (config.connectionType == Replay && config.replayPath.isEmpty()) {
+        error = "connection/replay must name a capture";
+        return false;
+    }
+
+    settings.beginGroup("acquisition");
+    config.modules.clear();
+    const QStringList modules = settings.value("modules", "all").toString().toLower().split(',', Qt::SkipEmptyParts);
+    for (const QString &name : modules) {
+        const QString module = name.trimmed();
+        if (module == "all") {
+            config.modules.clear();
+            break;
+        } else if (module == "engine") {
+            config.modules.append(MODULE_ENGINE_EDC15);
+        } else if (module == "transmission") {
+            config.modules.append(MODULE_TRANSMISSION);
+        } else if (module == "pcm") {
+            config.modules.append(MODULE_PCM);
+        } else if (module == "abs") {
+            config.modules.append(MODULE_ABS);
+        } else {
+            error = "Unknown module: " + module;
+            return false;
+        }
+    }
+    config.intervalMs = qMax(0, settings.value("intervalMs", config.intervalMs).toInt());
+    // QSettings splits an unquoted list at the commas
+    const QString signalSpec = settings.value("signals").toStringList().join(',');
+    if (!LiveDataEngine::parseSignalSet(signalSpec, config.signalSet, error)) {
+        return false;
+    }
+    settings.endGroup();
+
+    settings.beginGroup("output");
+    config.format = settings.value("format", "csv").toString().toLower() == "json" ? SampleOutput::Json : SampleOutput::Csv;
+    config.toStdout = settings.value("stdout", config.toStdout).toBool();
+    config.filePath = settings.value("file").toString();
+    config.listenPort = quint16(settings.value("listen", 0).toUInt());
+    config.recordingDir = settings.value("recordings").toString();
+    config.statsPath = settings.value("stats").toString();
+    settings.endGroup();
+
+    return true;
+}
+
+AcquisitionDaemon::AcquisitionDaemon(const DaemonConfig &config, QObject *parent)
+    : QObject(parent)
+    , m_config(config)
+{
+    std::fill(std::begin(m_lastValues), std::end(m_lastValues), std::nan(""));
+    std::fill(std::begin(m_lastPublishedMs), std::end(m_lastPublishedMs), qint64(0));
+    m_sensorData.reset();
+
+    m_connectionManager = ConnectionManager::getInstance();
+    m_elmInterface = ElmInterface::getInstance();
+    m_liveDataEngine = new LiveDataEngine(m_elmInterface, this);
+    m_initSession = new WJInitSession(this);
+
+    connect(m_connectionManager, &ConnectionManager::connected, this, &AcquisitionDaemon::onConnected);
+    connect(m_connectionManager, &ConnectionManager::disconnected, this, &AcquisitionDaemon::onDisconnected);
+    connect(m_connectionManager, &ConnectionManager::stateChanged, this, &AcquisitionDaemon::log);
+    connect(m_elmInterface, &ElmInterface::responseReceived, this, &AcquisitionDaemon::onResponseReceived);
+    connect(m_elmInterface, &ElmInterface::messageReceived, this, &AcquisitionDaemon::onMessageReceived);
+    connect(m_elmInterface, &ElmInterface::requestTimedOut, this, &AcquisitionDaemon::onRequestTimedOut);
+    connect(m_liveDataEngine, &LiveDataEngine::pidMessageReceived, this, &AcquisitionDaemon::decodeMessage);
+    connect(m_initSession, &WJInitSession::logMessage, this, &AcquisitionDaemon::log);
+    connect(m_initSession, &WJInitSession::completed, this, &AcquisitionDaemon::onInitCompleted);
+
+    m_initTimer.setSingleShot(true);
+    m_initTimer.setInterval(INIT_TIMEOUT_MS);
+    connect(&m_initTimer, &QTimer::timeout, this, &AcquisitionDaemon::onInitTimeout);
+
+    m_reconnectTimer.setSingleShot(true);
+    connect(&m_reconnectTimer, &QTimer::timeout, this, &AcquisitionDaemon::connectAdapter);
+
+    m_statsTimer.setInterval(STATS_INTERVAL_MS);
+    connect(&m_statsTimer, &QTimer::timeout, this, &AcquisitionDaemon::dumpStats);
+}
+
+AcquisitionDaemon::~AcquisitionDaemon()
+{
+    stop();
+}
+
+bool AcquisitionDaemon::openOutputs(QString &error)
+{
+    m_output.setFormat(m_config.format);
+    if (m_config.toStdout && !m_output.openStdout()) {
+        error = "Cannot write to stdout";
+        return false;
+    }
+    if (!m_config.filePath.isEmpty() && !m_output.openFile(m_config.filePath)) {
+        error = "Cannot open " + m_config.filePath;
+        return false;
+    }
+    if (m_config.listenPort != 0 && !m_output.listen(m_config.listenPort)) {
+        error = QString("Cannot listen on port %1").arg(m_config.listenPort);
+        return false;
+    }
+    if (!m_config.recordingDir.isEmpty() && !QDir().mkpath(m_config.recordingDir)) {
+        error = "Cannot create " + m_config.recordingDir;
+        return false;
+    }
+    return true;
+}
+
+void AcquisitionDaemon::start()
+{
+    m_stopping = false;
+    if (!m_config.statsPath.isEmpty()) {
+        m_statsTimer.start();
+    }
+
+    switch (m_config.connectionType) {
+    case Wifi: {
+        // Only for this process: the shared settings.ini is left alone
+        SettingsManager *settings = SettingsManager::getInstance();
+        settings->setWifiIp(m_config.host);
+        settings->setWifiPort(m_config.port);
+        break;
+    }
+    case Replay:
+        m_connectionManager->setReplayTrace(m_config.replayPath, m_config.realTime);
+        break;
+    case Simulator: {
+        ElmSimulatorConfig simulator;
+        simulator.seed = m_config.simulatorSeed;
+        simulator.noDataRate = m_config.simulatorFaults;
+        simulator.busErrorRate = m_config.simulatorFaults / 2;
+        m_connectionManager->setSimulator(simulator, m_config.realTime);
+        break;
+    }
+    default:
+        break;
+    }
+    m_connectionManager->setConnectionType(m_config.connectionType);
+
+    connectAdapter();
+}
+
+void AcquisitionDaemon::stop()
+{
+    if (m_stopping) {
+        return;
+    }
+    m_stopping = true;
+    m_reconnectTimer.stop();
+    m_initTimer.stop();
+
+    if (m_polling) {
+        m_liveDataEngine->stop();
+        m_polling = false;
+        m_initSession->saveProfile();
+    }
+    m_recorder.stop();
+    m_output.flush();
+    m_statsTimer.stop();
+    dumpStats();
+
+    if (m_connected) {
+        m_elmInterface->clearQueue();
+        m_connectionManager->disConnectElm();
+        m_connected = false;
+    }
+}
+
+void AcquisitionDaemon::connectAdapter()
+{
+    if (m_stopping) {
+        return;
+    }
+
+    log("→ Connecting...");
+    if (m_config.connectionType == BlueTooth) {
+        m_connectionManager->connectElm(m_config.bluetoothAddress);
+    } else {
+        m_connectionManager->connectElm();
+    }
+}
+
+void AcquisitionDaemon::onConnected()
+{
+    m_connected = true;
+    log("✓ Connected to " + m_connectionManager->endpoint());
+
+    if (!m_initSession->start(m_connectionManager->endpoint())) {
+        log("❌ Failed to start initialization");
+        return;
+    }
+    m_initTimer.start();
+}
+
+void AcquisitionDaemon::onDisconnected()
+{
+    const bool wasConnected = m_connected;
+    m_connected = false;
+    m_initTimer.stop();
+
+    if (m_polling) {
+        m_liveDataEngine->stop();
+        m_polling = false;
+        m_initSession->saveProfile();
+    }
+    m_recorder.stop();
+    m_elmInterface->clearQueue();
+    m_output.flush();
+
+    if (m_stopping) {
+        return;
+    }
+
+    if (wasConnected) {
+        log("✗ Disconnected");
+    }
+    if (m_config.reconnectMs > 0) {
+        m_reconnectTimer.start(m_config.reconnectMs);
+    } else {
+        QCoreApplication::exit(wasConnected ? 0 : 1);
+    }
+}
+
+void AcquisitionDaemon::onInitCompleted()
+{
+    m_initTimer.stop();
+    log(QString("✓ Initialization completed, engine security access: %1")
+            .arg(m_initSession->securityGranted() ? "granted" : "limited"));
+
+    ELM *elm = ELM::getInstance();
+    m_liveDataEngine->setSupportedPids(elm->pidsChecked() ? elm->supportedPids() : std::bitset<256>());
+    startPolling();
+}
+
+void AcquisitionDaemon::onInitTimeout()
+{
+    log("⚠️ Initialization timeout - polling anyway");
+    startPolling();
+}
+
+void AcquisitionDaemon::startPolling()
+{
+    if (m_polling || !m_connected) {
+        return;
+    }
+
+    QList<LiveSignal> signalSet;
+    if (m_config.modules.isEmpty()) {
+        signalSet = m_config.signalSet;
+    } else {
+        for (WJModule module : m_config.modules) {
+            signalSet += LiveDataEngine::forModule(m_config.signalSet, module);
+        }
+    }
+    m_liveDataEngine->setSignalSet(signalSet);
+    m_liveDataEngine->setMinCycleInterval(m_config.intervalMs);
+
+    if (!m_config.recordingDir.isEmpty()) {
+        const QString path = m_config.recordingDir + "/wj-" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".wjr";
+        log(m_recorder.start(path) ? "→ Recording to " + path : "⚠️ Could not create recording " + path);
+    }
+
+    m_polling = true;
+    m_liveDataEngine->start();
+    log(QString("→ Polling %1 signals").arg(signalSet.size()));
+}
+
+void AcquisitionDaemon::onResponseReceived(quint32 id, const QString &command, WJModule module, const QStringList &lines)
+{
+    Q_UNUSED(module);
+
+    if (m_initSession->isRunning()) {
+        m_initSession->handleResponse(id, command, lines.join(' '));
+        return;
+    }
+
+    // Adapter readings (ATRV) have no ECU message; they decode from the text
+    if (m_polling && command.startsWith("AT")
+        && WJDataParser::decode(lines.join(' '), MODULE_ENGINE_EDC15, m_sensorData)) {
+        publish(MODULE_ENGINE_EDC15);
+    }
+}
+
+void AcquisitionDaemon::onMessageReceived(quint32 id, WJModule module, QByteArrayView message)
+{
+    // Batched mode 01 replies come back one PID at a time through pidMessageReceived
+    if (!m_liveDataEngine->isBatched(id)) {
+        decodeMessage(id, module, message);
+    }
+}
+
+void AcquisitionDaemon::decodeMessage(quint32 id, WJModule module, QByteArrayView message)
+{
+    Q_UNUSED(id);
+    if (!m_polling) {
+        return;
+    }
+
+    if (WJDataParser::decode(reinterpret_cast<const quint8*>(message.data()), int(message.size()), module, m_sensorData)) {
+        publish(module);
+    }
+}
+
+void AcquisitionDaemon::onRequestTimedOut(quint32 id, const QString &command)
+{
+    if (m_initSession->isRunning()) {
+        m_initSession->handleResponse(id, command, QString());
+    }
+}
+
+void AcquisitionDaemon::publish(WJModule module)
+{
+    m_recorder.record(m_sensorData, module);
+
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    for (const WJSensorSignal &signal : WJSensorSignals::TABLE) {
+        if (signal.module != module) {
+            continue;
+        }
+
+        // Compared at the precision that is printed, so noise below it doesn't count as a change
+        const double scale = std::pow(10.0, signal.decimals);
+        const double value = std::round(signal.read(m_sensorData) * scale) / scale;
+        if (value == m_lastValues[signal.id] && nowMs - m_lastPublishedMs[signal.id] < KEEPALIVE_MS) {
+            continue;
+        }
+        m_lastValues[signal.id] = value;
+        m_lastPublishedMs[signal.id] = nowMs;
+        m_output.write(nowMs, signal, value);
+    }
+    m_output.flush();
+}
+
+void AcquisitionDaemon::dumpStats()
+{
+    if (!m_config.statsPath.isEmpty() && !Instrumentation::getInstance()->dump(m_config.statsPath)) {
+        log("⚠️ Could not write " + m_config.statsPath);
+    }
+}
+
+void AcquisitionDaemon::log(const QString &message)
+{
+    // stdout carries the samples; everything else goes to stderr
+    qInfo().noquote() << QDateTime::currentDateTime().toString(Qt::ISODateWithMs) << message;
+}
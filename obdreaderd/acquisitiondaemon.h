@@ -0,0 +1,97 @@
+#ifndef ACQUISITIONDAEMON_H
+#define ACQUISITIONDAEMON_H
+
+#include <QObject>
+#include <QByteArrayView>
+#include <QList>
+#include <QTimer>
+#include "global.h"
+#include "livedataengine.h"
+#include "sampleoutput.h"
+#include "sensorrecorder.h"
+#include "transportworker.h"
+
+class ConnectionManager;
+class ElmInterface;
+class WJInitSession;
+
+// Settings of one obdreaderd instance, read from an ini file (see obdreaderd.ini)
+struct DaemonConfig {
+    ConnectionType connectionType{Wifi};
+    QString host{"192.168.0.10"};
+    quint16 port{35000};
+    QString bluetoothAddress;
+    QString replayPath;
+    bool realTime{true};
+    quint32 simulatorSeed{1};
+    double simulatorFaults{0.0};
+    int reconnectMs{5000};
+
+    QList<WJModule> modules;          // empty = all
+    QList<LiveSignal> signalSet{LiveDataEngine::defaultSignals()};
+    int intervalMs{0};
+
+    SampleOutput::Format format{SampleOutput::Csv};
+    bool toStdout{true};
+    QString filePath;
+    quint16 listenPort{0};
+    QString recordingDir;
+    QString statsPath;
+
+    static bool load(const QString &path, DaemonConfig &config, QString &error);
+};
+
+// Headless acquisition: connect, initialize the vehicle, then poll the configured modules
+// with LiveDataEngine and publish every value that changed (or at least once a second).
+// Same ConnectionManager, ElmInterface, WJInitSession and WJDataParser as the widget app.
+// Reconnects after the adapter goes away unless reconnectMs is 0, which ends the process.
+class AcquisitionDaemon : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AcquisitionDaemon(const DaemonConfig &config, QObject *parent = nullptr);
+    ~AcquisitionDaemon();
+
+    // Opens the outputs; false if one of them can't be
+    bool openOutputs(QString &error);
+
+    void start();
+    void stop();
+
+private slots:
+    void onConnected();
+    void onDisconnected();
+    void onInitCompleted();
+    void onInitTimeout();
+    void onResponseReceived(quint32 id, const QString &command, WJModule module, const QStringList &lines);
+    void onMessageReceived(quint32 id, WJModule module, QByteArrayView message);
+    void decodeMessage(quint32 id, WJModule module, QByteArrayView message);
+    void onRequestTimedOut(quint32 id, const QString &command);
+    void dumpStats();
+    void log(const QString &message);
+
+private:
+    void connectAdapter();
+    void startPolling();
+    void publish(WJModule module);
+
+    DaemonConfig m_config;
+    ConnectionManager *m_connectionManager{};
+    ElmInterface *m_elmInterface{};
+    LiveDataEngine *m_liveDataEngine{};
+    WJInitSession *m_initSession{};
+    SampleOutput m_output;
+    SensorRecorder m_recorder;
+    QTimer m_initTimer;
+    QTimer m_reconnectTimer;
+    QTimer m_statsTimer;
+    bool m_connected{false};
+    bool m_polling{false};
+    bool m_stopping{false};
+
+    WJSensorData m_sensorData;
+    double m_lastValues[SENSOR_COUNT];
+    qint64 m_lastPublishedMs[SENSOR_COUNT];
+};
+
+#endif // ACQUISITIONDAEMON_H
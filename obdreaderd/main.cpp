@@ -0,0 +1,100 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <csignal>
+#include "acquisitiondaemon.h"
+#include "connectionmanager.h"
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef Q_OS_UNIX
+// Self-pipe: the handler only writes a byte (async-signal-safe), the event loop reads it and quits
+int signalSockets[2] = {-1, -1};
+
+void quitOnSignal(int)
+{
+    const char byte = 1;
+    [[maybe_unused]] const ssize_t written = ::write(signalSockets[0], &byte, sizeof(byte));
+}
+
+bool installQuitSignals(QCoreApplication &app)
+{
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, signalSockets) != 0) {
+        return false;
+    }
+    auto *notifier = new QSocketNotifier(signalSockets[1], QSocketNotifier::Read, &app);
+    QObject::connect(notifier, &QSocketNotifier::activated, &app, [notifier] {
+        notifier->setEnabled(false);
+        char byte;
+        [[maybe_unused]] const ssize_t read = ::read(signalSockets[1], &byte, sizeof(byte));
+        QCoreApplication::quit();
+    });
+
+    struct sigaction action = {};
+    action.sa_handler = quitOnSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    return ::sigaction(SIGINT, &action, nullptr) == 0 && ::sigaction(SIGTERM, &action, nullptr) == 0;
+}
+#else
+// Windows runs console signal handlers on a thread of their own, so a queued call is safe
+void quitOnSignal(int)
+{
+    QMetaObject::invokeMethod(QCoreApplication::instance(), &QCoreApplication::quit, Qt::QueuedConnection);
+}
+
+bool installQuitSignals(QCoreApplication &app)
+{
+    Q_UNUSED(app);
+    return std::signal(SIGINT, quitOnSignal) != SIG_ERR && std::signal(SIGTERM, quitOnSignal) != SIG_ERR;
+}
+#endif
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // Setup the software details used by the settings system
+    app.setOrganizationName("Türkay Biliyor");
+    app.setOrganizationDomain("www.turkaybiliyor.com");
+    app.setApplicationName("obdreaderd");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless Jeep WJ data logger: samples to stdout, a file or a TCP port.");
+    parser.addHelpOption();
+    QCommandLineOption configOption({"c", "config"}, "Read settings from <file>.", "file", "obdreaderd.ini");
+    QCommandLineOption captureOption("capture", "Write raw adapter traffic to <file>.", "file");
+    parser.addOptions({configOption, captureOption});
+    parser.process(app);
+
+    DaemonConfig config;
+    QString error;
+    if (!DaemonConfig::load(parser.value(configOption), config, error)) {
+        qCritical().noquote() << error;
+        return 1;
+    }
+
+    AcquisitionDaemon daemon(config);
+    if (!daemon.openOutputs(error)) {
+        qCritical().noquote() << error;
+        return 1;
+    }
+    if (parser.isSet(captureOption)) {
+        ConnectionManager::getInstance()->startCapture(parser.value(captureOption));
+    }
+
+    // Ctrl+C / systemd stop: leave through the event loop so recordings and the profile are saved
+    if (!installQuitSignals(app)) {
+        qWarning() << "Cannot handle SIGINT/SIGTERM; the daemon stops without saving";
+    }
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, &daemon, &AcquisitionDaemon::stop);
+
+    daemon.start();
+    return app.exec();
+}
@@ -0,0 +1,32 @@
+QT -= gui
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+TARGET = obdreaderd
+TEMPLATE = app
+
+# Same transport, protocol and decoding code as the widget app, none of its UI
+include(../obdcore.pri)
+
+SOURCES += \
+    acquisitiondaemon.cpp \
+    main.cpp \
+    sampleoutput.cpp
+
+HEADERS += \
+    acquisitiondaemon.h \
+    sampleoutput.h
+
+DISTFILES += \
+    obdreaderd.ini
+
+unix:!android: target.path = /opt/obdreaderd/bin
+!isEmpty(target.path): INSTALLS += target
+
+linux:!android {
+    LIBS += -lpthread
+}
+
+gcc {
+    QMAKE_CXXFLAGS += -Wno-deprecated-declarations
+}
@@ -0,0 +1,97 @@
+#include "sampleoutput.h"
+#include <cstdio>
+
+namespace {
+
+// A client that stopped reading is dropped instead of growing the buffer without bound
+const qint64 MAX_CLIENT_BACKLOG = 1024 * 1024;
+
+const char *moduleKey(WJModule module)
+{
+    switch (module) {
+    case MODULE_ENGINE_EDC15: return "engine";
+    case MODULE_TRANSMISSION: return "transmission";
+    case MODULE_PCM: return "pcm";
+    case MODULE_ABS: return "abs";
+    default: return "unknown";
+    }
+}
+
+} // namespace
+
+SampleOutput::SampleOutput(QObject *parent) : QObject(parent)
+{
+    connect(&m_server, &QTcpServer::newConnection, this, &SampleOutput::onNewConnection);
+}
+
+void SampleOutput::setFormat(Format format)
+{
+    m_format = format;
+}
+
+bool SampleOutput::openStdout()
+{
+    return m_stdout.open(stdout, QIODevice::WriteOnly);
+}
+
+bool SampleOutput::openFile(const QString &path)
+{
+    m_file.setFileName(path);
+    return m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+bool SampleOutput::listen(quint16 port)
+{
+    return m_server.listen(QHostAddress::Any, port);
+}
+
+void SampleOutput::write(qint64 timestampMs, const WJSensorSignal &signal, double value)
+{
+    const QByteArray number = QByteArray::number(value, 'f', signal.decimals);
+    if (m_format == Json) {
+        m_pending += "{\"t\":" + QByteArray::number(timestampMs)
+                     + ",\"module\":\"" + moduleKey(signal.module)
+                     + "\",\"signal\":\"" + signal.name
+                     + "\",\"value\":" + number
+                     + ",\"unit\":\"" + signal.unit + "\"}\n";
+    } else {
+        m_pending += QByteArray::number(timestampMs) + ',' + moduleKey(signal.module) + ','
+                     + signal.name + ',' + number + ',' + signal.unit + '\n';
+    }
+}
+
+void SampleOutput::flush()
+{
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    if (m_stdout.isOpen()) {
+        m_stdout.write(m_pending);
+        m_stdout.flush();
+    }
+    if (m_file.isOpen()) {
+        m_file.write(m_pending);
+        m_file.flush();
+    }
+    for (int i = m_clients.size() - 1; i >= 0; --i) {
+        QTcpSocket *client = m_clients.at(i);
+        if (client->bytesToWrite() > MAX_CLIENT_BACKLOG) {
+            client->abort();   // removed through disconnected()
+            continue;
+        }
+        client->write(m_pending);
+    }
+    m_pending.clear();
+}
+
+void SampleOutput::onNewConnection()
+{
+    while (QTcpSocket *client = m_server.nextPendingConnection()) {
+        m_clients.append(client);
+        connect(client, &QTcpSocket::disconnected, this, [this, client]() {
+            m_clients.removeOne(client);
+            client->deleteLater();
+        });
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef SAMPLEOUTPUT_H
+#define SAMPLEOUTPUT_H
+
+#include <QObject>
+#include <QFile>
+#include <QList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include "sensorrecorder.h"
+
+// Where obdreaderd's samples go: stdout, a file opened for appending and every client of a
+// TCP port, all getting the same lines. Lines are built once and written whole; writes are
+// buffered until flush(), which the daemon calls once per decoded message.
+class SampleOutput : public QObject
+{
+    Q_OBJECT
+public:
+    enum Format { Csv, Json };
+
+    explicit SampleOutput(QObject *parent = nullptr);
+
+    void setFormat(Format format);
+    bool openStdout();
+    bool openFile(const QString &path);
+    bool listen(quint16 port);
+
+    void write(qint64 timestampMs, const WJSensorSignal &signal, double value);
+    void flush();
+
+private slots:
+    void onNewConnection();
+
+private:
+    Format m_format{Csv};
+    QFile m_stdout;
+    QFile m_file;
+    QTcpServer m_server;
+    QList<QTcpSocket*> m_clients;
+    QByteArray m_pending;
+};
+
+#endif // SAMPLEOUTPUT_H
@@ -0,0 +1,124 @@
+#include "pidbatcher.h"
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+// SAE J1979 mode 01 data bytes per PID, 0 where the PID is not defined
+const quint8 J1979_LENGTHS[] = {
+    4, 4, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1,    // 00-0F
+    2, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2,    // 10-1F
+    4, 2, 2, 2, 4, 4, 4, 4, 4, 4, 4, 4, 1, 1, 1, 1,    // 20-2F
+    1, 2, 2, 1, 4, 4, 4, 4, 4, 4, 4, 4, 2, 2, 2, 2,    // 30-3F
+    4, 4, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 4,    // 40-4F
+    4, 1, 1, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2, 2, 1,    // 50-5F
+    4, 1, 1, 2, 5, 2, 5, 3,                            // 60-67
+};
+
+const quint8 RESPONSE_SID = 0x41;
+
+} // namespace
+
+bool PidBatcher::isBatchable(const WJCommandDescriptor &descriptor)
+{
+    return !descriptor.adapterCommand && descriptor.requestLength == 2 && descriptor.request[0] == 0x01
+           && dataLength(descriptor.module, descriptor.request[1]) > 0;
+}
+
+int PidBatcher::dataLength(WJModule module, quint8 pid)
+{
+    // The WJ modules use their own records on some PIDs (01 00 is live data, not a bitmap)
+    for (const WJCommandDescriptor &d : WJCommandTable::TABLE) {
+        if (d.module == module && d.requestLength == 2 && d.request[0] == 0x01 && d.request[1] == pid
+            && d.minResponseLength > 2) {
+            return d.minResponseLength - 2;
+        }
+    }
+
+    if (pid < std::size(J1979_LENGTHS) && J1979_LENGTHS[pid] > 0) {
+        return J1979_LENGTHS[pid];
+    }
+    if (pid == 0x80 || pid == 0xA0 || pid == 0xC0) {
+        return 4;
+    }
+    return -1;
+}
+
+QString PidBatcher::requestFor(const QVector<quint8> &pids)
+{
+    QString request = "01";
+    for (quint8 pid : pids) {
+        request += QString(" %1").arg(pid, 2, 16, QLatin1Char('0')).toUpper();
+    }
+    return request;
+}
+
+void PidBatcher::setSupported(const std::bitset<256> &pids)
+{
+    m_supported = pids;
+}
+
+bool PidBatcher::canShare(quint8 pid) const
+{
+    return m_supported.none() || m_supported.test(pid);
+}
+
+int PidBatcher::limit(WJModule module) const
+{
+    return m_limits.value(int(module), MAX_PIDS_PER_REQUEST);
+}
+
+void PidBatcher::learn(WJModule module, int asked, int answered)
+{
+    if (asked <= 1 || answered >= asked) {
+        return;
+    }
+
+    // Only the first PID (or nothing at all) back: the ECU handles one PID per request
+    const int learned = qMax(1, answered);
+    if (learned < limit(module)) {
+        m_limits.insert(int(module), learned);
+    }
+}
+
+void PidBatcher::reset()
+{
+    m_supported.reset();
+    m_limits.clear();
+}
+
+int PidBatcher::split(WJModule module, const QVector<quint8> &pids, QByteArrayView message,
+                      const MessageHandler &handler)
+{
+    const quint8 *bytes = reinterpret_cast<const quint8*>(message.data());
+    const int size = int(message.size());
+
+    // With headers on (ATH1) the SID follows 3 header bytes (J1850) or 3-4 (KWP)
+    int pos = -1;
+    for (int offset : {0, 3, 4}) {
+        if (size >= offset + 2 && bytes[offset] == RESPONSE_SID && pids.contains(bytes[offset + 1])) {
+            pos = offset + 1;
+            break;
+        }
+    }
+    if (pos < 0) {
+        return 0;
+    }
+
+    // PID, data, PID, data ... in whatever order the ECU chose; a trailing checksum ends the walk
+    quint8 part[2 + 255];
+    part[0] = RESPONSE_SID;
+    int found = 0;
+    while (pos < size && pids.contains(bytes[pos])) {
+        const int length = dataLength(module, bytes[pos]);
+        if (length < 0 || pos + 1 + length > size) {
+            break;
+        }
+        part[1] = bytes[pos];
+        std::memcpy(part + 2, bytes + pos + 1, size_t(length));
+        handler(QByteArrayView(reinterpret_cast<const char*>(part), 2 + length));
+        ++found;
+        pos += 1 + length;
+    }
+    return found;
+}
@@ -0,0 +1,50 @@
+#ifndef PIDBATCHER_H
+#define PIDBATCHER_H
+
+#include <QByteArrayView>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <bitset>
+#include <functional>
+#include "global.h"
+#include "wjcommandtable.h"
+
+// Mode 01 requests of one module packed into as few round-trips as the ECU accepts:
+// "01 0C 0D 05" instead of three requests, and the combined "41 0C a b 0D c 05 d" reply
+// split back into one "41 pid data" message per PID for WJDataParser.
+// ISO 15765 ECUs take up to six PIDs per request, most older ones answer only the first,
+// so the limit per module is learned from the replies.
+class PidBatcher
+{
+public:
+    using MessageHandler = std::function<void(QByteArrayView)>;
+
+    static constexpr int MAX_PIDS_PER_REQUEST = 6;
+
+    // Table commands that can share a request: mode 01, one PID, reply length known
+    static bool isBatchable(const WJCommandDescriptor &descriptor);
+    // Data bytes after the PID: the table's record length for the module, else SAE J1979; -1 if unknown
+    static int dataLength(WJModule module, quint8 pid);
+    static QString requestFor(const QVector<quint8> &pids);
+
+    // ELM support bitmaps; once known, PIDs outside them always go alone
+    // (one unsupported PID can get the whole request answered with NO DATA)
+    void setSupported(const std::bitset<256> &pids);
+    bool canShare(quint8 pid) const;
+
+    int limit(WJModule module) const;
+    // The ECU answered `answered` of the `asked` PIDs of one request (0 after an error or a timeout)
+    void learn(WJModule module, int asked, int answered);
+    void reset();
+
+    // Splits one reply message (headers on or off); returns the number of requested PIDs found
+    static int split(WJModule module, const QVector<quint8> &pids, QByteArrayView message,
+                     const MessageHandler &handler);
+
+private:
+    std::bitset<256> m_supported;
+    QHash<int, int> m_limits;   // WJModule -> PIDs per request
+};
+
+#endif // PIDBATCHER_H
@@ -0,0 +1,136 @@
+#include "replaytransport.h"
+
+ReplayTransport::ReplayTransport(QObject *parent) : QObject(parent)
+{
+    m_framer.setLineHandler([this](QByteArrayView line) { emit lineReceived(line); });
+    m_framer.setPromptHandler([this]() { emit promptReceived(); });
+
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &ReplayTransport::playPending);
+}
+
+bool ReplayTransport::open(const QString &path, bool realTime)
+{
+    close();
+
+    if (!TrafficCapture::load(path, m_records) || m_records.isEmpty()) {
+        emit stateChanged("Cannot read capture " + path);
+        return false;
+    }
+
+    m_pos = 0;
+    m_realTime = realTime;
+    m_mismatches = 0;
+    m_anchorNs = m_records.first().timestampNs;
+    m_anchorClock.start();
+    m_framer.reset();
+    m_connected = true;
+
+    emit stateChanged(QString("Replaying %1 (%2 records, %3)")
+                          .arg(path).arg(m_records.size()).arg(realTime ? "recorded speed" : "fast"));
+
+    // Connected after the caller returns, like a socket; then whatever the adapter sent unasked
+    QTimer::singleShot(0, this, [this]() {
+        if (m_connected) {
+            emit replayConnected();
+            schedule();
+        }
+    });
+    return true;
+}
+
+void ReplayTransport::close()
+{
+    m_timer.stop();
+    m_records.clear();
+    m_pos = 0;
+
+    if (m_connected) {
+        m_connected = false;
+        emit replayDisconnected();
+    }
+}
+
+bool ReplayTransport::write(QByteArrayView data)
+{
+    if (!m_connected) {
+        return false;
+    }
+
+    // Anything left of the previous reply goes out first, the order on the wire never changes
+    m_timer.stop();
+    while (m_pos < m_records.size() && m_records.at(m_pos).kind != TrafficRecord::Tx
+           && m_records.at(m_pos).kind != TrafficRecord::Disconnected) {
+        const TrafficRecord &record = m_records.at(m_pos++);
+        if (record.kind == TrafficRecord::Rx) {
+            m_framer.append(record.bytes.constData(), record.bytes.size());
+        }
+    }
+
+    if (m_pos < m_records.size() && m_records.at(m_pos).kind == TrafficRecord::Tx) {
+        const TrafficRecord &command = m_records.at(m_pos++);
+        if (command.bytes != data.toByteArray()) {
+            m_mismatches++;
+            emit stateChanged(QString("Replay diverged: sent %1, capture has %2")
+                                  .arg(QString::fromLatin1(data).trimmed(),
+                                       QString::fromLatin1(command.bytes).trimmed()));
+        }
+        m_anchorNs = command.timestampNs;
+        m_anchorClock.restart();
+    }
+
+    schedule();
+    return true;
+}
+
+bool ReplayTransport::isConnected() const
+{
+    return m_connected;
+}
+
+int ReplayTransport::mismatches() const
+{
+    return m_mismatches;
+}
+
+void ReplayTransport::schedule()
+{
+    while (m_pos < m_records.size() && m_records.at(m_pos).kind == TrafficRecord::Connected) {
+        ++m_pos;
+    }
+
+    if (m_pos >= m_records.size() || m_records.at(m_pos).kind == TrafficRecord::Disconnected) {
+        emit stateChanged("Replay finished");
+        close();
+        return;
+    }
+
+    const TrafficRecord &next = m_records.at(m_pos);
+    if (next.kind == TrafficRecord::Tx) {
+        return;  // the app's next command releases the rest
+    }
+
+    qint64 delayMs = 0;
+    if (m_realTime) {
+        const quint64 dueNs = next.timestampNs > m_anchorNs ? next.timestampNs - m_anchorNs : 0;
+        delayMs = (qint64(dueNs) - m_anchorClock.nsecsElapsed() + 999999) / 1000000;
+    }
+    m_timer.start(int(qMax<qint64>(0, delayMs)));
+}
+
+void ReplayTransport::playPending()
+{
+    const qint64 elapsedNs = m_anchorClock.nsecsElapsed();
+    while (m_pos < m_records.size() && m_records.at(m_pos).kind == TrafficRecord::Rx) {
+        const TrafficRecord &record = m_records.at(m_pos);
+        if (m_realTime && record.timestampNs > m_anchorNs && record.timestampNs - m_anchorNs > quint64(elapsedNs)) {
+            break;  // not due yet
+        }
+        ++m_pos;
+        m_framer.append(record.bytes.constData(), record.bytes.size());
+    }
+
+    if (m_connected) {
+        schedule();
+    }
+}
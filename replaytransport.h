@@ -0,0 +1,54 @@
+#ifndef REPLAYTRANSPORT_H
+#define REPLAYTRANSPORT_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include "elmframer.h"
+#include "trafficcapture.h"
+
+// Plays a TrafficCapture back as if the adapter were connected.
+// Replay follows the app rather than the clock: each command written releases the RX chunks
+// that followed the matching command in the capture, so the run is deterministic even when
+// the app's own timing differs. In real-time mode every chunk keeps its recorded delay after
+// its command; otherwise chunks go out as fast as the event loop allows.
+// Chunks go through an ElmFramer like socket reads, so everything above sees the same lines.
+class ReplayTransport : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ReplayTransport(QObject *parent = nullptr);
+
+    bool open(const QString &path, bool realTime);
+    void close();
+    bool write(QByteArrayView data);
+    bool isConnected() const;
+
+    // Commands that differed from the capture at the same position
+    int mismatches() const;
+
+signals:
+    void lineReceived(QByteArrayView line);
+    void promptReceived();
+    void stateChanged(QString state);
+    void replayConnected();
+    void replayDisconnected();
+
+private slots:
+    void playPending();
+
+private:
+    void schedule();
+
+    QList<TrafficRecord> m_records;
+    int m_pos{0};
+    bool m_realTime{false};
+    bool m_connected{false};
+    int m_mismatches{0};
+    quint64 m_anchorNs{0};      // capture time of the command the pending chunks answer
+    QElapsedTimer m_anchorClock; // started when the app wrote that command
+    QTimer m_timer;
+    ElmFramer m_framer;
+};
+
+#endif // REPLAYTRANSPORT_H
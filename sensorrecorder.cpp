@@ -0,0 +1,460 @@
+#include "sensorrecorder.h"
+#include <QDateTime>
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+#include <fcntl.h>
+#endif
+
+namespace {
+
+// Backs [from, to) of the file with real blocks, so writing through the map can't hit a full
+// disk (SIGBUS) the way a sparse QFile::resize() can. False if the space isn't there.
+bool allocateFile(QFile &file, qint64 from, qint64 to)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+    if (posix_fallocate(file.handle(), off_t(from), off_t(to - from)) == 0) {
+        return true;
+    }
+#endif
+    // No fallocate (or not on this file system): write the zeros ourselves
+    static const char zeros[64 * 1024] = {};
+    if (!file.seek(from)) {
+        return false;
+    }
+    for (qint64 pos = from; pos < to; ) {
+        const qint64 written = file.write(zeros, qMin<qint64>(sizeof(zeros), to - pos));
+        if (written <= 0) {
+            return false;
+        }
+        pos += written;
+    }
+    return file.flush();
+}
+
+} // namespace
+
+const WJSensorSignal WJSensorSignals::TABLE[SENSOR_COUNT] = {
+    {SENSOR_ENGINE_MAF_ACTUAL,              MODULE_ENGINE_EDC15, "MAF actual",             "g/s",  1, [](const WJSensorData &d) { return d.engine.mafActual; }},
+    {SENSOR_ENGINE_MAF_SPECIFIED,           MODULE_ENGINE_EDC15, "MAF specified",          "g/s",  1, [](const WJSensorData &d) { return d.engine.mafSpecified; }},
+    {SENSOR_ENGINE_RAIL_PRESSURE_ACTUAL,    MODULE_ENGINE_EDC15, "Rail pressure actual",   "bar",  1, [](const WJSensorData &d) { return d.engine.railPressureActual; }},
+    {SENSOR_ENGINE_RAIL_PRESSURE_SPECIFIED, MODULE_ENGINE_EDC15, "Rail pressure specified","bar",  1, [](const WJSensorData &d) { return d.engine.railPressureSpecified; }},
+    {SENSOR_ENGINE_MAP_ACTUAL,              MODULE_ENGINE_EDC15, "MAP actual",             "mbar", 0, [](const WJSensorData &d) { return d.engine.mapActual; }},
+    {SENSOR_ENGINE_MAP_SPECIFIED,           MODULE_ENGINE_EDC15, "MAP specified",          "mbar", 0, [](const WJSensorData &d) { return d.engine.mapSpecified; }},
+    {SENSOR_ENGINE_COOLANT_TEMP,            MODULE_ENGINE_EDC15, "Coolant temp",           "°C",   1, [](const WJSensorData &d) { return d.engine.coolantTemp; }},
+    {SENSOR_ENGINE_INTAKE_AIR_TEMP,         MODULE_ENGINE_EDC15, "Intake air temp",        "°C",   1, [](const WJSensorData &d) { return d.engine.intakeAirTemp; }},
+    {SENSOR_ENGINE_THROTTLE_POSITION,       MODULE_ENGINE_EDC15, "Throttle position",      "%",    1, [](const WJSensorData &d) { return d.engine.throttlePosition; }},
+    {SENSOR_ENGINE_RPM,                     MODULE_ENGINE_EDC15, "Engine RPM",             "rpm",  0, [](const WJSensorData &d) { return d.engine.engineRPM; }},
+    {SENSOR_ENGINE_INJECTION_QUANTITY,      MODULE_ENGINE_EDC15, "Injection quantity",     "mg",   2, [](const WJSensorData &d) { return d.engine.injectionQuantity; }},
+    {SENSOR_ENGINE_INJECTOR1_CORRECTION,    MODULE_ENGINE_EDC15, "Injector 1 correction",  "mg",   2, [](const WJSensorData &d) { return d.engine.injector1Correction; }},
+    {SENSOR_ENGINE_INJECTOR2_CORRECTION,    MODULE_ENGINE_EDC15, "Injector 2 correction",  "mg",   2, [](const WJSensorData &d) { return d.engine.injector2Correction; }},
+    {SENSOR_ENGINE_INJECTOR3_CORRECTION,    MODULE_ENGINE_EDC15, "Injector 3 correction",  "mg",   2, [](const WJSensorData &d) { return d.engine.injector3Correction; }},
+    {SENSOR_ENGINE_INJECTOR4_CORRECTION,    MODULE_ENGINE_EDC15, "Injector 4 correction",  "mg",   2, [](const WJSensorData &d) { return d.engine.injector4Correction; }},
+    {SENSOR_ENGINE_INJECTOR5_CORRECTION,    MODULE_ENGINE_EDC15, "Injector 5 correction",  "mg",   2, [](const WJSensorData &d) { return d.engine.injector5Correction; }},
+    {SENSOR_ENGINE_BATTERY_VOLTAGE,         MODULE_ENGINE_EDC15, "Battery voltage",        "V",    2, [](const WJSensorData &d) { return d.engine.batteryVoltage; }},
+
+    {SENSOR_TRANS_OIL_TEMP,                 MODULE_TRANSMISSION, "Trans oil temp",         "°C",   1, [](const WJSensorData &d) { return d.transmission.oilTemp; }},
+    {SENSOR_TRANS_INPUT_SPEED,              MODULE_TRANSMISSION, "Input speed",            "rpm",  0, [](const WJSensorData &d) { return d.transmission.inputSpeed; }},
+    {SENSOR_TRANS_OUTPUT_SPEED,             MODULE_TRANSMISSION, "Output speed",           "rpm",  0, [](const WJSensorData &d) { return d.transmission.outputSpeed; }},
+    {SENSOR_TRANS_TORQUE_CONVERTER,         MODULE_TRANSMISSION, "Torque converter",       "%",    1, [](const WJSensorData &d) { return d.transmission.torqueConverter; }},
+    {SENSOR_TRANS_CURRENT_GEAR,             MODULE_TRANSMISSION, "Current gear",           "",     0, [](const WJSensorData &d) { return d.transmission.currentGear; }},
+    {SENSOR_TRANS_LINE_PRESSURE,            MODULE_TRANSMISSION, "Line pressure",          "psi",  1, [](const WJSensorData &d) { return d.transmission.linePresssure; }},
+    {SENSOR_TRANS_SHIFT_SOLENOID_A,         MODULE_TRANSMISSION, "Shift solenoid A",       "%",    1, [](const WJSensorData &d) { return d.transmission.shiftSolenoidA; }},
+    {SENSOR_TRANS_SHIFT_SOLENOID_B,         MODULE_TRANSMISSION, "Shift solenoid B",       "%",    1, [](const WJSensorData &d) { return d.transmission.shiftSolenoidB; }},
+    {SENSOR_TRANS_TCC_SOLENOID,             MODULE_TRANSMISSION, "TCC solenoid",           "%",    1, [](const WJSensorData &d) { return d.transmission.tccSolenoid; }},
+
+    {SENSOR_PCM_VEHICLE_SPEED,              MODULE_PCM,          "Vehicle speed",          "km/h", 1, [](const WJSensorData &d) { return d.pcm.vehicleSpeed; }},
+    {SENSOR_PCM_ENGINE_LOAD,                MODULE_PCM,          "Engine load",            "%",    1, [](const WJSensorData &d) { return d.pcm.engineLoad; }},
+    {SENSOR_PCM_FUEL_TRIM_ST,               MODULE_PCM,          "Fuel trim ST",           "%",    2, [](const WJSensorData &d) { return d.pcm.fuelTrimST; }},
+    {SENSOR_PCM_FUEL_TRIM_LT,               MODULE_PCM,          "Fuel trim LT",           "%",    2, [](const WJSensorData &d) { return d.pcm.fuelTrimLT; }},
+    {SENSOR_PCM_O2_SENSOR1,                 MODULE_PCM,          "O2 sensor 1",            "V",    3, [](const WJSensorData &d) { return d.pcm.o2Sensor1; }},
+    {SENSOR_PCM_O2_SENSOR2,                 MODULE_PCM,          "O2 sensor 2",            "V",    3, [](const WJSensorData &d) { return d.pcm.o2Sensor2; }},
+    {SENSOR_PCM_TIMING_ADVANCE,             MODULE_PCM,          "Timing advance",         "°",    1, [](const WJSensorData &d) { return d.pcm.timingAdvance; }},
+    {SENSOR_PCM_BAROMETRIC_PRESSURE,        MODULE_PCM,          "Barometric pressure",    "kPa",  0, [](const WJSensorData &d) { return d.pcm.barometricPressure; }},
+
+    {SENSOR_ABS_WHEEL_SPEED_FL,             MODULE_ABS,          "Wheel speed FL",         "km/h", 1, [](const WJSensorData &d) { return d.abs.wheelSpeedFL; }},
+    {SENSOR_ABS_WHEEL_SPEED_FR,             MODULE_ABS,          "Wheel speed FR",         "km/h", 1, [](const WJSensorData &d) { return d.abs.wheelSpeedFR; }},
+    {SENSOR_ABS_WHEEL_SPEED_RL,             MODULE_ABS,          "Wheel speed RL",         "km/h", 1, [](const WJSensorData &d) { return d.abs.wheelSpeedRL; }},
+    {SENSOR_ABS_WHEEL_SPEED_RR,             MODULE_ABS,          "Wheel speed RR",         "km/h", 1, [](const WJSensorData &d) { return d.abs.wheelSpeedRR; }},
+    {SENSOR_ABS_YAW_RATE,                   MODULE_ABS,          "Yaw rate",               "°/s",  2, [](const WJSensorData &d) { return d.abs.yawRate; }},
+    {SENSOR_ABS_LATERAL_ACCEL,              MODULE_ABS,          "Lateral accel",          "g",    3, [](const WJSensorData &d) { return d.abs.lateralAccel; }},
+};
+
+namespace {
+
+// File: 64-byte header, then blocks until dataEnd (the mapped tail past it is unused)
+//   header  "WJSREC01" | u16 version | u16 header size | u16 sensors | u16 0 | i64 start (epoch ms)
+//           | u64 dataEnd | u32 blocks | u32 dropped samples | zero padding
+//   block   u32 'WBLK' | u32 block bytes | u16 columns | u16 0 | u32 samples
+//   column  u16 sensor | u8 decimals | u8 0 | u32 samples | u32 timestamp bytes | u32 value bytes
+//           | i64 first timestamp (us) | i64 first raw value
+//           | timestamp deltas | value deltas        (varints, values zigzag; both after the first sample)
+// Everything little-endian.
+const char FILE_MAGIC[8] = {'W', 'J', 'S', 'R', 'E', 'C', '0', '1'};
+const quint16 FILE_VERSION = 1;
+const int HEADER_SIZE = 64;
+const quint32 BLOCK_MAGIC = 0x4B4C4257;
+const int BLOCK_HEADER_SIZE = 16;
+const int COLUMN_HEADER_SIZE = 32;
+const int MAX_DECIMALS = 4;
+
+const double SCALE[MAX_DECIMALS + 1] = {1.0, 10.0, 100.0, 1000.0, 10000.0};
+
+void appendVarint(std::vector<quint8> &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.push_back(quint8(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(quint8(value));
+}
+
+bool readVarint(const uchar *&p, const uchar *end, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const uchar byte = *p++;
+        value |= quint64(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+quint64 zigzag(qint64 value)
+{
+    return (quint64(value) << 1) ^ quint64(value >> 63);
+}
+
+qint64 unzigzag(quint64 value)
+{
+    return qint64(value >> 1) ^ -qint64(value & 1);
+}
+
+} // namespace
+
+SensorRecorder::SensorRecorder()
+{
+    for (int i = 0; i < SENSOR_COUNT; ++i) {
+        Q_ASSERT(WJSensorSignals::TABLE[i].id == i && WJSensorSignals::TABLE[i].decimals <= MAX_DECIMALS);
+    }
+}
+
+SensorRecorder::~SensorRecorder()
+{
+    stop();
+}
+
+bool SensorRecorder::start(const QString &path)
+{
+    stop();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        return false;
+    }
+
+    m_used = HEADER_SIZE;
+    m_blockCount = 0;
+    m_blockSamples = 0;
+    m_dropped = 0;
+    m_startEpochMs = QDateTime::currentMSecsSinceEpoch();
+    if (!reserve(GROW_BYTES)) {
+        m_file.close();
+        return false;
+    }
+    writeHeader();
+
+    for (int i = 0; i < SENSOR_COUNT; ++i) {
+        m_columns[i] = Column();
+        m_lastValue[i] = std::numeric_limits<double>::quiet_NaN();
+        m_lastRecordedUs[i] = 0;
+    }
+
+    m_clock.start();
+    m_running = true;
+    m_flushThread = QThread::create([this]() { flushLoop(); });
+    m_flushThread->setObjectName("SensorRecorder");
+    m_flushThread->start(QThread::LowPriority);
+    return true;
+}
+
+void SensorRecorder::stop()
+{
+    if (!m_flushThread) {
+        return;
+    }
+
+    // The flush thread writes whatever is still queued before it returns
+    m_running = false;
+    m_flushThread->wait();
+    delete m_flushThread;
+    m_flushThread = nullptr;
+
+    writeHeader();
+    m_file.unmap(m_map);
+    m_map = nullptr;
+    m_mapSize = 0;
+    m_file.resize(m_used);
+    m_file.close();
+}
+
+bool SensorRecorder::isRecording() const
+{
+    return m_flushThread != nullptr;
+}
+
+QString SensorRecorder::path() const
+{
+    return m_file.fileName();
+}
+
+void SensorRecorder::record(const WJSensorData &data, WJModule module)
+{
+    if (!m_running.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    const qint64 nowUs = m_clock.nsecsElapsed() / 1000;
+    for (const WJSensorSignal &signal : WJSensorSignals::TABLE) {
+        if (signal.module != module) {
+            continue;
+        }
+
+        const double value = signal.read(data);
+        if (!std::isfinite(value)
+            || (value == m_lastValue[signal.id] && nowUs - m_lastRecordedUs[signal.id] < KEEPALIVE_MS * 1000)) {
+            continue;
+        }
+
+        // A full queue means the disk fell far behind; losing samples beats stalling acquisition
+        if (!m_queue.tryPush(SensorSample{signal.id, nowUs, value})) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        m_lastValue[signal.id] = value;
+        m_lastRecordedUs[signal.id] = nowUs;
+    }
+}
+
+quint64 SensorRecorder::droppedSamples() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+qint64 SensorRecorder::bytesWritten() const
+{
+    return m_bytesWritten.load(std::memory_order_relaxed);
+}
+
+void SensorRecorder::flushLoop()
+{
+    m_blockClock.start();
+    while (m_running.load(std::memory_order_acquire)) {
+        drain();
+        if (m_blockSamples > 0 && m_blockClock.elapsed() >= BLOCK_INTERVAL_MS) {
+            writeBlock();
+        }
+        QThread::msleep(FLUSH_POLL_MS);
+    }
+
+    drain();
+    if (m_blockSamples > 0) {
+        writeBlock();
+    }
+}
+
+void SensorRecorder::drain()
+{
+    SensorSample sample;
+    while (m_queue.tryPop(sample)) {
+        const WJSensorSignal &signal = WJSensorSignals::TABLE[sample.sensor];
+        const qint64 raw = std::llround(sample.value * SCALE[signal.decimals]);
+
+        Column &column = m_columns[sample.sensor];
+        if (column.count == 0) {
+            column.firstTimestampUs = sample.timestampUs;
+            column.firstRaw = raw;
+        } else {
+            appendVarint(column.timestamps, quint64(sample.timestampUs - column.lastTimestampUs));
+            appendVarint(column.values, zigzag(raw - column.lastRaw));
+        }
+        column.lastTimestampUs = sample.timestampUs;
+        column.lastRaw = raw;
+        column.count++;
+
+        if (++m_blockSamples >= BLOCK_SAMPLES) {
+            writeBlock();
+        }
+    }
+}
+
+bool SensorRecorder::writeBlock()
+{
+    qint64 size = BLOCK_HEADER_SIZE;
+    quint16 columns = 0;
+    for (const Column &column : m_columns) {
+        if (column.count > 0) {
+            size += COLUMN_HEADER_SIZE + qint64(column.timestamps.size() + column.values.size());
+            ++columns;
+        }
+    }
+
+    const bool ok = reserve(size);
+    if (ok) {
+        uchar *p = m_map + m_used;
+        qToLittleEndian<quint32>(BLOCK_MAGIC, p);
+        qToLittleEndian<quint32>(quint32(size), p + 4);
+        qToLittleEndian<quint16>(columns, p + 8);
+        qToLittleEndian<quint16>(0, p + 10);
+        qToLittleEndian<quint32>(m_blockSamples, p + 12);
+        p += BLOCK_HEADER_SIZE;
+
+        for (int i = 0; i < SENSOR_COUNT; ++i) {
+            const Column &column = m_columns[i];
+            if (column.count == 0) {
+                continue;
+            }
+            qToLittleEndian<quint16>(quint16(i), p);
+            p[2] = WJSensorSignals::TABLE[i].decimals;
+            p[3] = 0;
+            qToLittleEndian<quint32>(column.count, p + 4);
+            qToLittleEndian<quint32>(quint32(column.timestamps.size()), p + 8);
+            qToLittleEndian<quint32>(quint32(column.values.size()), p + 12);
+            qToLittleEndian<qint64>(column.firstTimestampUs, p + 16);
+            qToLittleEndian<qint64>(column.firstRaw, p + 24);
+            p += COLUMN_HEADER_SIZE;
+            std::memcpy(p, column.timestamps.data(), column.timestamps.size());
+            p += column.timestamps.size();
+            std::memcpy(p, column.values.data(), column.values.size());
+            p += column.values.size();
+        }
+
+        m_used += size;
+        m_blockCount++;
+        writeHeader();
+        m_bytesWritten.store(m_used, std::memory_order_relaxed);
+    }
+
+    // On a full disk the block is lost, recording goes on
+    for (Column &column : m_columns) {
+        column.count = 0;
+        column.timestamps.clear();
+        column.values.clear();
+    }
+    m_blockSamples = 0;
+    m_blockClock.restart();
+    return ok;
+}
+
+bool SensorRecorder::reserve(qint64 bytes)
+{
+    if (m_map && m_used + bytes <= m_mapSize) {
+        return true;
+    }
+
+    // Grow in large steps: remapping is rare and the file system can allocate contiguously
+    const qint64 size = m_mapSize + qMax(GROW_BYTES, bytes);
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    if (!allocateFile(m_file, m_mapSize, size)) {
+        // Full disk: drop whatever part got allocated and keep the old mapping
+        m_file.resize(m_mapSize);
+        m_map = m_mapSize > 0 ? m_file.map(0, m_mapSize) : nullptr;
+        return false;
+    }
+    m_map = m_file.map(0, size);
+    m_mapSize = m_map ? size : 0;
+    return m_map != nullptr;
+}
+
+void SensorRecorder::writeHeader()
+{
+    if (!m_map) {
+        return;
+    }
+
+    uchar *p = m_map;
+    std::memset(p, 0, HEADER_SIZE);
+    std::memcpy(p, FILE_MAGIC, sizeof(FILE_MAGIC));
+    qToLittleEndian<quint16>(FILE_VERSION, p + 8);
+    qToLittleEndian<quint16>(HEADER_SIZE, p + 10);
+    qToLittleEndian<quint16>(SENSOR_COUNT, p + 12);
+    qToLittleEndian<qint64>(m_startEpochMs, p + 16);
+    qToLittleEndian<quint64>(quint64(m_used), p + 24);
+    qToLittleEndian<quint32>(m_blockCount, p + 32);
+    qToLittleEndian<quint32>(quint32(qMin<quint64>(droppedSamples(), 0xFFFFFFFF)), p + 36);
+}
+
+bool SensorRecorder::read(const QString &path, const std::function<void(const SensorSample &)> &handler)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < HEADER_SIZE) {
+        return false;
+    }
+    const uchar *data = file.map(0, file.size());
+    if (!data || std::memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0
+        || qFromLittleEndian<quint16>(data + 8) != FILE_VERSION) {
+        return false;
+    }
+
+    const quint64 dataEnd = qMin<quint64>(qFromLittleEndian<quint64>(data + 24), quint64(file.size()));
+    const uchar *end = data + dataEnd;
+    const uchar *p = data + qFromLittleEndian<quint16>(data + 10);
+
+    while (p + BLOCK_HEADER_SIZE <= end) {
+        const quint32 blockSize = qFromLittleEndian<quint32>(p + 4);
+        if (qFromLittleEndian<quint32>(p) != BLOCK_MAGIC || blockSize < quint32(BLOCK_HEADER_SIZE)
+            || blockSize > quint64(end - p)) {
+            return false;
+        }
+        const uchar *blockEnd = p + blockSize;
+        const int columns = qFromLittleEndian<quint16>(p + 8);
+        p += BLOCK_HEADER_SIZE;
+
+        for (int c = 0; c < columns; ++c) {
+            if (p + COLUMN_HEADER_SIZE > blockEnd) {
+                return false;
+            }
+            SensorSample sample;
+            sample.sensor = qFromLittleEndian<quint16>(p);
+            const int decimals = p[2];
+            const quint32 count = qFromLittleEndian<quint32>(p + 4);
+            const quint32 timestampBytes = qFromLittleEndian<quint32>(p + 8);
+            const quint32 valueBytes = qFromLittleEndian<quint32>(p + 12);
+            sample.timestampUs = qFromLittleEndian<qint64>(p + 16);
+            qint64 raw = qFromLittleEndian<qint64>(p + 24);
+            p += COLUMN_HEADER_SIZE;
+            if (decimals > MAX_DECIMALS || quint64(timestampBytes) + valueBytes > quint64(blockEnd - p)) {
+                return false;
+            }
+
+            const uchar *timestamps = p;
+            const uchar *timestampsEnd = p + timestampBytes;
+            const uchar *values = timestampsEnd;
+            const uchar *valuesEnd = values + valueBytes;
+            for (quint32 i = 0; i < count; ++i) {
+                if (i > 0) {
+                    quint64 timestampDelta = 0;
+                    quint64 valueDelta = 0;
+                    if (!readVarint(timestamps, timestampsEnd, timestampDelta)
+                        || !readVarint(values, valuesEnd, valueDelta)) {
+                        return false;
+                    }
+                    sample.timestampUs += qint64(timestampDelta);
+                    raw += unzigzag(valueDelta);
+                }
+                sample.value = double(raw) / SCALE[decimals];
+                handler(sample);
+            }
+            p = valuesEnd;
+        }
+        p = blockEnd;
+    }
+    return true;
+}
@@ -0,0 +1,154 @@
+#ifndef SENSORRECORDER_H
+#define SENSORRECORDER_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "global.h"
+#include "spscqueue.h"
+
+// Every recorded WJSensorData value; ids are stored in the files, only append
+enum WJSensorId : quint16 {
+    SENSOR_ENGINE_MAF_ACTUAL,
+    SENSOR_ENGINE_MAF_SPECIFIED,
+    SENSOR_ENGINE_RAIL_PRESSURE_ACTUAL,
+    SENSOR_ENGINE_RAIL_PRESSURE_SPECIFIED,
+    SENSOR_ENGINE_MAP_ACTUAL,
+    SENSOR_ENGINE_MAP_SPECIFIED,
+    SENSOR_ENGINE_COOLANT_TEMP,
+    SENSOR_ENGINE_INTAKE_AIR_TEMP,
+    SENSOR_ENGINE_THROTTLE_POSITION,
+    SENSOR_ENGINE_RPM,
+    SENSOR_ENGINE_INJECTION_QUANTITY,
+    SENSOR_ENGINE_INJECTOR1_CORRECTION,
+    SENSOR_ENGINE_INJECTOR2_CORRECTION,
+    SENSOR_ENGINE_INJECTOR3_CORRECTION,
+    SENSOR_ENGINE_INJECTOR4_CORRECTION,
+    SENSOR_ENGINE_INJECTOR5_CORRECTION,
+    SENSOR_ENGINE_BATTERY_VOLTAGE,
+
+    SENSOR_TRANS_OIL_TEMP,
+    SENSOR_TRANS_INPUT_SPEED,
+    SENSOR_TRANS_OUTPUT_SPEED,
+    SENSOR_TRANS_TORQUE_CONVERTER,
+    SENSOR_TRANS_CURRENT_GEAR,
+    SENSOR_TRANS_LINE_PRESSURE,
+    SENSOR_TRANS_SHIFT_SOLENOID_A,
+    SENSOR_TRANS_SHIFT_SOLENOID_B,
+    SENSOR_TRANS_TCC_SOLENOID,
+
+    SENSOR_PCM_VEHICLE_SPEED,
+    SENSOR_PCM_ENGINE_LOAD,
+    SENSOR_PCM_FUEL_TRIM_ST,
+    SENSOR_PCM_FUEL_TRIM_LT,
+    SENSOR_PCM_O2_SENSOR1,
+    SENSOR_PCM_O2_SENSOR2,
+    SENSOR_PCM_TIMING_ADVANCE,
+    SENSOR_PCM_BAROMETRIC_PRESSURE,
+
+    SENSOR_ABS_WHEEL_SPEED_FL,
+    SENSOR_ABS_WHEEL_SPEED_FR,
+    SENSOR_ABS_WHEEL_SPEED_RL,
+    SENSOR_ABS_WHEEL_SPEED_RR,
+    SENSOR_ABS_YAW_RATE,
+    SENSOR_ABS_LATERAL_ACCEL,
+
+    SENSOR_COUNT
+};
+
+// Where a recorded value lives in WJSensorData and how finely it is stored
+struct WJSensorSignal {
+    WJSensorId id;
+    WJModule module;
+    const char *name;
+    const char *unit;
+    quint8 decimals;    // values are stored as integers of 10^-decimals
+    double (*read)(const WJSensorData &data);
+};
+
+namespace WJSensorSignals {
+extern const WJSensorSignal TABLE[SENSOR_COUNT];
+}
+
+struct SensorSample {
+    quint16 sensor{SENSOR_COUNT};
+    qint64 timestampUs{0};   // monotonic, from the start of the recording
+    double value{0.0};
+};
+
+// Appends decoded samples to a compact columnar file without ever blocking the caller.
+// record() only pushes into a lock-free queue; a flush thread groups the samples into
+// blocks (one column per sensor: timestamp deltas, then value deltas, as zigzag varints)
+// and copies them into a memory-mapped file that grows in large steps.
+// The header is rewritten after each block, so a crash loses at most the last second.
+class SensorRecorder
+{
+public:
+    SensorRecorder();
+    ~SensorRecorder();
+
+    bool start(const QString &path);
+    void stop();
+    bool isRecording() const;
+    QString path() const;
+
+    // Call after a response for the module was decoded into data (one producer thread only).
+    // Values that did not change are written at most once per KEEPALIVE_MS.
+    void record(const WJSensorData &data, WJModule module);
+
+    quint64 droppedSamples() const;
+    qint64 bytesWritten() const;
+
+    // Reads a recording back in file order (per block, sensor by sensor)
+    static bool read(const QString &path, const std::function<void(const SensorSample &)> &handler);
+
+private:
+    struct Column {
+        quint32 count{0};
+        qint64 firstTimestampUs{0};
+        qint64 firstRaw{0};
+        qint64 lastTimestampUs{0};
+        qint64 lastRaw{0};
+        std::vector<quint8> timestamps;
+        std::vector<quint8> values;
+    };
+
+    void flushLoop();
+    void drain();
+    bool writeBlock();
+    bool reserve(qint64 bytes);
+    void writeHeader();
+
+    // Producer side
+    SpscQueue<SensorSample, 16384> m_queue;
+    QElapsedTimer m_clock;
+    double m_lastValue[SENSOR_COUNT];
+    qint64 m_lastRecordedUs[SENSOR_COUNT];
+    std::atomic<quint64> m_dropped{0};
+
+    // Flush thread side
+    QThread *m_flushThread{nullptr};
+    std::atomic<bool> m_running{false};
+    Column m_columns[SENSOR_COUNT];
+    quint32 m_blockSamples{0};
+    QElapsedTimer m_blockClock;
+    QFile m_file;
+    uchar *m_map{nullptr};
+    qint64 m_mapSize{0};
+    qint64 m_used{0};
+    quint32 m_blockCount{0};
+    qint64 m_startEpochMs{0};
+    std::atomic<qint64> m_bytesWritten{0};
+
+    static const int KEEPALIVE_MS = 1000;
+    static const int FLUSH_POLL_MS = 50;
+    static const int BLOCK_INTERVAL_MS = 1000;
+    static const quint32 BLOCK_SAMPLES = 4096;
+    static const qint64 GROW_BYTES = 4 * 1024 * 1024;
+};
+
+#endif // SENSORRECORDER_H
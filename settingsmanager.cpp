@@ -25,6 +25,7 @@ void SettingsManager::loadSettings()
     WifiIp = settings.value("WifiIp", "").toString();
     WifiPort = settings.value("WifiPort", "").toString().toUShort();    
     SerialPort = settings.value("SerialPort", "").toString();
+    SignalSet = settings.value("SignalSet", "").toString();
 }
 
 void SettingsManager::saveSettings()
@@ -34,6 +35,7 @@ void SettingsManager::saveSettings()
     settings.setValue("WifiIp", WifiIp);
     settings.setValue("WifiPort", QString::number(WifiPort));
     settings.setValue("SerialPort", SerialPort);
+    settings.setValue("SignalSet", SignalSet);
 }
 
 unsigned int SettingsManager::getEngineDisplacement() const
@@ -76,4 +78,12 @@ void SettingsManager::setSerialPort(const QString &value)
     SerialPort = value;
 }
 
+QString SettingsManager::getSignalSet() const
+{
+    return SignalSet;
+}
 
+void SettingsManager::setSignalSet(const QString &value)
+{
+    SignalSet = value;
+}
@@ -27,6 +27,10 @@ public:
     void setSerialPort(const QString &value);
     QString getSerialPort() const;
 
+    // Continuous reading signals and weights, see LiveDataEngine::parseSignalSet; empty = defaults
+    void setSignalSet(const QString &value);
+    QString getSignalSet() const;
+
 private:
     static SettingsManager* theInstance_;
     QString m_sSettingsFile{};
@@ -34,6 +38,7 @@ private:
     QString WifiIp{"192.168.1.16"};
     quint16 WifiPort{35000};
     QString SerialPort{};
+    QString SignalSet{};
 
 };
 
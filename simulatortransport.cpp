@@ -0,0 +1,83 @@
+#include "simulatortransport.h"
+
+SimulatorTransport::SimulatorTransport(QObject *parent) : QObject(parent)
+{
+    m_framer.setLineHandler([this](QByteArrayView line) { emit lineReceived(line); });
+    m_framer.setPromptHandler([this]() { emit promptReceived(); });
+
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &SimulatorTransport::deliverPending);
+}
+
+void SimulatorTransport::open(const ElmSimulatorConfig &config, bool realTime)
+{
+    close();
+
+    m_simulator = ElmSimulator(config);
+    m_realTime = realTime;
+    m_pending.clear();
+    m_framer.reset();
+    m_connected = true;
+
+    emit stateChanged(QString("Simulated adapter (seed %1, %2)")
+                          .arg(config.seed).arg(realTime ? "real latencies" : "fast"));
+
+    // Connected after the caller returns, like a socket
+    QTimer::singleShot(0, this, [this]() {
+        if (m_connected) {
+            emit simulatorConnected();
+        }
+    });
+}
+
+void SimulatorTransport::close()
+{
+    m_timer.stop();
+    m_pending.clear();
+
+    if (m_connected) {
+        m_connected = false;
+        emit simulatorDisconnected();
+    }
+}
+
+bool SimulatorTransport::write(QByteArrayView data)
+{
+    if (!m_connected) {
+        return false;
+    }
+
+    // A command written before the last answer arrived finds that answer already sent
+    if (m_timer.isActive()) {
+        m_timer.stop();
+        deliverPending();
+    }
+
+    int latencyMs = 0;
+    qsizetype start = 0;
+    while (start < data.size()) {
+        qsizetype end = start;
+        while (end < data.size() && data[end] != '\r') {
+            ++end;
+        }
+        const ElmSimulatorReply reply = m_simulator.respond(data.sliced(start, end - start));
+        m_pending.append(reply.bytes);
+        latencyMs += reply.latencyMs;
+        start = end + 1;
+    }
+
+    m_timer.start(m_realTime ? latencyMs : 0);
+    return true;
+}
+
+bool SimulatorTransport::isConnected() const
+{
+    return m_connected;
+}
+
+void SimulatorTransport::deliverPending()
+{
+    const QByteArray pending = m_pending;
+    m_pending.clear();
+    m_framer.append(pending.constData(), pending.size());
+}
@@ -0,0 +1,42 @@
+#ifndef SIMULATORTRANSPORT_H
+#define SIMULATORTRANSPORT_H
+
+#include <QObject>
+#include <QTimer>
+#include "elmframer.h"
+#include "elmsimulator.h"
+
+// ElmSimulator behind the transport contract: commands in through write(), lines and prompts
+// out through an ElmFramer like socket reads. In real-time mode each answer arrives after the
+// latency the simulator reports; otherwise on the next event loop pass.
+class SimulatorTransport : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SimulatorTransport(QObject *parent = nullptr);
+
+    void open(const ElmSimulatorConfig &config, bool realTime);
+    void close();
+    bool write(QByteArrayView data);
+    bool isConnected() const;
+
+signals:
+    void lineReceived(QByteArrayView line);
+    void promptReceived();
+    void stateChanged(QString state);
+    void simulatorConnected();
+    void simulatorDisconnected();
+
+private slots:
+    void deliverPending();
+
+private:
+    ElmSimulator m_simulator;
+    QByteArray m_pending;
+    bool m_realTime{true};
+    bool m_connected{false};
+    QTimer m_timer;
+    ElmFramer m_framer;
+};
+
+#endif // SIMULATORTRANSPORT_H
@@ -0,0 +1,55 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Lock-free single-producer/single-consumer ring of fixed-size slots.
+// One thread may call tryPush(), one other thread may call tryPop(); nothing allocates.
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    bool tryPush(const T &item)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity) {
+            return false; // full
+        }
+        m_slots[head & MASK] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &item)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return false; // empty
+        }
+        item = m_slots[tail & MASK];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+    }
+
+    std::size_t size() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    static const std::size_t MASK = Capacity - 1;
+
+    T m_slots[Capacity];
+    alignas(64) std::atomic<std::size_t> m_head{0}; // written by the producer
+    alignas(64) std::atomic<std::size_t> m_tail{0}; // written by the consumer
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,89 @@
+#include "trafficcapture.h"
+#include <QDateTime>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+const char FILE_MAGIC[8] = {'W', 'J', 'T', 'R', 'A', 'C', 'E', '1'};
+const int FILE_HEADER_SIZE = 16;
+const int RECORD_HEADER_SIZE = 12;
+
+} // namespace
+
+bool TrafficCapture::start(const QString &path)
+{
+    stop();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    uchar header[FILE_HEADER_SIZE];
+    std::memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header + 8);
+    m_file.write(reinterpret_cast<const char*>(header), FILE_HEADER_SIZE);
+
+    m_clock.start();
+    return true;
+}
+
+void TrafficCapture::stop()
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+bool TrafficCapture::isActive() const
+{
+    return m_file.isOpen();
+}
+
+void TrafficCapture::record(TrafficRecord::Kind kind, QByteArrayView bytes)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    const quint16 length = quint16(qMin<qsizetype>(bytes.size(), 0xFFFF));
+    uchar header[RECORD_HEADER_SIZE];
+    header[0] = kind;
+    header[1] = 0;
+    qToLittleEndian<quint16>(length, header + 2);
+    qToLittleEndian<quint64>(quint64(m_clock.nsecsElapsed()), header + 4);
+    m_file.write(reinterpret_cast<const char*>(header), RECORD_HEADER_SIZE);
+    m_file.write(bytes.data(), length);
+}
+
+bool TrafficCapture::load(const QString &path, QList<TrafficRecord> &records)
+{
+    records.clear();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    if (data.size() < FILE_HEADER_SIZE || std::memcmp(data.constData(), FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        return false;
+    }
+
+    const uchar *p = reinterpret_cast<const uchar*>(data.constData()) + FILE_HEADER_SIZE;
+    const uchar *end = reinterpret_cast<const uchar*>(data.constData()) + data.size();
+    while (end - p >= RECORD_HEADER_SIZE) {
+        const quint16 length = qFromLittleEndian<quint16>(p + 2);
+        if (end - p - RECORD_HEADER_SIZE < length) {
+            break;  // cut off by a crash; everything before it is still good
+        }
+
+        TrafficRecord record;
+        record.kind = TrafficRecord::Kind(p[0]);
+        record.timestampNs = qFromLittleEndian<quint64>(p + 4);
+        record.bytes = QByteArray(reinterpret_cast<const char*>(p + RECORD_HEADER_SIZE), length);
+        records.append(record);
+        p += RECORD_HEADER_SIZE + length;
+    }
+    return true;
+}
@@ -0,0 +1,40 @@
+#ifndef TRAFFICCAPTURE_H
+#define TRAFFICCAPTURE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+// One transport event of a capture
+struct TrafficRecord {
+    enum Kind : quint8 { Tx = 1, Rx = 2, Connected = 3, Disconnected = 4 };
+
+    Kind kind{Rx};
+    quint64 timestampNs{0};   // monotonic, from the start of the capture
+    QByteArray bytes;         // command as written / chunk as read, before any framing
+};
+
+// Adapter traffic exactly as it crossed the socket, for ReplayTransport and offline benchmarks.
+//   file    "WJTRACE1" | i64 start (epoch ms) | records
+//   record  u8 kind | u8 0 | u16 length | u64 timestamp (ns) | bytes      (little-endian)
+// Lives on the transport thread; writes go through QFile's buffer and are flushed on stop.
+class TrafficCapture
+{
+public:
+    bool start(const QString &path);
+    void stop();
+    bool isActive() const;
+
+    void record(TrafficRecord::Kind kind, QByteArrayView bytes = QByteArrayView());
+
+    static bool load(const QString &path, QList<TrafficRecord> &records);
+
+private:
+    QFile m_file;
+    QElapsedTimer m_clock;
+};
+
+#endif // TRAFFICCAPTURE_H
@@ -0,0 +1,153 @@
+#include "transportworker.h"
+
+TransportWorker::TransportWorker(QObject *parent) : QObject(parent)
+{
+    // Children follow the worker when it is moved to its thread
+    m_tcpSocket = new ElmTcpSocket(this);
+    m_bluetoothManager = new ElmBluetoothManager(this);
+    m_replayTransport = new ReplayTransport(this);
+    m_simulatorTransport = new SimulatorTransport(this);
+
+    connect(m_tcpSocket, &ElmTcpSocket::lineReceived, this,
+            [this](QByteArrayView line) { pushFrame(ElmFrame::line(line)); }, Qt::DirectConnection);
+    connect(m_tcpSocket, &ElmTcpSocket::promptReceived, this,
+            [this]() { pushFrame(ElmFrame::prompt()); }, Qt::DirectConnection);
+    connect(m_bluetoothManager, &ElmBluetoothManager::lineReceived, this,
+            [this](QByteArrayView line) { pushFrame(ElmFrame::line(line)); }, Qt::DirectConnection);
+    connect(m_bluetoothManager, &ElmBluetoothManager::promptReceived, this,
+            [this]() { pushFrame(ElmFrame::prompt()); }, Qt::DirectConnection);
+    connect(m_replayTransport, &ReplayTransport::lineReceived, this,
+            [this](QByteArrayView line) { pushFrame(ElmFrame::line(line)); }, Qt::DirectConnection);
+    connect(m_replayTransport, &ReplayTransport::promptReceived, this,
+            [this]() { pushFrame(ElmFrame::prompt()); }, Qt::DirectConnection);
+    connect(m_simulatorTransport, &SimulatorTransport::lineReceived, this,
+            [this](QByteArrayView line) { pushFrame(ElmFrame::line(line)); }, Qt::DirectConnection);
+    connect(m_simulatorTransport, &SimulatorTransport::promptReceived, this,
+            [this]() { pushFrame(ElmFrame::prompt()); }, Qt::DirectConnection);
+
+    // Capture sees the bytes before the framer does, and the connection events around them
+    auto captureRx = [this](QByteArrayView chunk) { m_capture.record(TrafficRecord::Rx, chunk); };
+    auto captureConnected = [this]() { m_capture.record(TrafficRecord::Connected); };
+    auto captureDisconnected = [this]() { m_capture.record(TrafficRecord::Disconnected); };
+    connect(m_tcpSocket, &ElmTcpSocket::bytesReceived, this, captureRx, Qt::DirectConnection);
+    connect(m_tcpSocket, &ElmTcpSocket::tcpConnected, this, captureConnected, Qt::DirectConnection);
+    connect(m_tcpSocket, &ElmTcpSocket::tcpDisconnected, this, captureDisconnected, Qt::DirectConnection);
+    connect(m_bluetoothManager, &ElmBluetoothManager::bytesReceived, this, captureRx, Qt::DirectConnection);
+    connect(m_bluetoothManager, &ElmBluetoothManager::btConnected, this, captureConnected, Qt::DirectConnection);
+    connect(m_bluetoothManager, &ElmBluetoothManager::btDisconnected, this, captureDisconnected, Qt::DirectConnection);
+}
+
+ElmTcpSocket *TransportWorker::tcpSocket() const
+{
+    return m_tcpSocket;
+}
+
+ElmBluetoothManager *TransportWorker::bluetoothManager() const
+{
+    return m_bluetoothManager;
+}
+
+ReplayTransport *TransportWorker::replayTransport() const
+{
+    return m_replayTransport;
+}
+
+SimulatorTransport *TransportWorker::simulatorTransport() const
+{
+    return m_simulatorTransport;
+}
+
+void TransportWorker::setConnectionType(ConnectionType type)
+{
+    m_connectionType = type;
+}
+
+bool TransportWorker::startCapture(const QString &path)
+{
+    return m_capture.start(path);
+}
+
+void TransportWorker::stopCapture()
+{
+    m_capture.stop();
+}
+
+bool TransportWorker::post(QByteArrayView command)
+{
+    // Commands go out CR-terminated, an empty command is just a CR
+    ElmFrame frame = ElmFrame::line(command.size() < ElmFrame::MAX_SIZE ? command : command.first(ElmFrame::MAX_SIZE - 1));
+    if (frame.size == 0 || frame.data[frame.size - 1] != '\r') {
+        frame.data[frame.size++] = '\r';
+    }
+
+    if (!m_txQueue.tryPush(frame)) {
+        return false;
+    }
+
+    if (!m_txWakePending.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, [this]() { drainTx(); }, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+quint32 TransportWorker::droppedFrames() const
+{
+    return m_droppedFrames.load(std::memory_order_relaxed);
+}
+
+void TransportWorker::drainTx()
+{
+    m_txWakePending.store(false, std::memory_order_release);
+
+    ElmFrame frame;
+    while (m_txQueue.tryPop(frame)) {
+        write(frame.view());
+    }
+}
+
+void TransportWorker::pushFrame(const ElmFrame &frame)
+{
+    // GUI thread is far behind; losing a line beats blocking the socket. The last slot is
+    // kept for prompts: without its prompt a request would hang until the host timeout.
+    // The next frame that gets through carries the loss, so the request fails at once.
+    const std::size_t limit = frame.kind == ElmFrame::Prompt ? RX_QUEUE_SIZE : RX_QUEUE_SIZE - 1;
+    if (m_rxQueue.size() >= limit) {
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        m_rxLost = true;
+        return;
+    }
+
+    ElmFrame marked = frame;
+    marked.afterLoss = m_rxLost;
+    m_rxLost = false;
+    m_rxQueue.tryPush(marked);
+
+    if (!m_rxWakePending.exchange(true, std::memory_order_acq_rel)) {
+        emit framesAvailable();
+    }
+}
+
+bool TransportWorker::write(QByteArrayView data)
+{
+    m_capture.record(TrafficRecord::Tx, data);
+
+    switch(m_connectionType)
+    {
+    case Wifi:
+        return m_tcpSocket->write(data);
+
+    case BlueTooth:
+        return m_bluetoothManager->write(data);
+
+    case Replay:
+        return m_replayTransport->write(data);
+
+    case Simulator:
+        return m_simulatorTransport->write(data);
+
+    default:
+        break;
+    }
+
+    return false;
+}
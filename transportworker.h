@@ -0,0 +1,76 @@
+#ifndef TRANSPORTWORKER_H
+#define TRANSPORTWORKER_H
+
+#include <QObject>
+#include <atomic>
+#include "elmframer.h"
+#include "elmtcpsocket.h"
+#include "elmbluetoothmanager.h"
+#include "replaytransport.h"
+#include "simulatortransport.h"
+#include "spscqueue.h"
+#include "trafficcapture.h"
+
+enum ConnectionType {BlueTooth, Wifi, Serial, None, Replay, Simulator};
+
+// Owns the adapter sockets and lives on its own thread.
+// The GUI thread posts commands and takes received frames through lock-free queues;
+// each direction wakes the other side with at most one queued call per batch.
+class TransportWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TransportWorker(QObject *parent = nullptr);
+
+    ElmTcpSocket *tcpSocket() const;
+    ElmBluetoothManager *bluetoothManager() const;
+    ReplayTransport *replayTransport() const;
+    SimulatorTransport *simulatorTransport() const;
+
+    // Worker thread only
+    void setConnectionType(ConnectionType type);
+    bool startCapture(const QString &path);
+    void stopCapture();
+
+    // GUI thread side
+    bool post(QByteArrayView command);
+
+    template <typename Handler>
+    void consumeFrames(Handler handler)
+    {
+        // Clear first: a frame pushed after this point raises a new wakeup
+        m_rxWakePending.store(false, std::memory_order_release);
+
+        ElmFrame frame;
+        while (m_rxQueue.tryPop(frame)) {
+            handler(frame);
+        }
+    }
+
+    quint32 droppedFrames() const;
+
+signals:
+    void framesAvailable();
+
+private:
+    void drainTx();
+    void pushFrame(const ElmFrame &frame);
+    bool write(QByteArrayView data);
+
+    ElmTcpSocket *m_tcpSocket{};
+    ElmBluetoothManager *m_bluetoothManager{};
+    ReplayTransport *m_replayTransport{};
+    SimulatorTransport *m_simulatorTransport{};
+    ConnectionType m_connectionType{Wifi};
+    TrafficCapture m_capture;
+
+    SpscQueue<ElmFrame, 64> m_txQueue;
+    static const std::size_t RX_QUEUE_SIZE = 512;
+    SpscQueue<ElmFrame, RX_QUEUE_SIZE> m_rxQueue;
+    bool m_rxLost{false};   // worker thread only
+    std::atomic<bool> m_txWakePending{false};
+    std::atomic<bool> m_rxWakePending{false};
+    std::atomic<quint32> m_droppedFrames{0};
+};
+
+#endif // TRANSPORTWORKER_H
@@ -0,0 +1,196 @@
+#include "vehicleprofile.h"
+#include <QDateTime>
+#include <QDir>
+#include <QSettings>
+
+namespace {
+
+// QSettings treats '/' and '\' as group separators; keys get only letters, digits and '_'
+QString settingsKey(const QString &text)
+{
+    QString key = text;
+    for (QChar &c : key) {
+        if (!c.isLetterOrNumber()) {
+            c = QLatin1Char('_');
+        }
+    }
+    return key;
+}
+
+QString pidsToHex(const std::bitset<256> &pids)
+{
+    QString hex;
+    hex.reserve(64);
+    for (int nibble = 0; nibble < 64; ++nibble) {
+        int value = 0;
+        for (int bit = 0; bit < 4; ++bit) {
+            value = (value << 1) | int(pids.test(size_t(nibble * 4 + bit)));
+        }
+        hex.append(QString::number(value, 16).toUpper());
+    }
+    return hex;
+}
+
+bool pidsFromHex(const QString &hex, std::bitset<256> &pids)
+{
+    if (hex.size() != 64) {
+        return false;
+    }
+    pids.reset();
+    for (int nibble = 0; nibble < 64; ++nibble) {
+        bool ok = false;
+        const int value = hex.mid(nibble, 1).toInt(&ok, 16);
+        if (!ok) {
+            return false;
+        }
+        for (int bit = 0; bit < 4; ++bit) {
+            pids.set(size_t(nibble * 4 + bit), (value >> (3 - bit)) & 1);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+VehicleProfileCache* VehicleProfileCache::theInstance_ = nullptr;
+
+VehicleProfileCache *VehicleProfileCache::getInstance()
+{
+    if (theInstance_ == nullptr)
+    {
+        theInstance_ = new VehicleProfileCache();
+    }
+    return theInstance_;
+}
+
+VehicleProfileCache::VehicleProfileCache()
+{
+    m_sProfileFile = QDir::currentPath() + "/vehicles.ini";
+}
+
+void VehicleProfileCache::setFile(const QString &path)
+{
+    m_sProfileFile = path;
+}
+
+QString VehicleProfileCache::groupFor(const QString &key)
+{
+    return "Vehicle_" + settingsKey(key);
+}
+
+VehicleProfile VehicleProfileCache::findByEndpoint(const QString &endpoint) const
+{
+    if (endpoint.isEmpty()) {
+        return VehicleProfile();
+    }
+
+    QSettings settings(m_sProfileFile, QSettings::IniFormat);
+    const QString key = settings.value("Endpoints/" + settingsKey(endpoint)).toString();
+    return key.isEmpty() ? VehicleProfile() : find(key);
+}
+
+VehicleProfile VehicleProfileCache::find(const QString &key) const
+{
+    VehicleProfile profile;
+    QSettings settings(m_sProfileFile, QSettings::IniFormat);
+    settings.beginGroup(groupFor(key));
+    if (settings.value("Key").toString() != key) {
+        return profile;
+    }
+
+    profile.key = key;
+    profile.endpoint = settings.value("Endpoint").toString();
+    profile.ecuId = settings.value("EcuId").toString();
+    profile.protocol = WJProtocol(settings.value("Protocol", int(PROTOCOL_UNKNOWN)).toInt());
+    profile.securityAccess = settings.value("SecurityAccess", false).toBool();
+    profile.startsWithoutSecurity = settings.value("StartsWithoutSecurity", 0).toInt();
+    profile.pidsKnown = pidsFromHex(settings.value("SupportedPids").toString(), profile.supportedPids);
+    profile.lastSeenMs = settings.value("LastSeen", 0).toLongLong();
+
+    settings.beginGroup("Headers");
+    for (const QString &module : settings.childKeys()) {
+        profile.headers.insert(module.toInt(), settings.value(module).toString());
+    }
+    settings.endGroup();
+
+    // ewma reply; ewma total; p99 reply; p99 total; samples
+    settings.beginGroup("Latency");
+    for (const QString &module : settings.childKeys()) {
+        const QStringList fields = settings.value(module).toString().split(';');
+        if (fields.size() != 5) {
+            continue;
+        }
+        LatencyModel::Stats stats;
+        stats.ewmaReplyMs = fields.at(0).toDouble();
+        stats.ewmaTotalMs = fields.at(1).toDouble();
+        stats.p99ReplyMs = fields.at(2).toUInt();
+        stats.p99TotalMs = fields.at(3).toUInt();
+        stats.samples = fields.at(4).toULongLong();
+        profile.latency.insert(module.toInt(), stats);
+    }
+    settings.endGroup();
+
+    return profile;
+}
+
+void VehicleProfileCache::store(const VehicleProfile &profile)
+{
+    if (!profile.isValid()) {
+        return;
+    }
+
+    QSettings settings(m_sProfileFile, QSettings::IniFormat);
+    settings.remove(groupFor(profile.key));
+    settings.beginGroup(groupFor(profile.key));
+    settings.setValue("Key", profile.key);
+    settings.setValue("Endpoint", profile.endpoint);
+    settings.setValue("EcuId", profile.ecuId);
+    settings.setValue("Protocol", int(profile.protocol));
+    settings.setValue("SecurityAccess", profile.securityAccess);
+    settings.setValue("StartsWithoutSecurity", profile.startsWithoutSecurity);
+    settings.setValue("SupportedPids", profile.pidsKnown ? pidsToHex(profile.supportedPids) : QString());
+    settings.setValue("LastSeen", profile.lastSeenMs ? profile.lastSeenMs : QDateTime::currentMSecsSinceEpoch());
+
+    for (auto it = profile.headers.constBegin(); it != profile.headers.constEnd(); ++it) {
+        settings.setValue("Headers/" + QString::number(it.key()), it.value());
+    }
+    for (auto it = profile.latency.constBegin(); it != profile.latency.constEnd(); ++it) {
+        const LatencyModel::Stats &s = it.value();
+        settings.setValue("Latency/" + QString::number(it.key()),
+                          QString("%1;%2;%3;%4;%5").arg(s.ewmaReplyMs).arg(s.ewmaTotalMs)
+                              .arg(s.p99ReplyMs).arg(s.p99TotalMs).arg(s.samples));
+    }
+    settings.endGroup();
+
+    if (!profile.endpoint.isEmpty()) {
+        settings.setValue("Endpoints/" + settingsKey(profile.endpoint), profile.key);
+    }
+}
+
+void VehicleProfileCache::remove(const QString &key)
+{
+    QSettings settings(m_sProfileFile, QSettings::IniFormat);
+    const QString endpoint = settings.value(groupFor(key) + "/Endpoint").toString();
+    settings.remove(groupFor(key));
+    if (!endpoint.isEmpty() && settings.value("Endpoints/" + settingsKey(endpoint)).toString() == key) {
+        settings.remove("Endpoints/" + settingsKey(endpoint));
+    }
+}
+
+QString VehicleProfileCache::ecuIdFromResponse(const QString &response)
+{
+    quint8 bytes[128];
+    const int size = WJUtils::decodeHex(response, bytes, int(sizeof(bytes)));
+
+    // Positive response 5A 80, after 3-4 header bytes when headers are on
+    for (int offset : {0, 3, 4}) {
+        if (size >= offset + 3 && bytes[offset] == 0x5A && bytes[offset + 1] == 0x80) {
+            QString id;
+            for (int i = offset + 2; i < size; ++i) {
+                id.append(QString("%1").arg(bytes[i], 2, 16, QLatin1Char('0')).toUpper());
+            }
+            return id;
+        }
+    }
+    return QString();
+}
@@ -0,0 +1,55 @@
+#ifndef VEHICLEPROFILE_H
+#define VEHICLEPROFILE_H
+
+#include <QHash>
+#include <QString>
+#include <bitset>
+#include "global.h"
+#include "latencymodel.h"
+
+// What the last session learned about one vehicle, so a reconnect can skip the probing
+struct VehicleProfile {
+    QString key;                              // "ecu:<identification>" once known, else the adapter endpoint
+    QString endpoint;                         // adapter the vehicle was last reached through
+    QString ecuId;                            // EDC15 identification (1A 80), hex
+    WJProtocol protocol{PROTOCOL_UNKNOWN};    // protocol the engine answered on
+    QHash<int, QString> headers;              // WJModule -> ATSH bytes that worked
+    bool securityAccess{false};               // 27 01 / 27 02 was granted the last time it was tried
+    int startsWithoutSecurity{0};             // warm starts that skipped it since
+    bool pidsKnown{false};
+    std::bitset<256> supportedPids;           // ELM support bitmaps (mode 01)
+    QHash<int, LatencyModel::Stats> latency;  // WJModule -> learned response times
+    qint64 lastSeenMs{0};
+
+    bool isValid() const { return !key.isEmpty(); }
+};
+
+// Profiles on disk next to settings.ini, one group per vehicle plus an endpoint index.
+// Looked up by endpoint before the first command (the identity is only known after init)
+// and checked against the ECU identification once init has read it.
+class VehicleProfileCache
+{
+public:
+    VehicleProfileCache();
+
+    static VehicleProfileCache* getInstance();
+
+    // vehicles.ini in the working directory unless pointed elsewhere
+    void setFile(const QString &path);
+
+    VehicleProfile findByEndpoint(const QString &endpoint) const;
+    VehicleProfile find(const QString &key) const;
+    void store(const VehicleProfile &profile);
+    void remove(const QString &key);
+
+    // "5A 80 ..." (headers off or on) -> identification bytes as hex, empty if not an answer to 1A 80
+    static QString ecuIdFromResponse(const QString &response);
+
+private:
+    static QString groupFor(const QString &key);
+
+    static VehicleProfileCache* theInstance_;
+    QString m_sProfileFile{};
+};
+
+#endif // VEHICLEPROFILE_H
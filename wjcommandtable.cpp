@@ -0,0 +1,14 @@
+#include "wjcommandtable.h"
+#include <array>
+
+const QString &WJCommandTable::text(WJCommandId id)
+{
+    static const std::array<QString, CMD_COUNT> texts = [] {
+        std::array<QString, CMD_COUNT> result;
+        for (int i = 0; i < CMD_COUNT; ++i) {
+            result[i] = QString::fromLatin1(TABLE[i].text);
+        }
+        return result;
+    }();
+    return texts[id];
+}
@@ -0,0 +1,223 @@
+#ifndef WJCOMMANDTABLE_H
+#define WJCOMMANDTABLE_H
+
+#include <QByteArrayView>
+#include <QString>
+#include <iterator>
+#include "global.h"
+
+// Every request the app sends to a WJ module, one entry per module/command
+enum WJCommandId : quint8 {
+    CMD_ENGINE_START_COMMUNICATION,
+    CMD_ENGINE_SECURITY_ACCESS_REQUEST,
+    CMD_ENGINE_SECURITY_ACCESS_KEY,
+    CMD_ENGINE_START_DIAGNOSTIC_ROUTINE,
+    CMD_ENGINE_READ_ECU_ID,
+    CMD_ENGINE_READ_DTC,
+    CMD_ENGINE_CLEAR_DTC,
+    CMD_ENGINE_READ_MAF_DATA,
+    CMD_ENGINE_READ_RAIL_PRESSURE_ACTUAL,
+    CMD_ENGINE_READ_RAIL_PRESSURE_SPEC,
+    CMD_ENGINE_READ_MAP_DATA,
+    CMD_ENGINE_READ_INJECTOR_DATA,
+    CMD_ENGINE_READ_MISC_DATA,
+    CMD_ENGINE_READ_COOLANT_TEMP,
+    CMD_ENGINE_READ_ENGINE_RPM,
+    CMD_ENGINE_READ_VEHICLE_SPEED,
+    CMD_ENGINE_READ_BATTERY_VOLTAGE,
+
+    CMD_TRANS_READ_DTC,
+    CMD_TRANS_CLEAR_DTC,
+    CMD_TRANS_READ_TRANS_DATA,
+    CMD_TRANS_READ_GEAR_RATIO,
+    CMD_TRANS_READ_SOLENOID_STATUS,
+    CMD_TRANS_READ_PRESSURE_DATA,
+    CMD_TRANS_READ_TEMP_DATA,
+    CMD_TRANS_READ_SPEED_DATA,
+
+    CMD_PCM_READ_DTC,
+    CMD_PCM_CLEAR_DTC,
+    CMD_PCM_READ_LIVE_DATA,
+    CMD_PCM_READ_FUEL_TRIM,
+    CMD_PCM_READ_O2_SENSORS,
+    CMD_PCM_READ_ENGINE_DATA,
+    CMD_PCM_READ_EMISSION_DATA,
+    CMD_PCM_READ_FREEZE_FRAME,
+
+    CMD_ABS_READ_DTC,
+    CMD_ABS_CLEAR_DTC,
+    CMD_ABS_READ_WHEEL_SPEEDS,
+    CMD_ABS_READ_BRAKE_DATA,
+    CMD_ABS_READ_STABILITY_DATA,
+
+    CMD_COUNT
+};
+
+// Decoder that understands the response of a command
+enum WJParserId : quint8 {
+    PARSER_NONE,
+    PARSER_ENGINE_MAF,
+    PARSER_ENGINE_RAIL_PRESSURE,
+    PARSER_ENGINE_MAP,
+    PARSER_ENGINE_INJECTOR,
+    PARSER_ENGINE_MISC,
+    PARSER_ENGINE_BATTERY,
+    PARSER_TRANS_DATA,
+    PARSER_TRANS_SPEEDS,
+    PARSER_TRANS_SOLENOIDS,
+    PARSER_PCM_DATA,
+    PARSER_PCM_FUEL_TRIM,
+    PARSER_PCM_O2_SENSORS,
+    PARSER_ABS_WHEEL_SPEEDS,
+    PARSER_ABS_STABILITY,
+    PARSER_DTC
+};
+
+// A request with everything the send path needs already encoded
+struct WJCommandDescriptor {
+    WJCommandId id;
+    WJModule module;
+    WJProtocol protocol;
+    quint16 timeoutMs;
+    quint8 request[4];           // request bytes, empty for adapter (AT) commands
+    quint8 requestLength;
+    quint8 responseSid;          // request SID + 0x40, 0 for adapter commands
+    quint8 minResponseLength;    // bytes (SID included) the parser needs, 0 if not checked
+    WJParserId parser;
+    bool adapterCommand;
+    char wire[12];               // exactly what goes to the ELM: hex without spaces, CR-terminated
+    quint8 wireLength;
+    const char *text;            // display form, as in the WJ:: namespaces
+
+    constexpr QByteArrayView wireBytes() const { return QByteArrayView(wire, wireLength); }
+};
+
+namespace WJCommandTable {
+
+constexpr quint8 hexNibble(char c)
+{
+    return quint8(c >= 'a' ? c - 'a' + 10 : c >= 'A' ? c - 'A' + 10 : c - '0');
+}
+
+// Protocol and timeout per module; mirrors WJCommands::getModuleConfig.
+// The header (ATSH) is not repeated here: ElmAdapterState::forModule() is its one source.
+constexpr WJCommandDescriptor route(WJModule module)
+{
+    WJCommandDescriptor d{};
+    d.module = module;
+    switch (module) {
+    case MODULE_ENGINE_EDC15:
+        d.protocol = PROTOCOL_ISO_14230_4_KWP_FAST;
+        d.timeoutMs = 2000;
+        break;
+    case MODULE_TRANSMISSION:
+    case MODULE_PCM:
+    case MODULE_ABS:
+        d.protocol = PROTOCOL_J1850_VPW;
+        d.timeoutMs = 1000;
+        break;
+    default:
+        d.protocol = PROTOCOL_UNKNOWN;
+        d.timeoutMs = 1000;
+        break;
+    }
+    return d;
+}
+
+// Encodes "21 20" into request bytes and the wire form "2120\r" at compile time
+constexpr WJCommandDescriptor command(WJCommandId id, WJModule module, const char *text,
+                                      quint8 minResponseLength = 0, WJParserId parser = PARSER_NONE)
+{
+    WJCommandDescriptor d = route(module);
+    d.id = id;
+    d.text = text;
+    d.minResponseLength = minResponseLength;
+    d.parser = parser;
+    d.adapterCommand = (text[0] == 'A' && text[1] == 'T');
+
+    for (const char *p = text; *p; ++p) {
+        if (*p != ' ') {
+            d.wire[d.wireLength++] = *p;
+        }
+    }
+    d.wire[d.wireLength++] = '\r';
+
+    if (!d.adapterCommand) {
+        for (int i = 0; i + 1 < d.wireLength - 1; i += 2) {
+            d.request[d.requestLength++] = quint8(hexNibble(d.wire[i]) << 4 | hexNibble(d.wire[i + 1]));
+        }
+        d.responseSid = quint8(d.request[0] + 0x40);
+    }
+    return d;
+}
+
+inline constexpr WJCommandDescriptor TABLE[] = {
+    command(CMD_ENGINE_START_COMMUNICATION,       MODULE_ENGINE_EDC15, "81"),
+    command(CMD_ENGINE_SECURITY_ACCESS_REQUEST,   MODULE_ENGINE_EDC15, "27 01"),
+    command(CMD_ENGINE_SECURITY_ACCESS_KEY,       MODULE_ENGINE_EDC15, "27 02 CD 46"),
+    command(CMD_ENGINE_START_DIAGNOSTIC_ROUTINE,  MODULE_ENGINE_EDC15, "31 25 00"),
+    command(CMD_ENGINE_READ_ECU_ID,               MODULE_ENGINE_EDC15, "1A 80"),
+    command(CMD_ENGINE_READ_DTC,                  MODULE_ENGINE_EDC15, "03", 2, PARSER_DTC),
+    command(CMD_ENGINE_CLEAR_DTC,                 MODULE_ENGINE_EDC15, "04"),
+    command(CMD_ENGINE_READ_MAF_DATA,             MODULE_ENGINE_EDC15, "21 20", 8, PARSER_ENGINE_MAF),
+    command(CMD_ENGINE_READ_RAIL_PRESSURE_ACTUAL, MODULE_ENGINE_EDC15, "21 12", 12, PARSER_ENGINE_RAIL_PRESSURE),
+    command(CMD_ENGINE_READ_RAIL_PRESSURE_SPEC,   MODULE_ENGINE_EDC15, "21 22"),
+    command(CMD_ENGINE_READ_MAP_DATA,             MODULE_ENGINE_EDC15, "21 15", 10, PARSER_ENGINE_MAP),
+    command(CMD_ENGINE_READ_INJECTOR_DATA,        MODULE_ENGINE_EDC15, "21 28", 14, PARSER_ENGINE_INJECTOR),
+    command(CMD_ENGINE_READ_MISC_DATA,            MODULE_ENGINE_EDC15, "21 30", 16, PARSER_ENGINE_MISC),
+    command(CMD_ENGINE_READ_COOLANT_TEMP,         MODULE_ENGINE_EDC15, "21 05"),
+    command(CMD_ENGINE_READ_ENGINE_RPM,           MODULE_ENGINE_EDC15, "21 0C"),
+    command(CMD_ENGINE_READ_VEHICLE_SPEED,        MODULE_ENGINE_EDC15, "21 0D"),
+    command(CMD_ENGINE_READ_BATTERY_VOLTAGE,      MODULE_ENGINE_EDC15, "ATRV", 0, PARSER_ENGINE_BATTERY),
+
+    command(CMD_TRANS_READ_DTC,                   MODULE_TRANSMISSION, "03", 2, PARSER_DTC),
+    command(CMD_TRANS_CLEAR_DTC,                  MODULE_TRANSMISSION, "04"),
+    command(CMD_TRANS_READ_TRANS_DATA,            MODULE_TRANSMISSION, "01 00", 8, PARSER_TRANS_DATA),
+    command(CMD_TRANS_READ_GEAR_RATIO,            MODULE_TRANSMISSION, "01 A4"),
+    command(CMD_TRANS_READ_SOLENOID_STATUS,       MODULE_TRANSMISSION, "01 A5", 6, PARSER_TRANS_SOLENOIDS),
+    command(CMD_TRANS_READ_PRESSURE_DATA,         MODULE_TRANSMISSION, "01 A6"),
+    command(CMD_TRANS_READ_TEMP_DATA,             MODULE_TRANSMISSION, "01 05"),
+    command(CMD_TRANS_READ_SPEED_DATA,            MODULE_TRANSMISSION, "01 0D", 8, PARSER_TRANS_SPEEDS),
+
+    command(CMD_PCM_READ_DTC,                     MODULE_PCM, "03", 2, PARSER_DTC),
+    command(CMD_PCM_CLEAR_DTC,                    MODULE_PCM, "04"),
+    command(CMD_PCM_READ_LIVE_DATA,               MODULE_PCM, "01 00", 8, PARSER_PCM_DATA),
+    command(CMD_PCM_READ_FUEL_TRIM,               MODULE_PCM, "01 06", 6, PARSER_PCM_FUEL_TRIM),
+    command(CMD_PCM_READ_O2_SENSORS,              MODULE_PCM, "01 14", 6, PARSER_PCM_O2_SENSORS),
+    command(CMD_PCM_READ_ENGINE_DATA,             MODULE_PCM, "01 0C"),
+    command(CMD_PCM_READ_EMISSION_DATA,           MODULE_PCM, "01 01"),
+    command(CMD_PCM_READ_FREEZE_FRAME,            MODULE_PCM, "02 00"),
+
+    command(CMD_ABS_READ_DTC,                     MODULE_ABS, "03", 2, PARSER_DTC),
+    command(CMD_ABS_CLEAR_DTC,                    MODULE_ABS, "04"),
+    command(CMD_ABS_READ_WHEEL_SPEEDS,            MODULE_ABS, "01 A0", 10, PARSER_ABS_WHEEL_SPEEDS),
+    command(CMD_ABS_READ_BRAKE_DATA,              MODULE_ABS, "01 A1"),
+    command(CMD_ABS_READ_STABILITY_DATA,          MODULE_ABS, "01 A2", 8, PARSER_ABS_STABILITY),
+};
+
+constexpr bool isOrdered()
+{
+    for (int i = 0; i < int(std::size(TABLE)); ++i) {
+        if (TABLE[i].id != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(std::size(TABLE) == CMD_COUNT, "every WJCommandId needs a table entry");
+static_assert(isOrdered(), "table entries must be in WJCommandId order");
+static_assert(TABLE[CMD_ENGINE_READ_MAF_DATA].wireLength == 5 && TABLE[CMD_ENGINE_READ_MAF_DATA].responseSid == 0x61,
+              "compile-time encoding is broken");
+
+constexpr const WJCommandDescriptor &descriptor(WJCommandId id)
+{
+    return TABLE[id];
+}
+
+// Display text as a shared QString; copies only bump a reference count
+const QString &text(WJCommandId id);
+
+} // namespace WJCommandTable
+
+#endif // WJCOMMANDTABLE_H
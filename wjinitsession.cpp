@@ -0,0 +1,311 @@
+#include "wjinitsession.h"
+#include "elm.h"
+#include "elmadapterstate.h"
+#include "elminterface.h"
+
+WJInitSession::WJInitSession(QObject *parent) : QObject(parent)
+{
+    m_elm = ELM::getInstance();
+    m_elmInterface = ElmInterface::getInstance();
+
+    connect(m_elmInterface, &ElmInterface::messageReceived, this, &WJInitSession::onMessageReceived);
+    connect(m_elmInterface, &ElmInterface::responseReceived, this, &WJInitSession::onResponseReceived);
+    connect(m_elmInterface, &ElmInterface::requestTimedOut, this, &WJInitSession::onRequestTimedOut);
+}
+
+bool WJInitSession::start(const QString &endpoint)
+{
+    m_endpoint = endpoint;
+    m_step = 0;
+    m_requestIds.clear();
+    m_running = false;
+    m_complete = false;
+    m_securityTried = false;
+    m_securityGranted = false;
+    m_pidRequest = 0;
+    m_ecuIdentity.clear();
+
+    // A vehicle seen through this adapter before: reuse what was probed then instead of probing again
+    m_vehicleProfile = VehicleProfileCache::getInstance()->findByEndpoint(endpoint);
+    if (m_vehicleProfile.isValid() && m_vehicleProfile.protocol == PROTOCOL_ISO_14230_4_KWP_FAST) {
+        // A refusal isn't final (wrong key state, ignition): ask again every few warm starts
+        m_securityTried = m_vehicleProfile.securityAccess
+                          || m_vehicleProfile.startsWithoutSecurity + 1 >= SECURITY_RETRY_STARTS;
+        m_commands = WJCommands::getWarmInitSequence(m_vehicleProfile.protocol,
+                                                     m_vehicleProfile.headers.value(MODULE_ENGINE_EDC15),
+                                                     m_securityTried);
+        if (m_vehicleProfile.pidsKnown) {
+            m_elm->restorePids(m_vehicleProfile.supportedPids);
+        }
+        for (auto it = m_vehicleProfile.latency.constBegin(); it != m_vehicleProfile.latency.constEnd(); ++it) {
+            m_elmInterface->seedLatency(WJModule(it.key()), it.value());
+        }
+        emit logMessage("→ Known vehicle (" + m_vehicleProfile.key + "): warm start");
+    } else {
+        // Start with engine module (ISO_14230_4_KWP_FAST) initialization
+        m_commands = WJCommands::getInitSequence(PROTOCOL_ISO_14230_4_KWP_FAST);
+        m_securityTried = true;
+    }
+    if (m_commands.isEmpty()) {
+        return false;
+    }
+
+    // The identification tells whether the adapter is still on the same vehicle
+    m_commands.append(WJCommand(WJ::Engine::READ_ECU_ID, "5A 80", "Read ECU identification", 3000,
+                                PROTOCOL_ISO_14230_4_KWP_FAST, MODULE_ENGINE_EDC15, false));
+
+    // The whole sequence is queued; each command goes out as soon as the previous prompt arrives.
+    // It starts with a reset, which is never answered locally, so no answer comes before its id.
+    for (const WJCommand &cmd : m_commands) {
+        emit logMessage("→ " + cmd.description + ": " + cmd.command);
+        m_requestIds.append(m_elmInterface->enqueue(cmd.command, cmd.targetModule, cmd.timeoutMs));
+    }
+
+    m_running = true;
+    return true;
+}
+
+bool WJInitSession::isRunning() const
+{
+    return m_running;
+}
+
+bool WJInitSession::isComplete() const
+{
+    return m_complete;
+}
+
+void WJInitSession::handleResponse(quint32 id, const QString &command, const QString &response)
+{
+    if (!m_running || m_step >= m_commands.size() || id != m_requestIds.at(m_step)) {
+        return;
+    }
+
+    const WJCommand &currentCmd = m_commands[m_step];
+    QString cleanResponse = response;
+    if (!command.isEmpty() && cleanResponse.startsWith(command)) {
+        cleanResponse = cleanResponse.mid(command.length());
+    }
+    cleanResponse = cleanResponse.trimmed().toUpper();
+
+    // Every step is permissive: a failed command is logged and the sequence goes on
+    if (WJUtils::isError(cleanResponse, currentCmd.protocol)) {
+        if (currentCmd.isCritical) {
+            emit logMessage("❌ Critical command failed: " + currentCmd.command + " - " + cleanResponse);
+        } else {
+            emit logMessage("⚠️ Non-critical command failed: " + currentCmd.command + " - " + cleanResponse);
+        }
+    }
+    else if (currentCmd.command == "ATZ" || currentCmd.command == "ATWS") {
+        if (cleanResponse.contains("ELM327") || cleanResponse.isEmpty()) {
+            emit logMessage("✓ ELM327 reset successful");
+        }
+    }
+    else if (currentCmd.command.startsWith("AT")) {
+        if (cleanResponse.contains("OK") || cleanResponse.isEmpty()) {
+            emit logMessage("✓ " + currentCmd.description);
+        }
+    }
+    else if (currentCmd.command == "81") {
+        if (cleanResponse.contains("BUS INIT") || cleanResponse.contains("ERROR")) {
+            emit logMessage("⚠️ Engine communication attempted: " + cleanResponse);
+        }
+    }
+    else if (currentCmd.command.startsWith("27")) {
+        emit logMessage("⚠️ Security access attempted: " + cleanResponse);
+        m_securityGranted = cleanResponse.contains("67");
+    }
+    else if (currentCmd.command == WJ::Engine::READ_ECU_ID) {
+        m_ecuIdentity = VehicleProfileCache::ecuIdFromResponse(cleanResponse);
+        emit logMessage("→ ECU identification: " + (m_ecuIdentity.isEmpty() ? QString("not available") : m_ecuIdentity));
+    }
+    else {
+        emit logMessage("→ " + currentCmd.description + ": " + cleanResponse);
+    }
+
+    // The next command is already queued in the interface
+    if (++m_step >= m_commands.size()) {
+        finish();
+    }
+}
+
+void WJInitSession::finish()
+{
+    // The warm path trusted the adapter; a different identification means a different vehicle
+    if (m_vehicleProfile.isValid() && !m_vehicleProfile.ecuId.isEmpty() && !m_ecuIdentity.isEmpty()
+        && m_vehicleProfile.ecuId != m_ecuIdentity) {
+        emit logMessage("⚠️ Different vehicle on this adapter - cached capabilities dropped");
+        m_elm->resetPids();
+        m_vehicleProfile = VehicleProfile();
+    }
+
+    // Only an attempt updates the security result; a skipped one counts towards the retry
+    if (m_securityTried) {
+        m_vehicleProfile.securityAccess = m_securityGranted;
+        m_vehicleProfile.startsWithoutSecurity = 0;
+    } else {
+        m_vehicleProfile.startsWithoutSecurity++;
+    }
+
+    // Cold init (or a different vehicle): read the support bitmaps once, on the same queue
+    if (!m_elm->pidsChecked()) {
+        m_elm->resetPids();
+        m_pidBase = 0x00;
+        m_pidAttempts = 0;
+        m_pidsLoaded = 0;
+        m_pidBatcher.reset();
+        requestPidBitmap();
+        return;
+    }
+    complete();
+}
+
+void WJInitSession::complete()
+{
+    m_running = false;
+    m_complete = true;
+    saveProfile();
+
+    emit completed();
+}
+
+void WJInitSession::requestPidBitmap()
+{
+    // The first six bitmaps in one round-trip, as long as the ECU hasn't shown it takes one PID only
+    QVector<quint8> pids{quint8(m_pidBase)};
+    if (m_pidBase == 0x00) {
+        const int count = qMin(m_pidBatcher.limit(MODULE_ENGINE_EDC15), PidBatcher::MAX_PIDS_PER_REQUEST);
+        for (int base = 0x20; pids.size() < count; base += 0x20) {
+            pids.append(quint8(base));
+        }
+    }
+    m_pidCount = int(pids.size());
+
+    const QString command = PidBatcher::requestFor(pids);
+    emit logMessage("→ Supported PIDs: " + command);
+    m_pidRequest = m_elmInterface->enqueue(command, MODULE_ENGINE_EDC15, WJ::Protocols::DEFAULT_TIMEOUT);
+}
+
+void WJInitSession::onMessageReceived(quint32 id, WJModule module, QByteArrayView message)
+{
+    Q_UNUSED(module);
+    // Every ECU answers with its own message; each adds its bitmap
+    if (m_pidRequest != 0 && id == m_pidRequest) {
+        m_pidsLoaded |= m_elm->loadSupportBitmaps(reinterpret_cast<const quint8*>(message.data()), int(message.size()));
+    }
+}
+
+void WJInitSession::onResponseReceived(quint32 id, const QString &command, WJModule module, const QStringList &lines)
+{
+    Q_UNUSED(command);
+    Q_UNUSED(module);
+    Q_UNUSED(lines);
+    if (m_pidRequest != 0 && id == m_pidRequest) {
+        pidRequestDone();
+    }
+}
+
+void WJInitSession::onRequestTimedOut(quint32 id, const QString &command)
+{
+    Q_UNUSED(command);
+    if (m_pidRequest != 0 && id == m_pidRequest) {
+        pidRequestDone();
+    }
+}
+
+void WJInitSession::pidRequestDone()
+{
+    m_pidRequest = 0;
+    if (m_pidCount > 1) {
+        // Fewer bitmaps back than asked for (KWP ECUs answer the first PID only): one per request from now on.
+        // A bitmap that announces none after it counts as all the rest.
+        int answered = 0;
+        for (int i = 0; i < m_pidCount; ++i) {
+            const int base = i * 0x20;
+            if (!(m_pidsLoaded & (1u << i))) {
+                break;
+            }
+            answered++;
+            if (!m_elm->availablePids().test(size_t(base + 0x20))) {
+                answered = m_pidCount;
+                break;
+            }
+        }
+        m_pidBatcher.learn(MODULE_ENGINE_EDC15, m_pidCount, answered);
+    }
+
+    const quint8 bit = quint8(1u << (m_pidBase / 0x20));
+    if (!(m_pidsLoaded & bit)) {
+        if (++m_pidAttempts < ELM::PID_QUERY_ATTEMPTS) {
+            requestPidBitmap();
+            return;
+        }
+    } else {
+        // The last PID of a bitmap says whether the next bitmap exists; a combined reply may have it already
+        int next = m_pidBase + 0x20;
+        while (next <= 0xC0 && m_elm->availablePids().test(size_t(next)) && (m_pidsLoaded & (1u << (next / 0x20)))) {
+            next += 0x20;
+        }
+        if (next <= 0xC0 && m_elm->availablePids().test(size_t(next))) {
+            m_pidBase = next;
+            m_pidAttempts = 0;
+            requestPidBitmap();
+            return;
+        }
+    }
+
+    m_elm->finishPidDiscovery(m_pidsLoaded != 0);
+    emit logMessage(QString("→ Supported PIDs: %1").arg(m_elm->supportedPids().count()));
+    complete();
+}
+
+void WJInitSession::saveProfile()
+{
+    // Start from the cached profile so anything this session didn't re-learn is kept
+    VehicleProfile profile = m_vehicleProfile;
+    profile.endpoint = m_endpoint;
+    if (!m_ecuIdentity.isEmpty()) {
+        profile.ecuId = m_ecuIdentity;
+    }
+    profile.key = profile.ecuId.isEmpty() ? profile.endpoint : "ecu:" + profile.ecuId;
+    if (!profile.isValid()) {
+        return;
+    }
+
+    profile.protocol = PROTOCOL_ISO_14230_4_KWP_FAST;   // the engine init protocol
+    profile.lastSeenMs = QDateTime::currentMSecsSinceEpoch();
+    const LatencyModel &latency = m_elmInterface->latencyModel();
+    for (WJModule module : {MODULE_ENGINE_EDC15, MODULE_TRANSMISSION, MODULE_PCM, MODULE_ABS}) {
+        if (latency.isTrusted(module)) {
+            profile.latency.insert(module, latency.stats(module));
+            profile.headers.insert(module, ElmAdapterState::forModule(module).header);
+        }
+    }
+    if (m_elm->pidsChecked()) {
+        profile.pidsKnown = true;
+        profile.supportedPids = m_elm->availablePids();
+    }
+
+    // An endpoint-keyed profile is superseded once the ECU identification is known
+    VehicleProfileCache *cache = VehicleProfileCache::getInstance();
+    if (m_vehicleProfile.isValid() && m_vehicleProfile.key != profile.key) {
+        cache->remove(m_vehicleProfile.key);
+    }
+    cache->store(profile);
+    m_vehicleProfile = profile;
+}
+
+bool WJInitSession::securityGranted() const
+{
+    return m_securityGranted;
+}
+
+QString WJInitSession::ecuIdentity() const
+{
+    return m_ecuIdentity;
+}
+
+const VehicleProfile &WJInitSession::vehicleProfile() const
+{
+    return m_vehicleProfile;
+}
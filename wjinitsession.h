@@ -0,0 +1,80 @@
+#ifndef WJINITSESSION_H
+#define WJINITSESSION_H
+
+#include <QObject>
+#include <QByteArrayView>
+#include <QList>
+#include <QString>
+#include "global.h"
+#include "pidbatcher.h"
+#include "vehicleprofile.h"
+
+class ELM;
+class ElmInterface;
+
+// Adapter and EDC15 initialization of a new connection, without any UI.
+// start() picks the warm sequence for a vehicle already seen on the endpoint (the full one
+// otherwise), queues all of it on ElmInterface and then takes the answers one by one in
+// request order. Without cached PIDs the mode 01 support bitmaps are read next, on the same
+// queue: all six in one request while the ECU takes multi-PID requests, one by one otherwise. Then the vehicle profile cache is brought up to date and completed() fires.
+// MainWindow and obdreaderd both drive it and show logMessage() their way.
+class WJInitSession : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WJInitSession(QObject *parent = nullptr);
+
+    bool start(const QString &endpoint);
+    bool isRunning() const;
+    bool isComplete() const;
+
+    // Answer to request id, echo included; empty after a timeout. Only the sequence's own
+    // requests move it on: setup commands ElmInterface puts in front of them are skipped.
+    void handleResponse(quint32 id, const QString &command, const QString &response);
+
+    // Latencies and PIDs learned since the init go into the cache as well
+    void saveProfile();
+
+    bool securityGranted() const;
+    QString ecuIdentity() const;
+    const VehicleProfile &vehicleProfile() const;
+
+signals:
+    void logMessage(const QString &message);
+    void completed();
+
+private slots:
+    void onMessageReceived(quint32 id, WJModule module, QByteArrayView message);
+    void onResponseReceived(quint32 id, const QString &command, WJModule module, const QStringList &lines);
+    void onRequestTimedOut(quint32 id, const QString &command);
+
+private:
+    // A refused security access is tried again on this warm start
+    static const int SECURITY_RETRY_STARTS = 5;
+
+    void finish();
+    void complete();
+    void requestPidBitmap();
+    void pidRequestDone();
+
+    ELM *m_elm{};
+    ElmInterface *m_elmInterface{};
+    QString m_endpoint;
+    QList<WJCommand> m_commands;
+    QList<quint32> m_requestIds;     // ElmInterface id of each command
+    int m_step{0};
+    bool m_running{false};
+    bool m_complete{false};
+    bool m_securityTried{false};
+    bool m_securityGranted{false};
+    quint32 m_pidRequest{0};         // support bitmap request in flight, 0 if none
+    int m_pidBase{0};                // its first PID: 0x00, 0x20, ... 0xC0
+    int m_pidCount{0};               // bitmaps it asks for
+    PidBatcher m_pidBatcher;         // whether the engine ECU takes more than one PID per request
+    int m_pidAttempts{0};
+    quint8 m_pidsLoaded{0};          // bit per bitmap loaded (bit n = PID n * 0x20)
+    QString m_ecuIdentity;           // EDC15 identification read during this init
+    VehicleProfile m_vehicleProfile; // cached capabilities of the connected vehicle, if it was seen before
+};
+
+#endif // WJINITSESSION_H